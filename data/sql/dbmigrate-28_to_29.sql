@@ -0,0 +1,20 @@
+-- Script to migate from db version 28 to 29.
+-- Added collection_stats, materialized per-source collection counters
+
+CREATE TABLE IF NOT EXISTS collection_stats (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    numfiles INTEGER NOT NULL DEFAULT 0,
+    numartists INTEGER NOT NULL DEFAULT 0,
+    numalbums INTEGER NOT NULL DEFAULT 0,
+    duration INTEGER NOT NULL DEFAULT 0,
+    lastmodified INTEGER NOT NULL DEFAULT 0
+);
+CREATE UNIQUE INDEX collection_stats_source ON collection_stats(source);
+
+INSERT INTO collection_stats(source, numfiles, numartists, numalbums, duration, lastmodified)
+    SELECT file.source, count(*), count(DISTINCT file_join.artist), count(DISTINCT file_join.album),
+           coalesce(sum(file.duration), 0), coalesce(max(file.mtime), 0)
+    FROM file LEFT JOIN file_join ON file_join.file = file.id
+    GROUP BY file.source;
+
+UPDATE settings SET v = '29' WHERE k == 'schema_version';
@@ -0,0 +1,21 @@
+-- Script to migate from db version 29 to 30.
+-- Added resolve_cache, persistent winning resolve results
+
+CREATE TABLE IF NOT EXISTS resolve_cache (
+    artist TEXT NOT NULL,
+    track TEXT NOT NULL,
+    album TEXT NOT NULL,
+    url TEXT NOT NULL,                  -- file.url for collection results
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    file INTEGER REFERENCES file(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    resolver TEXT NOT NULL,             -- friendly source of the result
+    score REAL NOT NULL,
+    duration INTEGER NOT NULL DEFAULT 0,
+    expires INTEGER NOT NULL            -- timestamp
+);
+CREATE UNIQUE INDEX resolve_cache_key ON resolve_cache(artist, track, album);
+CREATE INDEX resolve_cache_source ON resolve_cache(source);
+CREATE INDEX resolve_cache_file ON resolve_cache(file);
+CREATE INDEX resolve_cache_expires ON resolve_cache(expires);
+
+UPDATE settings SET v = '30' WHERE k == 'schema_version';
@@ -0,0 +1,6 @@
+-- Script to migate from db version 30 to 31.
+-- Added oplog.format, new ops are stored in the compact binary encoding
+
+ALTER TABLE oplog ADD COLUMN format INTEGER NOT NULL DEFAULT 0;
+
+UPDATE settings SET v = '31' WHERE k == 'schema_version';
@@ -0,0 +1,108 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "alloccounter.h"
+
+#include <stdlib.h>
+
+#include <QAtomicInt>
+
+static QBasicAtomicInt s_allocs = Q_BASIC_ATOMIC_INITIALIZER( 0 );
+
+
+int
+AllocCounter::count()
+{
+    return s_allocs;
+}
+
+
+#ifdef __GLIBC__
+
+extern "C"
+{
+
+void* __libc_malloc( size_t size );
+void* __libc_calloc( size_t n, size_t size );
+void* __libc_realloc( void* ptr, size_t size );
+
+
+void*
+malloc( size_t size )
+{
+    s_allocs.ref();
+    return __libc_malloc( size );
+}
+
+
+void*
+calloc( size_t n, size_t size )
+{
+    s_allocs.ref();
+    return __libc_calloc( n, size );
+}
+
+
+void*
+realloc( void* ptr, size_t size )
+{
+    s_allocs.ref();
+    return __libc_realloc( ptr, size );
+}
+
+}
+
+#else
+
+#include <new>
+
+
+void*
+operator new( size_t size ) throw( std::bad_alloc )
+{
+    s_allocs.ref();
+    void* p = ::malloc( size ? size : 1 );
+    if ( !p )
+        throw std::bad_alloc();
+
+    return p;
+}
+
+
+void*
+operator new[]( size_t size ) throw( std::bad_alloc )
+{
+    return operator new( size );
+}
+
+
+void
+operator delete( void* p ) throw()
+{
+    ::free( p );
+}
+
+
+void
+operator delete[]( void* p ) throw()
+{
+    ::free( p );
+}
+
+#endif
@@ -0,0 +1,34 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+/*
+    Counts heap allocations of the whole benchmark process. On glibc malloc,
+    calloc and realloc are interposed, so allocations inside Qt and the other
+    libraries count as well; elsewhere only the global operator new is.
+*/
+namespace AllocCounter
+{
+    // allocations since the process started
+    int count();
+}
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,76 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+
+#include <QFileInfo>
+
+#include "utils/tomahawkutils.h"
+
+using namespace Tomahawk;
+
+
+Benchmark::Benchmark( QObject* parent )
+    : QObject( parent )
+    , m_exitCode( 0 )
+{
+}
+
+
+QString
+Benchmark::instanceName( qint64 pid )
+{
+    return QString( "Tomahawk-Benchmark-%1" ).arg( pid );
+}
+
+
+QDir
+Benchmark::instanceDir( const QString& name )
+{
+    // appDataDir() is named after the organization, see main()
+    QDir dir = TomahawkUtils::appDataDir();
+    dir.cdUp();
+
+    return QDir( dir.absoluteFilePath( name ) );
+}
+
+
+bool
+Benchmark::removeDir( const QDir& dir )
+{
+    if ( !dir.exists() )
+        return true;
+
+    foreach ( const QFileInfo& fi, dir.entryInfoList( QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot ) )
+    {
+        if ( fi.isDir() && !fi.isSymLink() )
+            removeDir( QDir( fi.absoluteFilePath() ) );
+        else
+            QFile::remove( fi.absoluteFilePath() );
+    }
+
+    return dir.rmdir( dir.absolutePath() );
+}
+
+
+void
+Benchmark::finish( int exitCode )
+{
+    m_exitCode = exitCode;
+    emit finished();
+}
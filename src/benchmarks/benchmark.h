@@ -0,0 +1,63 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QObject>
+#include <QDir>
+
+namespace Tomahawk
+{
+
+/*
+    Base of all benchmarks of tomahawk-benchmarks. main() starts one of them
+    once the database is ready, and quits with its exit code once it emits
+    finished(). A benchmark that checks its results and finds them wrong
+    finishes with a non-zero exit code, so it can fail a build.
+*/
+class Benchmark : public QObject
+{
+Q_OBJECT
+
+public:
+    explicit Benchmark( QObject* parent = 0 );
+
+    int exitCode() const { return m_exitCode; }
+
+    // every benchmark process has a data dir of its own, named after the process
+    static QString instanceName( qint64 pid );
+    static QDir instanceDir( const QString& name );
+    static bool removeDir( const QDir& dir );
+
+signals:
+    void finished();
+
+public slots:
+    virtual void start() = 0;
+
+protected:
+    void finish( int exitCode = 0 );
+
+private:
+    int m_exitCode;
+};
+
+}
+
+#endif // BENCHMARK_H
@@ -0,0 +1,196 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "coverbenchmark.h"
+
+#include <QBuffer>
+#include <QImage>
+#include <QPainter>
+#include <QTextStream>
+
+#include "album.h"
+#include "artist.h"
+#include "utils/logger.h"
+
+// the size of the album grid covers, see AlbumItemDelegate
+#define COVERBENCHMARK_SIZE 104
+#define COVERBENCHMARK_ALBUMS_PER_ARTIST 4
+// give up on covers that don't load in time
+#define COVERBENCHMARK_TIMEOUT (5 * 60 * 1000)
+
+using namespace Tomahawk;
+
+
+BenchmarkCoverPlugin::BenchmarkCoverPlugin()
+    : InfoPlugin()
+{
+    m_supportedGetTypes << InfoSystem::InfoAlbumCoverArt;
+
+    // about what the cover art plugins hand us, so decoding it costs the same
+    QImage image( 300, 300, QImage::Format_RGB32 );
+    QPainter p( &image );
+    QLinearGradient gradient( 0, 0, 300, 300 );
+    gradient.setColorAt( 0, Qt::darkBlue );
+    gradient.setColorAt( 1, Qt::darkRed );
+    p.fillRect( image.rect(), gradient );
+    p.setPen( Qt::white );
+    for ( int i = 0; i < 300; i += 12 )
+        p.drawLine( 0, i, 300 - i, 300 );
+    p.end();
+
+    QBuffer buffer( &m_cover );
+    buffer.open( QIODevice::WriteOnly );
+    image.save( &buffer, "PNG" );
+}
+
+
+void
+BenchmarkCoverPlugin::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
+{
+    if ( requestData.type != InfoSystem::InfoAlbumCoverArt )
+    {
+        emit info( requestData, QVariant() );
+        return;
+    }
+
+    QVariantMap returnedData;
+    returnedData["imgbytes"] = m_cover;
+    returnedData["url"] = QString( "http://localhost/benchmark/cover.png" );
+    emit info( requestData, returnedData );
+}
+
+
+CoverBenchmark::CoverBenchmark( int albums, QObject* parent )
+    : Benchmark( parent )
+    , m_albums( qMax( 1, albums ) )
+    , m_loaded( 0 )
+    , m_failed( 0 )
+    , m_done( false )
+    , m_requestTime( 0 )
+    , m_firstCover( -1 )
+{
+    m_timeout.setSingleShot( true );
+    m_timeout.setInterval( COVERBENCHMARK_TIMEOUT );
+    connect( &m_timeout, SIGNAL( timeout() ), SLOT( onTimeout() ) );
+}
+
+
+void
+CoverBenchmark::start()
+{
+    if ( m_timer.isValid() )
+        return;
+
+    tLog() << "Cover benchmark:" << m_albums << "albums";
+
+    artist_ptr artist;
+    for ( int i = 0; i < m_albums; i++ )
+    {
+        if ( i % COVERBENCHMARK_ALBUMS_PER_ARTIST == 0 )
+        {
+            const int id = i / COVERBENCHMARK_ALBUMS_PER_ARTIST + 1;
+            artist = Artist::get( id, QString( "Benchmark Artist %1" ).arg( id ) );
+        }
+
+        const album_ptr album = Album::get( i + 1, QString( "Benchmark Album %1" ).arg( i + 1 ), artist );
+        connect( album.data(), SIGNAL( updated() ), SLOT( onAlbumUpdated() ) );
+
+        m_albumList << album;
+        m_pending << album.data();
+    }
+
+    m_timer.start();
+    m_timeout.start();
+
+    const QSize size( COVERBENCHMARK_SIZE, COVERBENCHMARK_SIZE );
+    foreach ( const album_ptr& album, m_albumList )
+        album->cover( size );
+
+    m_requestTime = m_timer.elapsed();
+}
+
+
+void
+CoverBenchmark::onAlbumUpdated()
+{
+    Album* album = qobject_cast< Album* >( sender() );
+    if ( m_done || !album || !m_pending.contains( album ) )
+        return;
+
+    const QSize size( COVERBENCHMARK_SIZE, COVERBENCHMARK_SIZE );
+    if ( !album->cover( size, false ).isNull() )
+    {
+        if ( m_firstCover < 0 )
+            m_firstCover = m_timer.elapsed();
+
+        m_loaded++;
+    }
+    else if ( album->infoLoaded() && !album->coverPending( size ) )
+    {
+        m_failed++;
+    }
+    else
+        return;
+
+    disconnect( album, SIGNAL( updated() ), this, SLOT( onAlbumUpdated() ) );
+    m_pending.remove( album );
+    if ( m_pending.isEmpty() )
+        report();
+}
+
+
+void
+CoverBenchmark::onTimeout()
+{
+    if ( m_done )
+        return;
+
+    tLog() << "Cover benchmark: giving up, only" << m_loaded << "covers loaded," << m_failed << "failed";
+    report();
+}
+
+
+void
+CoverBenchmark::report()
+{
+    if ( m_done )
+        return;
+    m_done = true;
+    m_timeout.stop();
+
+    const qint64 elapsed = m_timer.elapsed();
+    const bool failed = m_failed || !m_pending.isEmpty();
+
+    QString out;
+    QTextStream s( &out );
+    s << "Cover benchmark results" << endl
+      << "  albums:      " << m_albums << " (" << COVERBENCHMARK_SIZE << "x" << COVERBENCHMARK_SIZE << " covers)" << endl
+      << "  requested:   " << m_requestTime << " ms" << endl
+      << "  first cover: " << m_firstCover << " ms" << endl
+      << "  loaded:      " << m_loaded << " in " << elapsed << " ms ("
+      << ( elapsed > 0 ? m_loaded * 1000.0 / elapsed : 0.0 ) << " covers/s)" << endl
+      << "  failed:      " << m_failed << ", " << m_pending.count() << " still pending" << endl;
+    if ( failed )
+        s << "  FAILED" << endl;
+
+    tLog() << out;
+    QTextStream( stdout ) << out;
+
+    finish( failed ? 1 : 0 );
+}
@@ -0,0 +1,112 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef COVERBENCHMARK_H
+#define COVERBENCHMARK_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QSet>
+#include <QTimer>
+
+#include "infosystem/infosystem.h"
+#include "typedefs.h"
+
+#include "benchmark.h"
+
+namespace Tomahawk
+{
+
+/*
+    Stands in for the cover art plugins: answers every InfoAlbumCoverArt
+    request right away, with the same PNG.
+*/
+class BenchmarkCoverPlugin : public InfoSystem::InfoPlugin
+{
+Q_OBJECT
+
+public:
+    BenchmarkCoverPlugin();
+
+protected slots:
+    virtual void getInfo( Tomahawk::InfoSystem::InfoRequestData requestData );
+
+    virtual void pushInfo( QString caller, Tomahawk::InfoSystem::InfoType type, QVariant data )
+    {
+        Q_UNUSED( caller );
+        Q_UNUSED( type );
+        Q_UNUSED( data );
+    }
+
+    virtual void notInCacheSlot( Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData )
+    {
+        Q_UNUSED( criteria );
+        Q_UNUSED( requestData );
+    }
+
+private:
+    QByteArray m_cover;
+};
+
+
+/*
+    Cover load throughput, "tomahawk-benchmarks covers". Keeps a number of
+    albums in memory and asks every one of them for its grid cover at once,
+    which goes through the InfoSystem, the reply routing to the album and
+    the background decode of the CoverCache. Reports covers per second and
+    the time to the first cover. Exits non-zero if a cover fails to load or
+    they don't all load in time.
+*/
+class CoverBenchmark : public Benchmark
+{
+Q_OBJECT
+
+public:
+    explicit CoverBenchmark( int albums, QObject* parent = 0 );
+
+public slots:
+    // call once the database is ready
+    virtual void start();
+
+private slots:
+    void onAlbumUpdated();
+    void onTimeout();
+
+private:
+    void report();
+
+    int m_albums;
+    QList< album_ptr > m_albumList;
+    // albums still waiting for their cover
+    QSet< Tomahawk::Album* > m_pending;
+    int m_loaded;
+    int m_failed;
+    bool m_done;
+
+    QElapsedTimer m_timer;
+    qint64 m_requestTime;
+    qint64 m_firstCover;
+    QTimer m_timeout;
+};
+
+}
+
+#endif // COVERBENCHMARK_H
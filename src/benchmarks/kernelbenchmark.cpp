@@ -0,0 +1,348 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kernelbenchmark.h"
+
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <qjson/serializer.h>
+
+#include "database/databaseimpl.h"
+#include "network/bufferiodevice.h"
+#include "network/msgprocessor.h"
+#include "album.h"
+#include "artist.h"
+#include "query.h"
+#include "result.h"
+#include "utils/logger.h"
+
+#include "alloccounter.h"
+
+#ifndef ENABLE_HEADLESS
+    #include "playlist/playlistmodel.h"
+    #include "playlist/trackproxymodel.h"
+#endif
+
+// size of the name corpus, every kernel cycles through it
+#define KERNELBENCHMARK_CORPUS 5000
+// rounds per kernel, the best one is reported
+#define KERNELBENCHMARK_ROUNDS 3
+// a round repeats the kernel for at least this long, the timer only has millisecond resolution
+#define KERNELBENCHMARK_ROUND_MS 200
+
+using namespace Tomahawk;
+
+static const char* s_words[] = {
+    "The", "Beatles", "Sigur", "R\xc3\xb3s", "Bj\xc3\xb6rk", "Mot\xc3\xb6rhead", "Cl\xc3\xa9ment",
+    "\xe5\x9d\x82\xe6\x9c\xac\xe9\xbe\x8d\xe4\xb8\x80", "\xd0\x9c\xd1\x83\xd0\xbc\xd0\xb8\xd0\xb9",
+    "\xd0\xa2\xd1\x80\xd0\xbe\xd0\xbb\xd0\xbb\xd1\x8c", "Daft", "Punk", "Orchestra", "Symphony", "No.",
+    "Live", "at", "Wembley", "Remastered", "Deluxe", "Edition", "feat.", "Mix", "of", "Love", "Night", "Blue",
+    "Caf\xc3\xa9", "Tanz", "Stra\xc3\x9fe", "\xc3\x85ngstr\xc3\xb6m", "Ni\xc3\xb1o", "and", "Friends"
+};
+static const int s_wordCount = sizeof( s_words ) / sizeof( s_words[0] );
+
+
+static QString
+phrase( quint32& seed, int words )
+{
+    QStringList l;
+    for ( int i = 0; i < words; i++ )
+    {
+        // plain LCG, the corpus is the same on every run
+        seed = seed * 1103515245 + 12345;
+        l << QString::fromUtf8( s_words[ ( seed >> 16 ) % s_wordCount ] );
+    }
+
+    return l.join( " " );
+}
+
+
+KernelBenchmark::KernelBenchmark( int scale, QObject* parent )
+    : Benchmark( parent )
+    , m_scale( qMax( 1, scale ) )
+    , m_device( 0 )
+#ifndef ENABLE_HEADLESS
+    , m_model( 0 )
+    , m_proxy( 0 )
+#endif
+    , m_sink( 0 )
+{
+    quint32 seed = 42;
+    for ( int i = 0; i < KERNELBENCHMARK_CORPUS; i++ )
+    {
+        m_names << phrase( seed, 1 + i % 3 );
+        // every tenth title is a long one
+        m_titles << phrase( seed, i % 10 ? 2 + i % 4 : 16 ) + ( i % 7 ? QString() : QString( " (Remastered %1)" ).arg( 1960 + i % 50 ) );
+    }
+
+    for ( int i = 0; i < KERNELBENCHMARK_CORPUS; i++ )
+    {
+        const QString artist = m_names.at( i );
+        const QString album = m_titles.at( ( i * 7 ) % KERNELBENCHMARK_CORPUS );
+        const QString track = m_titles.at( i );
+        m_queries << Query::get( artist, track, album, uuid(), false );
+
+        // results differ slightly from their queries, like they do in real life
+        const artist_ptr a = Artist::get( i + 1, artist + ( i % 3 ? "" : " Band" ) );
+        result_ptr r = Result::get( QString( "file:///benchmark/kernel/%1.mp3" ).arg( i ) );
+        r->setArtist( a );
+        r->setAlbum( Album::get( i + 1, album, a ) );
+        r->setTrack( i % 2 ? track : track.toUpper() );
+        m_results << r;
+    }
+
+    // a big op, as it goes over the wire when syncing a collection
+    QVariantList files;
+    for ( int i = 0; i < 500; i++ )
+    {
+        QVariantMap m;
+        m["url"] = QString( "/home/user/Music/%1/%2.mp3" ).arg( m_names.at( i ) ).arg( m_titles.at( i ) );
+        m["artist"] = m_names.at( i );
+        m["album"] = m_titles.at( ( i * 7 ) % KERNELBENCHMARK_CORPUS );
+        m["track"] = m_titles.at( i );
+        m["mimetype"] = "audio/mpeg";
+        m["size"] = 4000000 + i;
+        m["mtime"] = 1320000000 + i;
+        m["duration"] = 180 + i % 120;
+        m["bitrate"] = 320;
+        m["albumpos"] = i % 14;
+        m["hash"] = QString( "%1" ).arg( qHash( m_titles.at( i ) ), 32, 16, QChar( '0' ) );
+        files << m;
+    }
+    QVariantMap op;
+    op["command"] = "addfiles";
+    op["guid"] = uuid();
+    op["files"] = files;
+
+    QJson::Serializer serializer;
+    m_payload = serializer.serialize( op );
+    m_compressed = qCompress( m_payload, 9 );
+}
+
+
+KernelBenchmark::~KernelBenchmark()
+{
+    delete m_device;
+#ifndef ENABLE_HEADLESS
+    delete m_proxy;
+    delete m_model;
+#endif
+}
+
+
+void
+KernelBenchmark::start()
+{
+    if ( !m_report.isEmpty() )
+        return;
+
+    const int blocks = 64;
+    m_device = new BufferIODevice( blocks * BufferIODevice::blockSize() );
+    for ( int i = 0; i < blocks; i++ )
+        m_device->addData( i, QByteArray( BufferIODevice::blockSize(), (char)i ) );
+    m_device->open( QIODevice::ReadOnly );
+
+#ifndef ENABLE_HEADLESS
+    m_model = new PlaylistModel();
+    m_model->append( m_queries );
+
+    m_proxy = new TrackProxyModel();
+    m_proxy->setSourceTrackModel( m_model );
+#endif
+
+    QTextStream( &m_report ) << "Kernel benchmark results (" << m_names.count() << " names, "
+                             << m_payload.size() / 1024 << " KB payload)" << endl;
+
+    run( "Query::levenshtein", &KernelBenchmark::levenshtein, 200000 );
+    run( "Query::howSimilar", &KernelBenchmark::howSimilar, 50000 );
+    run( "DatabaseImpl::sortname", &KernelBenchmark::sortname, 200000 );
+#ifndef ENABLE_HEADLESS
+    run( "TrackProxyModel::filterAcceptsRow", &KernelBenchmark::proxyFilter, 10 );
+    run( "TrackProxyModel::lessThan (per row)", &KernelBenchmark::proxySort, 4 );
+#endif
+    run( "BufferIODevice::read 4KB", &KernelBenchmark::bufferRead, 200000 );
+    run( "MsgProcessor::process compress", &KernelBenchmark::compress, 50 );
+    run( "MsgProcessor::process uncompress", &KernelBenchmark::uncompress, 500 );
+
+    tLog() << m_report;
+    QTextStream( stdout ) << m_report;
+
+    finish();
+}
+
+
+void
+KernelBenchmark::run( const QString& name, Kernel kernel, int ops )
+{
+    ops *= m_scale;
+
+    // warm up caches and lazily built state
+    ( this->*kernel )( qMax( 1, ops / 10 ) );
+
+    double best = -1;
+    double allocs = -1;
+    qint64 done = 0;
+    for ( int i = 0; i < KERNELBENCHMARK_ROUNDS; i++ )
+    {
+        // QElapsedTimer::nsecsElapsed() needs Qt 4.8
+        const int allocStart = AllocCounter::count();
+        QElapsedTimer timer;
+        timer.start();
+        done = 0;
+        do
+        {
+            done += ( this->*kernel )( ops );
+        }
+        while ( timer.elapsed() < KERNELBENCHMARK_ROUND_MS );
+        const qint64 ms = timer.elapsed();
+        const int allocCount = AllocCounter::count() - allocStart;
+
+        const double perOp = done ? (double)ms * 1000000 / done : 0;
+        if ( best < 0 || perOp < best )
+            best = perOp;
+
+        const double allocsPerOp = done ? (double)allocCount / done : 0;
+        if ( allocs < 0 || allocsPerOp < allocs )
+            allocs = allocsPerOp;
+    }
+
+    QTextStream( &m_report ) << "  " << name.leftJustified( 40 )
+                             << QString::number( best, 'f', 1 ).rightJustified( 12 ) << " ns/op "
+                             << QString::number( allocs, 'f', 2 ).rightJustified( 10 ) << " allocs/op  ("
+                             << done << " ops)" << endl;
+}
+
+
+qint64
+KernelBenchmark::levenshtein( int ops )
+{
+    const int n = m_titles.count();
+    for ( int i = 0; i < ops; i++ )
+        m_sink += Query::levenshtein( m_titles.at( i % n ), m_titles.at( ( i * 7 + 1 ) % n ) );
+
+    return ops;
+}
+
+
+qint64
+KernelBenchmark::howSimilar( int ops )
+{
+    const int n = m_queries.count();
+    for ( int i = 0; i < ops; i++ )
+        m_sink += m_queries.at( i % n )->howSimilar( m_results.at( ( i + i / n ) % n ) ) * 100;
+
+    return ops;
+}
+
+
+qint64
+KernelBenchmark::sortname( int ops )
+{
+    const int n = m_titles.count();
+    for ( int i = 0; i < ops; i++ )
+        m_sink += DatabaseImpl::sortname( m_titles.at( i % n ), true, i % 2 ).length();
+
+    return ops;
+}
+
+
+#ifndef ENABLE_HEADLESS
+qint64
+KernelBenchmark::proxyFilter( int ops )
+{
+    // every op is one refilter of all rows, alternating between filters that
+    // match a lot and ones that match next to nothing
+    const QStringList filters = QStringList() << "the" << "sigur ros" << "live wembley" << "zzz" << "deluxe edition mix";
+    for ( int i = 0; i < ops; i++ )
+    {
+        m_proxy->setFilterRegExp( filters.at( i % filters.count() ) );
+        m_sink += m_proxy->rowCount( QModelIndex() );
+    }
+    m_proxy->setFilterRegExp( QString() );
+
+    return (qint64)ops * m_model->rowCount( QModelIndex() );
+}
+
+
+qint64
+KernelBenchmark::proxySort( int ops )
+{
+    // every op is one full sort, reported per row
+    const QList< int > columns = QList< int >() << TrackModel::Artist << TrackModel::Track << TrackModel::Album << TrackModel::Year;
+    for ( int i = 0; i < ops; i++ )
+    {
+        m_proxy->sort( columns.at( i % columns.count() ), i % 2 ? Qt::DescendingOrder : Qt::AscendingOrder );
+        m_sink += m_proxy->mapToSource( m_proxy->index( 0, 0 ) ).row();
+    }
+
+    return (qint64)ops * m_model->rowCount( QModelIndex() );
+}
+#endif
+
+
+qint64
+KernelBenchmark::bufferRead( int ops )
+{
+    char buf[4096];
+    const qint64 range = m_device->size() - sizeof( buf );
+    quint32 seed = 42;
+    for ( int i = 0; i < ops; i++ )
+    {
+        // mostly sequential reads like a playing stream, with the odd seek
+        if ( i % 64 == 0 )
+        {
+            seed = seed * 1103515245 + 12345;
+            m_device->seek( ( seed >> 8 ) % range );
+        }
+        else if ( m_device->pos() >= range )
+        {
+            m_device->seek( 0 );
+        }
+
+        m_sink += m_device->read( buf, sizeof( buf ) );
+    }
+
+    return ops;
+}
+
+
+qint64
+KernelBenchmark::compress( int ops )
+{
+    for ( int i = 0; i < ops; i++ )
+    {
+        msg_ptr msg = MsgProcessor::process( Msg::factory( m_payload, Msg::JSON ), MsgProcessor::COMPRESS_IF_LARGE, 512 );
+        m_sink += msg->length();
+    }
+
+    return ops;
+}
+
+
+qint64
+KernelBenchmark::uncompress( int ops )
+{
+    for ( int i = 0; i < ops; i++ )
+    {
+        msg_ptr msg = MsgProcessor::process( Msg::factory( m_compressed, Msg::JSON | Msg::COMPRESSED ), MsgProcessor::UNCOMPRESS_ALL, 512 );
+        m_sink += msg->length();
+    }
+
+    return ops;
+}
@@ -0,0 +1,93 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNELBENCHMARK_H
+#define KERNELBENCHMARK_H
+
+#include <QObject>
+#include <QStringList>
+
+#include "typedefs.h"
+
+#include "benchmark.h"
+
+class BufferIODevice;
+class PlaylistModel;
+class TrackProxyModel;
+
+namespace Tomahawk
+{
+
+/*
+    Micro-benchmarks for the per-row kernels of the views and the resolve
+    path, "tomahawk-benchmarks kernels". Every kernel runs on a synthetic
+    corpus of unicode names, long titles and big payloads, and reports the
+    best of a few rounds in ns per op, next to the heap allocations per op.
+    Models and buffers are set up once, outside the timed rounds. scale
+    multiplies the ops per round.
+*/
+class KernelBenchmark : public Benchmark
+{
+Q_OBJECT
+
+public:
+    explicit KernelBenchmark( int scale, QObject* parent = 0 );
+    virtual ~KernelBenchmark();
+
+public slots:
+    virtual void start();
+
+private:
+    typedef qint64 ( KernelBenchmark::*Kernel )( int ops );
+
+    // runs kernel a few times, a kernel returns the number of ops it did
+    void run( const QString& name, Kernel kernel, int ops );
+
+    qint64 levenshtein( int ops );
+    qint64 howSimilar( int ops );
+    qint64 sortname( int ops );
+    qint64 bufferRead( int ops );
+    qint64 compress( int ops );
+    qint64 uncompress( int ops );
+#ifndef ENABLE_HEADLESS
+    qint64 proxyFilter( int ops );
+    qint64 proxySort( int ops );
+#endif
+
+    int m_scale;
+    QStringList m_names;
+    QStringList m_titles;
+    QList< query_ptr > m_queries;
+    QList< result_ptr > m_results;
+    QByteArray m_payload;
+    QByteArray m_compressed;
+
+    BufferIODevice* m_device;
+#ifndef ENABLE_HEADLESS
+    PlaylistModel* m_model;
+    TrackProxyModel* m_proxy;
+#endif
+
+    QString m_report;
+    // keeps the compiler from dropping the work
+    qint64 m_sink;
+};
+
+}
+
+#endif // KERNELBENCHMARK_H
@@ -0,0 +1,250 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QSettings>
+#include <QStringList>
+#include <QTextStream>
+#include <QTcpSocket>
+#include <QHostAddress>
+
+#ifndef ENABLE_HEADLESS
+    #include <QApplication>
+#else
+    #include <QCoreApplication>
+#endif
+
+#include "database/database.h"
+#include "database/databasecommand.h"
+#include "database/databaseresolver.h"
+#include "database/localcollection.h"
+#include "infosystem/infosystem.h"
+#include "network/connection.h"
+#include "network/dbsyncconnection.h"
+#include "network/servent.h"
+#include "playlist/trackstore.h"
+#include "pipeline.h"
+#include "source.h"
+#include "sourcelist.h"
+#include "tomahawksettings.h"
+#include "utils/tomahawkutils.h"
+#include "utils/logger.h"
+
+#ifndef ENABLE_HEADLESS
+    #include "coverbenchmark.h"
+#endif
+#include "kernelbenchmark.h"
+#include "resolvebenchmark.h"
+#include "syncbenchmark.h"
+
+using namespace Tomahawk;
+
+
+static void
+printHelp()
+{
+    QTextStream out( stdout );
+    out << "Usage: tomahawk-benchmarks <benchmark> [parameters]" << endl << endl
+        << "Every benchmark runs on a synthetic collection in a data dir of its own, which gets removed afterwards." << endl << endl
+        << "  resolve [tracks] [queries] [resolvers] [latency]" << endl
+        << "                 Resolve latency and throughput of the Pipeline, with stub resolvers" << endl
+        << "  kernels [scale]" << endl
+        << "                 Micro-benchmarks of the per-row string, model and network kernels" << endl
+        << "  sync [peers] [tracks] [port]" << endl
+        << "                 Sync and streaming against local peer processes" << endl
+#ifndef ENABLE_HEADLESS
+        << "  covers [albums]" << endl
+        << "                 Cover load throughput of albums in memory, with a stub cover art plugin" << endl
+#endif
+        << endl
+        << "  --instance <name>" << endl
+        << "                 Name of the data dir, instead of one named after the process" << endl;
+}
+
+
+static QList< int >
+params( const QStringList& args, const QList< int >& defaults )
+{
+    // optional numeric parameters following the benchmark name, in order
+    QList< int > params = defaults;
+    for ( int i = 0; i < params.count() && i + 2 < args.count(); i++ )
+    {
+        bool ok;
+        const int v = args.at( i + 2 ).toInt( &ok );
+        if ( !ok )
+            break;
+
+        params[i] = v;
+    }
+
+    return params;
+}
+
+
+static void
+registerMetaTypes()
+{
+    // the subset of TomahawkApp::registerMetaTypes() the benchmarks get to
+    qRegisterMetaType< QSharedPointer<DatabaseCommand> >("QSharedPointer<DatabaseCommand>");
+    qRegisterMetaType< DBSyncConnection::State >("DBSyncConnection::State");
+    qRegisterMetaType< msg_ptr >("msg_ptr");
+    qRegisterMetaType< QList<dbop_ptr> >("QList<dbop_ptr>");
+    qRegisterMetaType< QList<QVariantMap> >("QList<QVariantMap>");
+    qRegisterMetaType< QList<TrackStore::Record> >("QList<TrackStore::Record>");
+    qRegisterMetaType< Connection* >("Connection*");
+    qRegisterMetaType< QAbstractSocket::SocketError >("QAbstractSocket::SocketError");
+    qRegisterMetaType< QTcpSocket* >("QTcpSocket*");
+    qRegisterMetaType< QSharedPointer<QIODevice> >("QSharedPointer<QIODevice>");
+    qRegisterMetaType< QHostAddress >("QHostAddress");
+
+    qRegisterMetaType< Tomahawk::source_ptr >("Tomahawk::source_ptr");
+    qRegisterMetaType< Tomahawk::collection_ptr >("Tomahawk::collection_ptr");
+    qRegisterMetaType< Tomahawk::result_ptr >("Tomahawk::result_ptr");
+    qRegisterMetaType< Tomahawk::query_ptr >("Tomahawk::query_ptr");
+    qRegisterMetaType< QList<Tomahawk::query_ptr> >("QList<Tomahawk::query_ptr>");
+    qRegisterMetaType< QList<Tomahawk::result_ptr> >("QList<Tomahawk::result_ptr>");
+    qRegisterMetaType< QList<Tomahawk::artist_ptr> >("QList<Tomahawk::artist_ptr>");
+    qRegisterMetaType< QList<Tomahawk::album_ptr> >("QList<Tomahawk::album_ptr>");
+    qRegisterMetaType< QList<Tomahawk::source_ptr> >("QList<Tomahawk::source_ptr>");
+    qRegisterMetaType< Tomahawk::QID >("Tomahawk::QID");
+
+    qRegisterMetaType< Tomahawk::InfoSystem::InfoStringHash >( "Tomahawk::InfoSystem::InfoStringHash" );
+    qRegisterMetaType< Tomahawk::InfoSystem::InfoType >( "Tomahawk::InfoSystem::InfoType" );
+    qRegisterMetaType< Tomahawk::InfoSystem::InfoRequestData >( "Tomahawk::InfoSystem::InfoRequestData" );
+    qRegisterMetaType< Tomahawk::InfoSystem::InfoSystemCache* >( "Tomahawk::InfoSystem::InfoSystemCache*" );
+    qRegisterMetaType< Tomahawk::InfoSystem::InfoPlugin* >( "Tomahawk::InfoSystem::InfoPlugin*" );
+}
+
+
+int
+main( int argc, char *argv[] )
+{
+#ifndef ENABLE_HEADLESS
+    QApplication app( argc, argv );
+#else
+    QCoreApplication app( argc, argv );
+#endif
+
+    const QStringList args = app.arguments();
+    const QString name = args.value( 1 );
+    if ( name.isEmpty() || name == "--help" || name == "-h" )
+    {
+        printHelp();
+        return name.isEmpty() ? 1 : 0;
+    }
+
+    // appDataDir() and the settings are named after the organization, so an organization
+    // of its own keeps every benchmark process away from the real collection and from each other
+    const int instanceArg = args.indexOf( "--instance" );
+    const QString instance = instanceArg > 0 ? args.value( instanceArg + 1 ) : QString();
+    app.setOrganizationName( instance.isEmpty() ? Benchmark::instanceName( app.applicationPid() ) : instance );
+    app.setApplicationName( "Tomahawk" );
+    const QDir dataDir = TomahawkUtils::appDataDir();
+    QDir settingsDir = dataDir;
+    settingsDir.cdUp();
+    QSettings::setDefaultFormat( QSettings::IniFormat );
+    QSettings::setPath( QSettings::IniFormat, QSettings::UserScope, settingsDir.absolutePath() );
+
+    registerMetaTypes();
+    TomahawkSettings* settings = new TomahawkSettings();
+    Logger::setupLogfile();
+    tLog() << "Running benchmark" << name << "in" << dataDir.absolutePath();
+
+    new Pipeline();
+    Database* database = new Database( dataDir.absoluteFilePath( "tomahawk.db" ) );
+
+    source_ptr src( new Source( 0, "My Collection" ) );
+    src->addCollection( collection_ptr( new LocalCollection( src ) ) );
+    SourceList::instance()->setLocal( src );
+
+    Pipeline::instance()->addResolver( new DatabaseResolver( 100 ) );
+
+    Servent* servent = 0;
+    InfoSystem::InfoSystem* infoSystem = 0;
+    Benchmark* benchmark = 0;
+    int exitCode = 0;
+    if ( name == "resolve" )
+    {
+        const QList< int > p = params( args, QList< int >() << 10000 << 1000 << 2 << 50 );
+        ResolveBenchmark* b = new ResolveBenchmark( p[0], p[1], p[2], p[3] );
+        b->addResolvers();
+        benchmark = b;
+    }
+    else if ( name == "kernels" )
+    {
+        const QList< int > p = params( args, QList< int >() << 1 );
+        benchmark = new KernelBenchmark( p[0] );
+    }
+    else if ( name == "sync" || name == "sync-peer" )
+    {
+        // every sync peer is a process of its own, see SyncBenchmark
+        const bool peer = ( name == "sync-peer" );
+        const QList< int > p = peer ? params( args, QList< int >() << 0 << 50301 << 5000 )
+                                    : params( args, QList< int >() << 4 << 5000 << 50300 );
+        const int port = peer ? p[1] : p[2];
+
+        servent = new Servent();
+        SourceList::instance()->loadSources();
+        if ( !servent->startListening( QHostAddress( QHostAddress::LocalHost ), false, port ) )
+        {
+            tLog() << "Benchmark: could not listen on port" << port;
+            exitCode = 1;
+        }
+        else if ( peer )
+            benchmark = new SyncBenchmarkPeer( p[0], p[2] );
+        else
+            benchmark = new SyncBenchmark( p[0], p[1], port );
+    }
+#ifndef ENABLE_HEADLESS
+    else if ( name == "covers" )
+    {
+        const QList< int > p = params( args, QList< int >() << 50000 );
+
+        infoSystem = new InfoSystem::InfoSystem( &app );
+        infoSystem->addInfoPlugin( new BenchmarkCoverPlugin() );
+        benchmark = new CoverBenchmark( p[0] );
+    }
+#endif
+    else
+    {
+        printHelp();
+        exitCode = 1;
+    }
+
+    if ( benchmark )
+    {
+        QObject::connect( database, SIGNAL( ready() ), benchmark, SLOT( start() ), Qt::QueuedConnection );
+        QObject::connect( benchmark, SIGNAL( finished() ), &app, SLOT( quit() ), Qt::QueuedConnection );
+
+        Pipeline::instance()->databaseReady();
+
+        exitCode = app.exec();
+        if ( !exitCode )
+            exitCode = benchmark->exitCode();
+    }
+
+    delete benchmark;
+    delete infoSystem;
+    delete servent;
+    delete database;
+
+    // nothing may write the settings after their directory is gone
+    delete settings;
+    Benchmark::removeDir( dataDir );
+
+    return exitCode;
+}
@@ -0,0 +1,285 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resolvebenchmark.h"
+
+#include <QDateTime>
+#include <QTextStream>
+#include <QTimer>
+
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "database/database.h"
+#include "database/databasecommand_addfiles.h"
+#include "database/databasecommand_updatesearchindex.h"
+#include "pipeline.h"
+#include "query.h"
+#include "sourcelist.h"
+#include "utils/logger.h"
+
+// files per DatabaseCommand_AddFiles while building the collection
+#define RESOLVEBENCHMARK_CHUNK 1000
+#define RESOLVEBENCHMARK_TRACKS_PER_ALBUM 12
+#define RESOLVEBENCHMARK_ALBUMS_PER_ARTIST 4
+
+using namespace Tomahawk;
+
+
+static qint64
+peakRss()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) != 0 )
+        return -1;
+
+#ifdef Q_OS_MAC
+    return usage.ru_maxrss / 1024; // bytes
+#else
+    return usage.ru_maxrss; // kilobytes
+#endif
+#else
+    return -1;
+#endif
+}
+
+
+static qint64
+percentile( const QVector< qint64 >& sorted, int p )
+{
+    if ( sorted.isEmpty() )
+        return 0;
+
+    const int i = qBound( 0, ( sorted.count() * p + 99 ) / 100 - 1, sorted.count() - 1 );
+    return sorted.at( i );
+}
+
+
+BenchmarkResolver::BenchmarkResolver( int number, unsigned int weight, int latency )
+    : Resolver()
+    , m_name( QString( "Benchmark Resolver %1" ).arg( number ) )
+    , m_weight( weight )
+    , m_latency( latency )
+{
+}
+
+
+void
+BenchmarkResolver::resolve( const Tomahawk::query_ptr& query )
+{
+    // same delay for every query, so they come due in order
+    m_pending.enqueue( query->id() );
+    QTimer::singleShot( m_latency, this, SLOT( respond() ) );
+}
+
+
+void
+BenchmarkResolver::respond()
+{
+    if ( m_pending.isEmpty() )
+        return;
+
+    Pipeline::instance()->reportResults( m_pending.dequeue(), QList< result_ptr >() );
+}
+
+
+ResolveBenchmark::ResolveBenchmark( int tracks, int queries, int resolvers, int latency, QObject* parent )
+    : Benchmark( parent )
+    , m_tracks( qMax( 1, tracks ) )
+    , m_queries( qMax( 1, queries ) )
+    , m_resolvers( qMax( 0, resolvers ) )
+    , m_latency( qMax( 0, latency ) )
+    , m_started( false )
+    , m_pendingCommands( 0 )
+    , m_populateTime( 0 )
+    , m_resolveStart( 0 )
+    , m_solved( 0 )
+{
+}
+
+
+QVariantMap
+ResolveBenchmark::syntheticFile( int i, const QString& prefix )
+{
+    const int album = i / RESOLVEBENCHMARK_TRACKS_PER_ALBUM;
+    const int artist = album / RESOLVEBENCHMARK_ALBUMS_PER_ARTIST;
+
+    QVariantMap m;
+    m["url"] = QString( "file:///benchmark/%1/%2.mp3" ).arg( prefix ).arg( i );
+    m["mtime"] = QDateTime::currentDateTime().toTime_t();
+    m["size"] = 4 * 1024 * 1024;
+    m["hash"] = QString();
+    m["mimetype"] = "audio/mpeg";
+    m["duration"] = 180 + i % 120;
+    m["bitrate"] = 192;
+    m["artist"] = QString( "%1 Artist %2" ).arg( prefix ).arg( artist );
+    m["album"] = QString( "%1 Album %2" ).arg( prefix ).arg( album );
+    m["track"] = QString( "%1 Track %2" ).arg( prefix ).arg( i );
+    m["albumpos"] = i % RESOLVEBENCHMARK_TRACKS_PER_ALBUM + 1;
+    m["discnumber"] = 1;
+    m["year"] = 2000 + artist % 12;
+
+    return m;
+}
+
+
+void
+ResolveBenchmark::addResolvers()
+{
+    // below the DatabaseResolver, like script resolvers usually are
+    for ( int i = 0; i < m_resolvers; i++ )
+        Pipeline::instance()->addResolver( new BenchmarkResolver( i + 1, 90 - i, m_latency ) );
+}
+
+
+void
+ResolveBenchmark::start()
+{
+    if ( m_started )
+        return;
+    m_started = true;
+
+    tLog() << "Resolve benchmark:" << m_tracks << "tracks," << m_queries << "queries,"
+           << m_resolvers << "stub resolvers with" << m_latency << "ms latency";
+
+    const source_ptr local = SourceList::instance()->getLocal();
+
+    m_timer.start();
+    QVariantList files;
+    for ( int i = 0; i < m_tracks; i++ )
+    {
+        files << syntheticFile( i, "Benchmark" );
+
+        if ( files.count() == RESOLVEBENCHMARK_CHUNK || i == m_tracks - 1 )
+        {
+            DatabaseCommand_AddFiles* cmd = new DatabaseCommand_AddFiles( files, local );
+            connect( cmd, SIGNAL( finished() ), SLOT( populated() ), Qt::QueuedConnection );
+            m_pendingCommands++;
+
+            Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+            files.clear();
+        }
+    }
+}
+
+
+void
+ResolveBenchmark::populated()
+{
+    if ( --m_pendingCommands > 0 )
+        return;
+
+    DatabaseCommand_UpdateSearchIndex* cmd = new DatabaseCommand_UpdateSearchIndex();
+    connect( cmd, SIGNAL( finished() ), SLOT( indexed() ), Qt::QueuedConnection );
+    Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+}
+
+
+void
+ResolveBenchmark::indexed()
+{
+    m_populateTime = m_timer.elapsed();
+    tLog() << "Resolve benchmark: collection ready after" << m_populateTime << "ms";
+
+    // every fifth query asks for something that isn't in the collection
+    for ( int i = 0; i < m_queries; i++ )
+    {
+        const QVariantMap f = syntheticFile( ( i * 7919 ) % m_tracks, "Benchmark" );
+        const bool miss = ( i % 5 == 4 );
+
+        query_ptr q = Query::get( f.value( "artist" ).toString(),
+                                  miss ? QString( "Missing Song %1" ).arg( i ) : f.value( "track" ).toString(),
+                                  f.value( "album" ).toString(), uuid(), false );
+        connect( q.data(), SIGNAL( resolvingFinished( bool ) ), SLOT( onResolvingFinished( bool ) ) );
+        m_queryList << q;
+    }
+
+    m_latencies.reserve( m_queries );
+    foreach ( const query_ptr& q, m_queryList )
+        m_queryStart.insert( q.data(), -1 );
+
+    // the Pipeline only has a few queries in flight at once, the others wait in its queue
+    connect( Pipeline::instance(), SIGNAL( resolving( Tomahawk::query_ptr ) ), SLOT( onResolving( Tomahawk::query_ptr ) ) );
+
+    m_resolveStart = m_timer.elapsed();
+    Pipeline::instance()->resolve( m_queryList, false );
+}
+
+
+void
+ResolveBenchmark::onResolving( const Tomahawk::query_ptr& query )
+{
+    // emitted again for every further resolver a query gets dispatched to
+    QHash< Tomahawk::Query*, qint64 >::iterator it = m_queryStart.find( query.data() );
+    if ( it != m_queryStart.end() && it.value() < 0 )
+        it.value() = m_timer.elapsed();
+}
+
+
+void
+ResolveBenchmark::onResolvingFinished( bool hasResults )
+{
+    Query* q = qobject_cast< Query* >( sender() );
+    if ( !q || !m_queryStart.contains( q ) )
+        return;
+
+    // never dispatched at all, e.g. solved from the resolve cache
+    const qint64 start = m_queryStart.take( q );
+    m_latencies << ( start < 0 ? 0 : m_timer.elapsed() - start );
+    if ( hasResults )
+        m_solved++;
+
+    if ( m_queryStart.isEmpty() )
+        report();
+}
+
+
+void
+ResolveBenchmark::report()
+{
+    const qint64 total = m_timer.elapsed() - m_resolveStart;
+
+    QVector< qint64 > sorted = m_latencies;
+    std::sort( sorted.begin(), sorted.end() );
+
+    QString out;
+    QTextStream s( &out );
+    s << "Resolve benchmark results" << endl
+      << "  tracks:           " << m_tracks << endl
+      << "  queries:          " << m_queries << " (" << m_solved << " with results)" << endl
+      << "  stub resolvers:   " << m_resolvers << " x " << m_latency << " ms" << endl
+      << "  populate + index: " << m_populateTime << " ms" << endl
+      << "  resolve total:    " << total << " ms" << endl
+      << "  throughput:       " << ( total > 0 ? m_queries * 1000.0 / total : 0.0 ) << " queries/s" << endl
+      << "  latency p50:      " << percentile( sorted, 50 ) << " ms" << endl
+      << "  latency p95:      " << percentile( sorted, 95 ) << " ms" << endl
+      << "  latency p99:      " << percentile( sorted, 99 ) << " ms" << endl
+      << "  latency max:      " << ( sorted.isEmpty() ? 0 : sorted.last() ) << " ms" << endl
+      << "  peak RSS:         " << peakRss() << " KB" << endl;
+
+    tLog() << out;
+    QTextStream( stdout ) << out;
+
+    disconnect( Pipeline::instance(), SIGNAL( resolving( Tomahawk::query_ptr ) ), this, SLOT( onResolving( Tomahawk::query_ptr ) ) );
+    m_queryList.clear();
+    finish();
+}
@@ -0,0 +1,121 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESOLVEBENCHMARK_H
+#define RESOLVEBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QVariantMap>
+#include <QVector>
+
+#include "resolver.h"
+#include "typedefs.h"
+
+#include "benchmark.h"
+
+namespace Tomahawk
+{
+
+/*
+    Stands in for a script resolver: answers every query without results,
+    after a fixed delay.
+*/
+class BenchmarkResolver : public Resolver
+{
+Q_OBJECT
+
+public:
+    explicit BenchmarkResolver( int number, unsigned int weight, int latency );
+
+    virtual QString name() const { return m_name; }
+    virtual unsigned int weight() const { return m_weight; }
+    virtual unsigned int timeout() const { return 5000; }
+
+public slots:
+    virtual void resolve( const Tomahawk::query_ptr& query );
+
+private slots:
+    void respond();
+
+private:
+    QString m_name;
+    unsigned int m_weight;
+    int m_latency;
+    QQueue< QID > m_pending;
+};
+
+
+/*
+    Load generator for the resolve pipeline, "tomahawk-benchmarks resolve".
+    Fills the (temporary) database with a synthetic collection, then fires
+    all queries at the Pipeline at once and reports resolve latency
+    percentiles, throughput and the peak RSS of the process. A query's
+    latency counts from when the Pipeline dispatches it to its first
+    resolver, not from when it got queued.
+*/
+class ResolveBenchmark : public Benchmark
+{
+Q_OBJECT
+
+public:
+    explicit ResolveBenchmark( int tracks, int queries, int resolvers, int latency, QObject* parent = 0 );
+
+    // adds the stub resolvers to the pipeline
+    void addResolvers();
+
+    // the i-th file of a synthetic collection, 12 tracks per album and 4 albums per artist
+    static QVariantMap syntheticFile( int i, const QString& prefix );
+
+public slots:
+    // call once the database is ready
+    virtual void start();
+
+private slots:
+    void populated();
+    void indexed();
+    void onResolving( const Tomahawk::query_ptr& query );
+    void onResolvingFinished( bool hasResults );
+
+private:
+    void report();
+
+    int m_tracks;
+    int m_queries;
+    int m_resolvers;
+    int m_latency;
+    bool m_started;
+
+    int m_pendingCommands;
+    QElapsedTimer m_timer;
+    qint64 m_populateTime;
+    qint64 m_resolveStart;
+
+    QList< query_ptr > m_queryList;
+    // queries not done yet, with the time they got dispatched at or -1 while still queued
+    QHash< Tomahawk::Query*, qint64 > m_queryStart;
+    QVector< qint64 > m_latencies;
+    int m_solved;
+};
+
+}
+
+#endif // RESOLVEBENCHMARK_H
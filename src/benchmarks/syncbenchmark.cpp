@@ -0,0 +1,538 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "syncbenchmark.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QTextStream>
+
+#include "database/database.h"
+#include "database/databasecommand_addfiles.h"
+#include "database/databasecommand_collectionstats.h"
+#include "network/controlconnection.h"
+#include "network/dbsyncconnection.h"
+#include "network/servent.h"
+#include "utils/tomahawkutils.h"
+#include "utils/logger.h"
+#include "pipeline.h"
+#include "query.h"
+#include "source.h"
+#include "sourcelist.h"
+
+#include "resolvebenchmark.h"
+
+// a peer announces itself on stdout with "<prefix> <port> <dbid> <ops> <numfiles> <lastop>"
+#define SYNCBENCHMARK_READY "TOMAHAWK-BENCHMARK-READY"
+// files per oplog entry, like the scanner
+#define SYNCBENCHMARK_CHUNK 500
+// the one file of every peer that really exists, for streaming
+#define SYNCBENCHMARK_STREAM_SIZE (1024 * 1024)
+// give up on peers that don't sync or stream in time
+#define SYNCBENCHMARK_TIMEOUT (10 * 60 * 1000)
+
+using namespace Tomahawk;
+
+
+SyncBenchmark::SyncBenchmark( int peers, int tracks, int port, QObject* parent )
+    : Benchmark( parent )
+    , m_tracks( qMax( 1, tracks ) )
+    , m_port( port )
+    , m_readyPeers( 0 )
+    , m_syncedPeers( 0 )
+    , m_verifiedPeers( 0 )
+    , m_streamedPeers( 0 )
+    , m_failed( false )
+    , m_done( false )
+    , m_connectStart( 0 )
+{
+    for ( int i = 0; i < qMax( 1, peers ); i++ )
+        m_peers << Peer();
+
+    m_timeout.setSingleShot( true );
+    m_timeout.setInterval( SYNCBENCHMARK_TIMEOUT );
+    connect( &m_timeout, SIGNAL( timeout() ), SLOT( onTimeout() ) );
+}
+
+
+SyncBenchmark::~SyncBenchmark()
+{
+    stopPeers();
+}
+
+
+void
+SyncBenchmark::start()
+{
+    if ( m_timer.isValid() )
+        return;
+
+    tLog() << "Sync benchmark:" << m_peers.count() << "peers with" << m_tracks << "tracks each";
+    m_timer.start();
+    m_timeout.start();
+
+    connect( SourceList::instance(), SIGNAL( sourceAdded( Tomahawk::source_ptr ) ),
+                                       SLOT( onSourceAdded( Tomahawk::source_ptr ) ) );
+
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        Peer& peer = m_peers[ i ];
+        peer.instance = QString( "%1-%2" ).arg( instanceName( QCoreApplication::applicationPid() ) ).arg( i );
+        peer.port = m_port + 1 + i;
+        peer.process = new QProcess( this );
+        peer.process->setProcessChannelMode( QProcess::SeparateChannels );
+        peer.process->setProperty( "peer", i );
+
+        connect( peer.process, SIGNAL( readyReadStandardOutput() ), SLOT( onPeerOutput() ) );
+        connect( peer.process, SIGNAL( finished( int ) ), SLOT( onPeerFinished( int ) ) );
+
+        QStringList args;
+        args << "sync-peer" << QString::number( i ) << QString::number( peer.port ) << QString::number( m_tracks )
+             << "--instance" << peer.instance;
+        peer.process->start( QCoreApplication::applicationFilePath(), args );
+    }
+}
+
+
+void
+SyncBenchmark::onPeerOutput()
+{
+    QProcess* process = qobject_cast< QProcess* >( sender() );
+    const int index = process->property( "peer" ).toInt();
+    Peer& peer = m_peers[ index ];
+
+    while ( process->canReadLine() )
+    {
+        const QStringList parts = QString::fromUtf8( process->readLine() ).trimmed().split( ' ' );
+        if ( parts.count() < 6 || parts.first() != SYNCBENCHMARK_READY || peer.ready )
+            continue;
+
+        peer.port = parts.at( 1 ).toInt();
+        peer.dbid = parts.at( 2 );
+        peer.ops = parts.at( 3 ).toInt();
+        peer.numFiles = parts.at( 4 ).toInt();
+        peer.lastOp = parts.at( 5 );
+        peer.ready = true;
+
+        tLog() << "Sync benchmark: peer" << index << "ready on port" << peer.port << "after" << m_timer.elapsed() << "ms";
+        if ( ++m_readyPeers == m_peers.count() )
+            connectPeers();
+    }
+}
+
+
+void
+SyncBenchmark::onPeerFinished( int exitCode )
+{
+    if ( m_done )
+        return;
+
+    QProcess* process = qobject_cast< QProcess* >( sender() );
+    tLog() << "Sync benchmark: peer" << process->property( "peer" ).toInt() << "exited early with" << exitCode;
+    m_failed = true;
+    report();
+}
+
+
+void
+SyncBenchmark::connectPeers()
+{
+    m_connectStart = m_timer.elapsed();
+
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        Servent::instance()->connectToPeer( "127.0.0.1", m_peers.at( i ).port, "whitelist",
+                                            QString( "Benchmark Peer %1" ).arg( i ), m_peers.at( i ).dbid );
+    }
+}
+
+
+int
+SyncBenchmark::peerForSource( Source* source ) const
+{
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        if ( m_peers.at( i ).dbid == source->userName() )
+            return i;
+    }
+
+    return -1;
+}
+
+
+void
+SyncBenchmark::onSourceAdded( const Tomahawk::source_ptr& source )
+{
+    if ( source->isLocal() )
+        return;
+
+    connect( source.data(), SIGNAL( stateChanged() ), SLOT( onSourceStateChanged() ) );
+}
+
+
+void
+SyncBenchmark::onSourceStateChanged()
+{
+    Source* source = qobject_cast< Source* >( sender() );
+    const int index = peerForSource( source );
+    if ( index < 0 )
+        return;
+
+    Peer& peer = m_peers[ index ];
+    if ( peer.synced )
+        return;
+
+    // done once the ops that were fetched have been applied
+    if ( source->state() == DBSyncConnection::SAVING )
+    {
+        peer.saving = true;
+        return;
+    }
+    if ( source->state() != DBSyncConnection::SYNCED || !peer.saving )
+        return;
+
+    peer.synced = true;
+    peer.syncTime = m_timer.elapsed() - m_connectStart;
+
+    ControlConnection* cc = source->controlConnection();
+    if ( cc )
+    {
+        peer.bytes = cc->bytesSent() + cc->bytesReceived();
+        if ( cc->dbSyncConnection() )
+            peer.bytes += cc->dbSyncConnection()->bytesSent() + cc->dbSyncConnection()->bytesReceived();
+    }
+
+    tLog() << "Sync benchmark: peer" << index << "synced after" << peer.syncTime << "ms";
+    if ( ++m_syncedPeers == m_peers.count() )
+        verifyNext();
+}
+
+
+void
+SyncBenchmark::verifyNext()
+{
+    // one peer at a time, so every done() belongs to m_peers[ m_verifiedPeers ]
+    if ( m_verifiedPeers == m_peers.count() )
+    {
+        startStreams();
+        return;
+    }
+
+    source_ptr source;
+    foreach ( const source_ptr& src, SourceList::instance()->sources() )
+    {
+        if ( peerForSource( src.data() ) == m_verifiedPeers )
+        {
+            source = src;
+            break;
+        }
+    }
+
+    if ( source.isNull() )
+    {
+        tLog() << "Sync benchmark: lost the source of peer" << m_verifiedPeers;
+        m_failed = true;
+        report();
+        return;
+    }
+
+    DatabaseCommand_CollectionStats* cmd = new DatabaseCommand_CollectionStats( source );
+    connect( cmd, SIGNAL( done( QVariantMap ) ), SLOT( onStatsDone( QVariantMap ) ), Qt::QueuedConnection );
+    Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+}
+
+
+void
+SyncBenchmark::onStatsDone( const QVariantMap& stats )
+{
+    if ( m_done )
+        return;
+
+    const int index = m_verifiedPeers;
+    Peer& peer = m_peers[ index ];
+
+    const int numFiles = stats.value( "numfiles" ).toInt();
+    const QString lastOp = stats.value( "lastop" ).toString();
+    if ( numFiles != m_tracks || numFiles != peer.numFiles || lastOp != peer.lastOp )
+    {
+        tLog() << "Sync benchmark: peer" << index << "synced" << numFiles << "of" << peer.numFiles << "tracks, at op"
+               << lastOp << "instead of" << peer.lastOp;
+        m_failed = true;
+    }
+    else
+        peer.verified = true;
+
+    m_verifiedPeers++;
+    verifyNext();
+}
+
+
+void
+SyncBenchmark::startStreams()
+{
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        const QVariantMap f = ResolveBenchmark::syntheticFile( 0, QString( "Peer %1" ).arg( i ) );
+
+        Peer& peer = m_peers[ i ];
+        peer.query = Query::get( f.value( "artist" ).toString(), f.value( "track" ).toString(), f.value( "album" ).toString(), uuid(), false );
+        peer.query->setProperty( "peer", i );
+        connect( peer.query.data(), SIGNAL( resolvingFinished( bool ) ), SLOT( onResolvingFinished( bool ) ) );
+
+        Pipeline::instance()->resolve( peer.query );
+    }
+}
+
+
+void
+SyncBenchmark::onResolvingFinished( bool hasResults )
+{
+    Query* q = qobject_cast< Query* >( sender() );
+    const int index = q->property( "peer" ).toInt();
+    Peer& peer = m_peers[ index ];
+    if ( !peer.stream.isNull() )
+        return;
+
+    result_ptr result;
+    if ( hasResults )
+    {
+        foreach ( const result_ptr& r, q->results() )
+        {
+            if ( !r->collection().isNull() && peerForSource( r->collection()->source().data() ) == index )
+            {
+                result = r;
+                break;
+            }
+        }
+    }
+
+    if ( !result.isNull() )
+    {
+        peer.streamStart = m_timer.elapsed();
+        peer.stream = Servent::instance()->getIODeviceForUrl( result );
+    }
+
+    if ( peer.stream.isNull() )
+    {
+        tLog() << "Sync benchmark: could not stream from peer" << index;
+        m_failed = true;
+        streamStarted( index );
+        return;
+    }
+
+    peer.stream->setProperty( "peer", index );
+    connect( peer.stream.data(), SIGNAL( readyRead() ), SLOT( onStreamReadyRead() ) );
+    if ( !peer.stream->isOpen() )
+        peer.stream->open( QIODevice::ReadOnly );
+}
+
+
+void
+SyncBenchmark::onStreamReadyRead()
+{
+    QIODevice* stream = qobject_cast< QIODevice* >( sender() );
+    const int index = stream->property( "peer" ).toInt();
+    Peer& peer = m_peers[ index ];
+    if ( peer.firstByte >= 0 )
+        return;
+
+    peer.firstByte = m_timer.elapsed() - peer.streamStart;
+    disconnect( stream, SIGNAL( readyRead() ), this, SLOT( onStreamReadyRead() ) );
+    streamStarted( index );
+}
+
+
+void
+SyncBenchmark::streamStarted( int index )
+{
+    Q_UNUSED( index );
+
+    if ( ++m_streamedPeers == m_peers.count() )
+        report();
+}
+
+
+void
+SyncBenchmark::onTimeout()
+{
+    if ( m_done )
+        return;
+
+    tLog() << "Sync benchmark: giving up, only" << m_readyPeers << "peers ready," << m_syncedPeers << "synced,"
+           << m_streamedPeers << "streamed";
+    m_failed = true;
+    report();
+}
+
+
+void
+SyncBenchmark::report()
+{
+    if ( m_done )
+        return;
+    m_done = true;
+    m_timeout.stop();
+
+    QString out;
+    QTextStream s( &out );
+    s << "Sync benchmark results" << endl
+      << "  peers:  " << m_peers.count() << " x " << m_tracks << " tracks" << endl;
+
+    qint64 slowest = 0, totalBytes = 0;
+    int totalOps = 0;
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        const Peer& peer = m_peers.at( i );
+        s << "  peer " << i << ": ";
+        if ( !peer.synced || !peer.verified )
+        {
+            s << ( peer.synced ? "synced incompletely" : "not synced" ) << endl;
+            m_failed = true;
+            continue;
+        }
+        if ( peer.firstByte < 0 )
+            m_failed = true;
+
+        slowest = qMax( slowest, peer.syncTime );
+        totalBytes += peer.bytes;
+        totalOps += peer.ops;
+
+        s << "sync " << peer.syncTime << " ms, "
+          << peer.ops << " ops (" << ( peer.syncTime > 0 ? peer.ops * 1000.0 / peer.syncTime : 0.0 ) << " ops/s), "
+          << peer.bytes / 1024 << " KB, "
+          << "stream first byte " << peer.firstByte << " ms" << endl;
+    }
+
+    s << "  total:  sync " << slowest << " ms, "
+      << totalOps << " ops (" << ( slowest > 0 ? totalOps * 1000.0 / slowest : 0.0 ) << " ops/s), "
+      << totalBytes / 1024 << " KB on the wire" << endl;
+    if ( m_failed )
+        s << "  FAILED" << endl;
+
+    tLog() << out;
+    QTextStream( stdout ) << out;
+
+    stopPeers();
+    finish( m_failed ? 1 : 0 );
+}
+
+
+void
+SyncBenchmark::stopPeers()
+{
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        QProcess* process = m_peers.at( i ).process;
+        if ( !process || process->state() == QProcess::NotRunning )
+            continue;
+
+        process->disconnect( this );
+        process->terminate();
+        if ( !process->waitForFinished( 5000 ) )
+        {
+            process->kill();
+            process->waitForFinished( 5000 );
+        }
+    }
+
+    // a terminated peer doesn't get to clean up after itself
+    for ( int i = 0; i < m_peers.count(); i++ )
+    {
+        if ( !m_peers.at( i ).instance.isEmpty() )
+            removeDir( instanceDir( m_peers.at( i ).instance ) );
+    }
+}
+
+
+SyncBenchmarkPeer::SyncBenchmarkPeer( int index, int tracks, QObject* parent )
+    : Benchmark( parent )
+    , m_index( index )
+    , m_tracks( qMax( 1, tracks ) )
+    , m_ops( 0 )
+    , m_pendingCommands( 0 )
+{
+}
+
+
+void
+SyncBenchmarkPeer::start()
+{
+    if ( m_ops )
+        return;
+
+    const QString prefix = QString( "Peer %1" ).arg( m_index );
+
+    // the first track is real, so the hub can stream it
+    const QString path = TomahawkUtils::appDataDir().absoluteFilePath( "stream.mp3" );
+    QFile f( path );
+    if ( f.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        QByteArray data( SYNCBENCHMARK_STREAM_SIZE, '\0' );
+        for ( int i = 0; i < data.size(); i++ )
+            data[i] = qrand() % 256;
+
+        f.write( data );
+        f.close();
+    }
+
+    const source_ptr local = SourceList::instance()->getLocal();
+    QVariantList files;
+    for ( int i = 0; i < m_tracks; i++ )
+    {
+        QVariantMap m = ResolveBenchmark::syntheticFile( i, prefix );
+        if ( i == 0 )
+        {
+            m["url"] = "file://" + path;
+            m["size"] = SYNCBENCHMARK_STREAM_SIZE;
+        }
+        files << m;
+
+        if ( files.count() == SYNCBENCHMARK_CHUNK || i == m_tracks - 1 )
+        {
+            DatabaseCommand_AddFiles* cmd = new DatabaseCommand_AddFiles( files, local );
+            connect( cmd, SIGNAL( finished() ), SLOT( onCommandFinished() ), Qt::QueuedConnection );
+            m_pendingCommands++;
+            m_ops++;
+
+            Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+            files.clear();
+        }
+    }
+}
+
+
+void
+SyncBenchmarkPeer::onCommandFinished()
+{
+    if ( --m_pendingCommands > 0 )
+        return;
+
+    // tell the hub what it has to end up with
+    DatabaseCommand_CollectionStats* cmd = new DatabaseCommand_CollectionStats( SourceList::instance()->getLocal() );
+    connect( cmd, SIGNAL( done( QVariantMap ) ), SLOT( onStatsDone( QVariantMap ) ), Qt::QueuedConnection );
+    Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+}
+
+
+void
+SyncBenchmarkPeer::onStatsDone( const QVariantMap& stats )
+{
+    QTextStream out( stdout );
+    out << SYNCBENCHMARK_READY << " " << Servent::instance()->port() << " " << Database::instance()->dbid() << " " << m_ops
+        << " " << stats.value( "numfiles" ).toInt() << " " << stats.value( "lastop" ).toString() << endl;
+}
@@ -0,0 +1,154 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNCBENCHMARK_H
+#define SYNCBENCHMARK_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QIODevice>
+#include <QList>
+#include <QProcess>
+#include <QSharedPointer>
+#include <QTimer>
+
+#include "typedefs.h"
+
+#include "benchmark.h"
+
+namespace Tomahawk
+{
+
+/*
+    Multi-peer sync benchmark, "tomahawk-benchmarks sync". All peers are
+    singletons of their own (Database, Servent, SourceList), so every peer is
+    a separate process of tomahawk-benchmarks started with "sync-peer", each
+    with its own data dir, port and synthetic collection. The hub names the
+    data dirs of its peers and removes them once it stopped the peers.
+
+    This process is the hub: once all peers are ready it connects to them on
+    loopback, which drives ControlConnection and DBSyncConnection, checks
+    that the synced collection of every peer has all its tracks and the
+    peer's last op, and then streams one file from every peer through a
+    StreamConnection. Exits non-zero if any of that fails or times out. Reports
+    sync time, bytes on the wire and ops per second per peer and in total,
+    and the time to the first byte of every stream.
+*/
+class SyncBenchmark : public Benchmark
+{
+Q_OBJECT
+
+public:
+    explicit SyncBenchmark( int peers, int tracks, int port, QObject* parent = 0 );
+    virtual ~SyncBenchmark();
+
+public slots:
+    // call once the database is ready
+    virtual void start();
+
+private slots:
+    void onPeerOutput();
+    void onPeerFinished( int exitCode );
+    void onSourceAdded( const Tomahawk::source_ptr& source );
+    void onSourceStateChanged();
+    void onStatsDone( const QVariantMap& stats );
+    void onResolvingFinished( bool hasResults );
+    void onStreamReadyRead();
+    void onTimeout();
+
+private:
+    struct Peer
+    {
+        Peer() : process( 0 ), port( 0 ), ops( 0 ), numFiles( 0 ), ready( false ), saving( false ), synced( false ),
+                 verified( false ), syncTime( -1 ), bytes( 0 ), streamStart( 0 ), firstByte( -1 ) {}
+
+        QProcess* process;
+        QString instance;
+        int port;
+        QString dbid;
+        int ops;
+        QString lastOp;
+        int numFiles;
+        bool ready;
+        bool saving;
+        bool synced;
+        bool verified;
+        qint64 syncTime;
+        qint64 bytes;
+
+        query_ptr query;
+        QSharedPointer< QIODevice > stream;
+        qint64 streamStart;
+        qint64 firstByte;
+    };
+
+    void connectPeers();
+    void verifyNext();
+    void startStreams();
+    void streamStarted( int index );
+    void report();
+    void stopPeers();
+    int peerForSource( Source* source ) const;
+
+    int m_tracks;
+    int m_port;
+    QList< Peer > m_peers;
+    int m_readyPeers;
+    int m_syncedPeers;
+    int m_verifiedPeers;
+    int m_streamedPeers;
+    bool m_failed;
+    bool m_done;
+
+    QElapsedTimer m_timer;
+    qint64 m_connectStart;
+    QTimer m_timeout;
+};
+
+
+/*
+    One peer of the sync benchmark: adds a synthetic collection through the
+    regular oplog, then tells the hub on stdout where to find it and what
+    the synced collection has to look like.
+*/
+class SyncBenchmarkPeer : public Benchmark
+{
+Q_OBJECT
+
+public:
+    explicit SyncBenchmarkPeer( int index, int tracks, QObject* parent = 0 );
+
+public slots:
+    // never finishes, the hub stops us
+    virtual void start();
+
+private slots:
+    void onCommandFinished();
+    void onStatsDone( const QVariantMap& stats );
+
+private:
+    int m_index;
+    int m_tracks;
+    int m_ops;
+    int m_pendingCommands;
+};
+
+}
+
+#endif // SYNCBENCHMARK_H
@@ -25,12 +25,16 @@
 #include <sip/SipHandler.h>
 #include <network/servent.h>
 #include <sourcelist.h>
+#include <database/database.h>
 
 #include <QTextEdit>
 #include <QDialogButtonBox>
 #include <QPushButton>
 #include <QApplication>
 #include <QClipboard>
+#include <QDir>
+#include <QFileDialog>
+#include <QMessageBox>
 
 #include "utils/logger.h"
 
@@ -43,6 +47,7 @@ DiagnosticsDialog::DiagnosticsDialog( QWidget *parent )
 
     connect( ui->updateButton, SIGNAL( clicked() ), this, SLOT( updateLogView() ) );
     connect( ui->clipboardButton, SIGNAL( clicked() ), this, SLOT( copyToClipboard() ) );
+    connect( ui->dumpProfileButton, SIGNAL( clicked() ), this, SLOT( dumpDatabaseProfile() ) );
     connect( ui->buttonBox, SIGNAL( rejected() ), this, SLOT( reject() ) );
 
     updateLogView();
@@ -167,6 +172,11 @@ void DiagnosticsDialog::updateLogView()
 //         log.append("\n");
 //     }
 
+    // database
+    log.append( "\n\nDATABASE:\n" );
+    if ( Database::instance() )
+        log.append( Database::instance()->profileReport() );
+
     ui->logView->setPlainText(log);
 }
 
@@ -175,3 +185,18 @@ void DiagnosticsDialog::copyToClipboard()
     QApplication::clipboard()->setText( ui->logView->toPlainText() );
 }
 
+void DiagnosticsDialog::dumpDatabaseProfile()
+{
+    if ( !Database::instance() )
+        return;
+
+    const QString filename = QFileDialog::getSaveFileName( this, tr( "Save Database Profile" ),
+                                                           QDir::homePath() + "/tomahawk-dbprofile.txt",
+                                                           tr( "Text files (*.txt)" ) );
+    if ( filename.isEmpty() )
+        return;
+
+    if ( !Database::instance()->dumpProfile( filename ) )
+        QMessageBox::warning( this, tr( "Save Database Profile" ), tr( "Could not write database profile to %1" ).arg( filename ) );
+}
+
@@ -37,6 +37,7 @@ public:
 private slots:
     void updateLogView();
     void copyToClipboard();
+    void dumpDatabaseProfile();
 
 private:
     Ui::DiagnosticsDialog* ui;
@@ -27,14 +27,15 @@
 
 #include "utils/logger.h"
 
+#ifndef ENABLE_HEADLESS
+    #include "utils/covercache.h"
+#endif
+
 using namespace Tomahawk;
 
 
 Album::~Album()
 {
-#ifndef ENABLE_HEADLESS
-    delete m_cover;
-#endif
 }
 
 
@@ -78,17 +79,8 @@ Album::Album( unsigned int id, const QString& name, const Tomahawk::artist_ptr&
     , m_name( name )
     , m_artist( artist )
     , m_infoLoaded( false )
-#ifndef ENABLE_HEADLESS
-    , m_cover( 0 )
-#endif
+    , m_coverGeneration( 0 )
 {
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-    
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( finished( QString ) ),
-             SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -114,11 +106,8 @@ Album::artist() const
 QPixmap
 Album::cover( const QSize& size, bool forceLoad ) const
 {
-    if ( !m_infoLoaded )
+    if ( !m_infoLoaded && forceLoad )
     {
-        if ( !forceLoad )
-            return QPixmap();
-        
         m_uuid = uuid();
 
         Tomahawk::InfoSystem::InfoStringHash trackInfo;
@@ -131,36 +120,33 @@ Album::cover( const QSize& size, bool forceLoad ) const
         requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( trackInfo );
         requestData.customData = QVariantMap();
 
-        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, const_cast< Album* >( this ) );
     }
 
-    if ( !m_cover && !m_coverBuffer.isEmpty() )
-    {
-        m_cover = new QPixmap();
-        m_cover->loadFromData( m_coverBuffer );
-    }
-
-    if ( m_cover && !m_cover->isNull() && !size.isEmpty() )
-    {
-        if ( m_coverCache.contains( size.width() ) )
-        {
-            return m_coverCache.value( size.width() );
-        }
+    // thumbnails of known albums are persistent, they can be shown before the cover bytes got loaded.
+    // The unscaled cover is decoded in the background as well, but never persisted.
+    return CoverCache::instance()->pixmap( coverKey(), m_coverGeneration, m_coverBuffer, size, const_cast< Album* >( this ), m_id > 0 );
+}
 
-        QPixmap scaledCover;
-        scaledCover = m_cover->scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
-        m_coverCache.insert( size.width(), scaledCover );
-        return scaledCover;
-    }
 
-    if ( m_cover )
-        return *m_cover;
-    else
-        return QPixmap();
+bool
+Album::coverPending( const QSize& size ) const
+{
+    return CoverCache::instance()->isPending( coverKey(), m_coverGeneration, size );
 }
 #endif
 
 
+QString
+Album::coverKey() const
+{
+    if ( m_coverKey.isEmpty() )
+        m_coverKey = m_id > 0 ? QString( "album/%1" ).arg( m_id ) : uuid();
+
+    return m_coverKey;
+}
+
+
 void
 Album::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output )
 {
@@ -177,11 +163,22 @@ Album::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVaria
         if ( ba.length() )
         {
             m_coverBuffer = ba;
+            m_coverGeneration++;
+#ifndef ENABLE_HEADLESS
+            CoverCache::instance()->coverChanged( coverKey(), m_coverBuffer );
+#endif
         }
     }
 }
 
 
+void
+Album::coverReady()
+{
+    emit updated();
+}
+
+
 void
 Album::infoSystemFinished( QString target )
 {
@@ -27,14 +27,15 @@
 
 #include "utils/logger.h"
 
+#ifndef ENABLE_HEADLESS
+    #include "utils/covercache.h"
+#endif
+
 using namespace Tomahawk;
 
 
 Artist::~Artist()
 {
-#ifndef ENABLE_HEADLESS
-    delete m_cover;
-#endif
 }
 
 
@@ -77,19 +78,9 @@ Artist::Artist( unsigned int id, const QString& name )
     , m_id( id )
     , m_name( name )
     , m_infoLoaded( false )
-#ifndef ENABLE_HEADLESS
-    , m_cover( 0 )
-#endif
+    , m_coverGeneration( 0 )
 {
     m_sortname = DatabaseImpl::sortname( name, true );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-    
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( finished( QString ) ),
-             SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -107,10 +98,8 @@ Artist::onTracksAdded( const QList<Tomahawk::query_ptr>& tracks )
 QPixmap
 Artist::cover( const QSize& size, bool forceLoad ) const
 {
-    if ( !m_infoLoaded )
+    if ( !m_infoLoaded && forceLoad )
     {
-        if ( !forceLoad )
-            return QPixmap();
         m_uuid = uuid();
 
         Tomahawk::InfoSystem::InfoStringHash trackInfo;
@@ -122,36 +111,33 @@ Artist::cover( const QSize& size, bool forceLoad ) const
         requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( trackInfo );
         requestData.customData = QVariantMap();
 
-        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, const_cast< Artist* >( this ) );
     }
 
-    if ( !m_cover && !m_coverBuffer.isEmpty() )
-    {
-        m_cover = new QPixmap();
-        m_cover->loadFromData( m_coverBuffer );
-    }
+    // thumbnails of known artists are persistent, they can be shown before the cover bytes got loaded.
+    // The unscaled cover is decoded in the background as well, but never persisted.
+    return CoverCache::instance()->pixmap( coverKey(), m_coverGeneration, m_coverBuffer, size, const_cast< Artist* >( this ), m_id > 0 );
+}
 
-    if ( m_cover && !m_cover->isNull() && !size.isEmpty() )
-    {
-        if ( m_coverCache.contains( size.width() ) )
-        {
-            return m_coverCache.value( size.width() );
-        }
 
-        QPixmap scaledCover;
-        scaledCover = m_cover->scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
-        m_coverCache.insert( size.width(), scaledCover );
-        return scaledCover;
-    }
-
-    if ( m_cover )
-        return *m_cover;
-    else
-        return QPixmap();
+bool
+Artist::coverPending( const QSize& size ) const
+{
+    return CoverCache::instance()->isPending( coverKey(), m_coverGeneration, size );
 }
 #endif
 
 
+QString
+Artist::coverKey() const
+{
+    if ( m_coverKey.isEmpty() )
+        m_coverKey = m_id > 0 ? QString( "artist/%1" ).arg( m_id ) : uuid();
+
+    return m_coverKey;
+}
+
+
 void
 Artist::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output )
 {
@@ -168,11 +154,22 @@ Artist::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVari
         if ( ba.length() )
         {
             m_coverBuffer = ba;
+            m_coverGeneration++;
+#ifndef ENABLE_HEADLESS
+            CoverCache::instance()->coverChanged( coverKey(), m_coverBuffer );
+#endif
         }
     }
 }
 
 
+void
+Artist::coverReady()
+{
+    emit updated();
+}
+
+
 void
 Artist::infoSystemFinished( QString target )
 {
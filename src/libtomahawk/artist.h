@@ -51,6 +51,8 @@ public:
     QString sortname() const { return m_sortname; }
 #ifndef ENABLE_HEADLESS
     QPixmap cover( const QSize& size, bool forceLoad = true ) const;
+    // true while the cover for size is being decoded, cover() returns a null pixmap until then
+    bool coverPending( const QSize& size ) const;
 #endif
     bool infoLoaded() const { return m_infoLoaded; }
 
@@ -65,6 +67,7 @@ private slots:
 
     void infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
     void infoSystemFinished( QString target );
+    void coverReady();
 
 private:
     Q_DISABLE_COPY( Artist )
@@ -76,10 +79,10 @@ private:
     bool m_infoLoaded;
     mutable QString m_uuid;
 
-#ifndef ENABLE_HEADLESS
-    mutable QPixmap* m_cover;
-    mutable QHash< int, QPixmap > m_coverCache;
-#endif
+    // identifies the cover in CoverCache, the generation changes with every new cover buffer
+    QString coverKey() const;
+    mutable QString m_coverKey;
+    int m_coverGeneration;
 
     Tomahawk::playlistinterface_ptr m_playlistInterface;
 };
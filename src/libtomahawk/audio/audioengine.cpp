@@ -340,13 +340,17 @@ void
 AudioEngine::sendNowPlayingNotification()
 {
 #ifndef ENABLE_HEADLESS
-    if ( m_currentTrack->album().isNull() || m_currentTrack->album()->infoLoaded() )
-        onNowPlayingInfoReady();
-    else
+    if ( m_currentTrack->album().isNull() )
     {
-        connect( m_currentTrack->album().data(), SIGNAL( updated() ), SLOT( onNowPlayingInfoReady() ), Qt::UniqueConnection );
-        m_currentTrack->album()->cover( QSize( 0, 0 ) );
+        onNowPlayingInfoReady();
+        return;
     }
+
+    // the album emits updated() once its info got loaded and again once the cover got decoded
+    connect( m_currentTrack->album().data(), SIGNAL( updated() ), SLOT( onNowPlayingInfoReady() ), Qt::UniqueConnection );
+    m_currentTrack->album()->cover( QSize( 0, 0 ) );
+    if ( m_currentTrack->album()->infoLoaded() && !m_currentTrack->album()->coverPending( QSize( 0, 0 ) ) )
+        onNowPlayingInfoReady();
 #endif
 }
 
@@ -362,6 +366,18 @@ AudioEngine::onNowPlayingInfoReady()
     if ( !m_currentTrack->album().isNull() && sender() && m_currentTrack->album().data() != sender() )
         return;
 
+#ifndef ENABLE_HEADLESS
+    if ( !m_currentTrack->album().isNull() )
+    {
+        // wait for the full size cover, its decoding finishes with another updated()
+        m_currentTrack->album()->cover( QSize( 0, 0 ), false );
+        if ( !m_currentTrack->album()->infoLoaded() || m_currentTrack->album()->coverPending( QSize( 0, 0 ) ) )
+            return;
+
+        disconnect( m_currentTrack->album().data(), SIGNAL( updated() ), this, SLOT( onNowPlayingInfoReady() ) );
+    }
+#endif
+
     QVariantMap playInfo;
     playInfo["message"] = tr( "Tomahawk is playing \"%1\" by %2%3." )
                         .arg( m_currentTrack->track() )
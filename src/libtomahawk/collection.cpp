@@ -83,6 +83,9 @@ Collection::addPlaylist( const Tomahawk::playlist_ptr& p )
 void
 Collection::addAutoPlaylist( const Tomahawk::dynplaylist_ptr& p )
 {
+    if ( m_autoplaylists.contains( p->guid() ) )
+        return;
+
     QList<dynplaylist_ptr> toadd;
     toadd << p;
     m_autoplaylists.insert( p->guid(), p );
@@ -97,6 +100,9 @@ Collection::addAutoPlaylist( const Tomahawk::dynplaylist_ptr& p )
 void
 Collection::addStation( const dynplaylist_ptr& s )
 {
+    if ( m_stations.contains( s->guid() ) )
+        return;
+
     QList<dynplaylist_ptr> toadd;
     toadd << s;
     m_stations.insert( s->guid(), s );
@@ -174,14 +180,22 @@ Collection::station( const QString& guid )
 void
 Collection::setPlaylists( const QList<Tomahawk::playlist_ptr>& plists )
 {
+    // playlists synced in before the list got loaded are known already, keep those objects
+    QList<playlist_ptr> toadd;
     foreach ( const playlist_ptr& p, plists )
     {
+        if ( m_playlists.contains( p->guid() ) )
+            continue;
+
 //        qDebug() << "Batch inserting playlist:" << p->guid();
         m_playlists.insert( p->guid(), p );
+        toadd << p;
         if ( !m_source.isNull() && m_source->isLocal() )
             PlaylistUpdaterInterface::loadForPlaylist( p );
     }
-    emit playlistsAdded( plists );
+
+    if ( !toadd.isEmpty() )
+        emit playlistsAdded( toadd );
 }
 
 
@@ -45,12 +45,6 @@ RelatedArtistsContext::RelatedArtistsContext()
 
     m_proxy = new QGraphicsProxyWidget();
     m_proxy->setWidget( m_relatedView );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(), SIGNAL( finished( QString ) ), SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -78,7 +72,7 @@ RelatedArtistsContext::setArtist( const Tomahawk::artist_ptr& artist )
     requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( artistInfo );
 
     requestData.type = Tomahawk::InfoSystem::InfoArtistSimilars;
-    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
 }
 
 
@@ -44,12 +44,6 @@ TopTracksContext::TopTracksContext()
 
     m_proxy = new QGraphicsProxyWidget();
     m_proxy->setWidget( m_topHitsView );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(), SIGNAL( finished( QString ) ), SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -77,7 +71,7 @@ TopTracksContext::setArtist( const Tomahawk::artist_ptr& artist )
     requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( artistInfo );
 
     requestData.type = Tomahawk::InfoSystem::InfoArtistSongs;
-    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
 }
 
 
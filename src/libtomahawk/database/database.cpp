@@ -19,6 +19,10 @@
 
 #include "database.h"
 
+#include <QDateTime>
+#include <QFile>
+#include <QTextStream>
+
 #include "databasecommand.h"
 #include "databaseimpl.h"
 #include "databaseworker.h"
@@ -41,9 +45,41 @@ Database::Database( const QString& dbname, QObject* parent )
     : QObject( parent )
     , m_ready( false )
     , m_impl( new DatabaseImpl( dbname, this ) )
-    , m_workerRW( new DatabaseWorker( m_impl, this, true ) )
+    , m_workerRW( 0 )
+{
+    init();
+}
+
+
+Database::Database( DatabaseImpl* impl, QObject* parent )
+    : QObject( parent )
+    , m_ready( false )
+    , m_impl( impl )
+    , m_workerRW( 0 )
+{
+    Q_ASSERT( m_impl->thread() == thread() );
+    m_impl->setParent( this );
+
+    init();
+}
+
+
+DatabaseImpl*
+Database::open( const QString& dbname )
+{
+    DatabaseImpl* impl = new DatabaseImpl( dbname );
+    impl->moveToMainThread();
+
+    return impl;
+}
+
+
+void
+Database::init()
 {
     s_instance = this;
+    m_indexReady = false;
+    m_workerRW = new DatabaseWorker( m_impl, this, true );
 
     m_maxConcurrentThreads = qBound( DEFAULT_WORKER_THREADS, QThread::idealThreadCount(), MAX_WORKER_THREADS );
     qDebug() << Q_FUNC_INFO << "Using" << m_maxConcurrentThreads << "threads";
@@ -130,3 +166,51 @@ Database::dbid() const
 {
     return m_impl->dbid();
 }
+
+
+void
+Database::setSourceOnline( int srcid, bool online )
+{
+    m_impl->setSourceOnline( srcid, online );
+}
+
+
+int
+Database::queueDepth( DatabaseCommand::Priority priority ) const
+{
+    return m_workerRW->queueDepth( priority );
+}
+
+
+QString
+Database::profileReport() const
+{
+    QString report = QString( "RW queue depth: interactive %1, normal %2, bulk %3\n\n" )
+                        .arg( queueDepth( DatabaseCommand::InteractivePriority ) )
+                        .arg( queueDepth( DatabaseCommand::NormalPriority ) )
+                        .arg( queueDepth( DatabaseCommand::BulkPriority ) );
+    report.append( m_workerRW->profiler().report() );
+
+    for ( int i = 0; i < m_workers.count(); i++ )
+        report.append( m_workers.at( i )->profiler().report() );
+
+    return report;
+}
+
+
+bool
+Database::dumpProfile( const QString& filename ) const
+{
+    QFile f( filename );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text ) )
+    {
+        tLog() << "Could not write database profile to" << filename << f.errorString();
+        return false;
+    }
+
+    QTextStream stream( &f );
+    stream << "TOMAHAWK DATABASE PROFILE - " << QDateTime::currentDateTime().toString() << "\n\n";
+    stream << profileReport();
+
+    return true;
+}
@@ -50,8 +50,14 @@ public:
     static Database* instance();
 
     explicit Database( const QString& dbname, QObject* parent = 0 );
+    // takes over a database opened with open()
+    explicit Database( DatabaseImpl* impl, QObject* parent = 0 );
     ~Database();
 
+    // opens the file and updates its schema, the slow part of creating a Database.
+    // safe to run on any thread, so start-up can do other things meanwhile.
+    static DatabaseImpl* open( const QString& dbname );
+
     QString dbid() const;
     bool indexReady() const { return m_indexReady; }
 
@@ -59,6 +65,16 @@ public:
 
     bool isReady() const { return m_ready; }
 
+    // called by Source, resolving skips files of offline sources right in the SQL
+    void setSourceOnline( int srcid, bool online );
+
+    // mutating commands waiting for the writer in the given lane
+    int queueDepth( DatabaseCommand::Priority priority ) const;
+
+    // per-command timing statistics of all workers, for diagnostics
+    QString profileReport() const;
+    bool dumpProfile( const QString& filename ) const;
+
 signals:
     void indexReady(); // search index
     void ready();
@@ -74,6 +90,8 @@ private slots:
     void setIsReadyTrue() { m_ready = true; }
 
 private:
+    void init();
+
     DatabaseImpl* impl() const { return m_impl; }
 
     bool m_ready;
@@ -33,6 +33,9 @@ using namespace Tomahawk;
 
 DatabaseCollection::DatabaseCollection( const source_ptr& src, QObject* parent )
     : Collection( src, QString( "dbcollection:%1" ).arg( src->userName() ), parent )
+    , m_playlistsLoaded( false )
+    , m_autoPlaylistsLoaded( false )
+    , m_stationsLoaded( false )
 {
 }
 
@@ -96,8 +99,9 @@ DatabaseCollection::removeTracks( const QDir& dir )
 QList< Tomahawk::playlist_ptr >
 DatabaseCollection::playlists()
 {
-    if ( Collection::playlists().isEmpty() )
+    if ( !m_playlistsLoaded )
     {
+        m_playlistsLoaded = true;
         loadPlaylists();
     }
 
@@ -108,8 +112,9 @@ DatabaseCollection::playlists()
 QList< dynplaylist_ptr >
 DatabaseCollection::autoPlaylists()
 {
-    if ( Collection::autoPlaylists().isEmpty() )
+    if ( !m_autoPlaylistsLoaded )
     {
+        m_autoPlaylistsLoaded = true;
         loadAutoPlaylists();
     }
 
@@ -120,8 +125,9 @@ DatabaseCollection::autoPlaylists()
 QList< dynplaylist_ptr >
 DatabaseCollection::stations()
 {
-    if ( Collection::stations().isEmpty() )
+    if ( !m_stationsLoaded )
     {
+        m_stationsLoaded = true;
         loadStations();
     }
 
@@ -129,6 +135,40 @@ DatabaseCollection::stations()
 }
 
 
+playlist_ptr
+DatabaseCollection::playlist( const QString& guid )
+{
+    // a miss on a list we never loaded starts loading it, playlistsAdded tells the caller when to look again
+    playlist_ptr p = Collection::playlist( guid );
+    if ( p.isNull() && !m_playlistsLoaded )
+        playlists();
+
+    return p;
+}
+
+
+dynplaylist_ptr
+DatabaseCollection::autoPlaylist( const QString& guid )
+{
+    dynplaylist_ptr p = Collection::autoPlaylist( guid );
+    if ( p.isNull() && !m_autoPlaylistsLoaded )
+        autoPlaylists();
+
+    return p;
+}
+
+
+dynplaylist_ptr
+DatabaseCollection::station( const QString& guid )
+{
+    dynplaylist_ptr p = Collection::station( guid );
+    if ( p.isNull() && !m_stationsLoaded )
+        stations();
+
+    return p;
+}
+
+
 void
 DatabaseCollection::autoPlaylistCreated( const source_ptr& source, const QVariantList& data )
 {
@@ -42,6 +42,10 @@ public:
     virtual void loadAutoPlaylists();
     virtual void loadStations();
 
+    virtual Tomahawk::playlist_ptr playlist( const QString& guid );
+    virtual Tomahawk::dynplaylist_ptr autoPlaylist( const QString& guid );
+    virtual Tomahawk::dynplaylist_ptr station( const QString& guid );
+
     virtual QList< Tomahawk::playlist_ptr > playlists();
     virtual QList< Tomahawk::dynplaylist_ptr > autoPlaylists();
     virtual QList< Tomahawk::dynplaylist_ptr > stations();
@@ -53,6 +57,12 @@ public slots:
 private slots:
     void stationCreated( const Tomahawk::source_ptr& source, const QVariantList& data );
     void autoPlaylistCreated( const Tomahawk::source_ptr& source, const QVariantList& data );
+
+private:
+    // every list gets loaded from the database once, on first use
+    bool m_playlistsLoaded;
+    bool m_autoPlaylistsLoaded;
+    bool m_stationsLoaded;
 };
 
 #endif // DATABASECOLLECTION_H
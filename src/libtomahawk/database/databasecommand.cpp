@@ -38,22 +38,28 @@
 DatabaseCommand::DatabaseCommand( QObject* parent )
     : QObject( parent )
     , m_state( PENDING )
+    , m_priority( NormalPriority )
 {
     //qDebug() << Q_FUNC_INFO;
+    m_queued.invalidate();
 }
 
 
 DatabaseCommand::DatabaseCommand( const source_ptr& src, QObject* parent )
     : QObject( parent )
     , m_state( PENDING )
+    , m_priority( NormalPriority )
     , m_source( src )
 {
     //qDebug() << Q_FUNC_INFO;
+    m_queued.invalidate();
 }
 
 DatabaseCommand::DatabaseCommand( const DatabaseCommand& other )
     : QObject( other.parent() )
+    , m_priority( other.priority() )
 {
+    m_queued.invalidate();
 }
 
 DatabaseCommand::~DatabaseCommand()
@@ -23,6 +23,7 @@
 #include <QObject>
 #include <QMetaType>
 #include <QTime>
+#include <QElapsedTimer>
 #include <QSqlQuery>
 #include <QVariant>
 
@@ -45,6 +46,14 @@ public:
         FINISHED = 2
     };
 
+    // lanes of the read-write worker, lower values run first
+    enum Priority {
+        InteractivePriority = 0, // things the user just did and waits for
+        NormalPriority = 1,
+        BulkPriority = 2,        // scanning and syncing with peers
+        PriorityCount = 3
+    };
+
     explicit DatabaseCommand( QObject* parent = 0 );
     explicit DatabaseCommand( const Tomahawk::source_ptr& src, QObject* parent = 0 );
 
@@ -75,6 +84,9 @@ public:
     virtual bool singletonCmd() const { return false; }
     virtual bool localOnly() const { return false; }
 
+    Priority priority() const { return m_priority; }
+    void setPriority( Priority priority ) { m_priority = priority; }
+
     virtual QVariant data() const { return m_data; }
     virtual void setData( const QVariant& data ) { m_data = data; }
 
@@ -89,6 +101,10 @@ public:
 
     void emitFinished() { emit finished(); }
 
+    // used by DatabaseWorker to profile how long we waited in its queue
+    void setQueued() { m_queued.start(); }
+    qint64 queuedFor() const { return m_queued.isValid() ? m_queued.elapsed() : 0; }
+
     static DatabaseCommand* factory( const QVariant& op, const Tomahawk::source_ptr& source );
 
 signals:
@@ -98,8 +114,10 @@ signals:
 
 private:
     State m_state;
+    Priority m_priority;
     Tomahawk::source_ptr m_source;
     mutable QString m_guid;
+    QElapsedTimer m_queued;
 
     QVariant m_data;
 };
@@ -64,11 +64,53 @@ DatabaseCommand_AddFiles::postCommitHook()
 
     emit notify( m_ids );
 
+    // only now the files are there for real
+    Database::instance()->impl()->collectionStatsFilesAdded( source()->isLocal() ? 0 : source()->id(), m_statsFiles,
+                                                             m_statsArtists, m_statsAlbums, m_statsDuration, m_statsLastModified );
+
     if ( source()->isLocal() )
         Servent::instance()->triggerDBSync();
 }
 
 
+void
+DatabaseCommand_AddFiles::resetStats()
+{
+    m_statsFiles = 0;
+    m_statsArtists = 0;
+    m_statsAlbums = 0;
+    m_statsDuration = 0;
+    m_statsLastModified = 0;
+}
+
+
+void
+DatabaseCommand_AddFiles::prepareOp( DatabaseImpl* lib )
+{
+    reserveIds( lib );
+}
+
+
+void
+DatabaseCommand_AddFiles::reserveIds( DatabaseImpl* lib )
+{
+    if ( m_idsReserved )
+        return;
+
+    m_idsReserved = true;
+    int fileid = lib->reserveFileIds( m_files.count() );
+
+    QList<QVariant>::iterator it;
+    for ( it = m_files.begin(); it != m_files.end(); ++it )
+    {
+        // this is the qvariant(map) the remote will get, files from peers carry their own ids in it
+        QVariantMap m = it->toMap();
+        m.insert( "id", fileid++ );
+        *it = m;
+    }
+}
+
+
 void
 DatabaseCommand_AddFiles::exec( DatabaseImpl* dbi )
 {
@@ -79,21 +121,34 @@ DatabaseCommand_AddFiles::exec( DatabaseImpl* dbi )
     TomahawkSqlQuery query_filejoin = dbi->newquery();
     TomahawkSqlQuery query_trackattr = dbi->newquery();
 
-    query_file.prepare( "INSERT INTO file(source, url, size, mtime, md5, mimetype, duration, bitrate) VALUES (?, ?, ?, ?, ?, ?, ?, ?)" );
+    query_file.prepare( "INSERT INTO file(id, source, url, size, mtime, md5, mimetype, duration, bitrate) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)" );
     query_filejoin.prepare( "INSERT INTO file_join(file, artist, album, track, albumpos, composer, discnumber) VALUES (?, ?, ?, ?, ?, ?, ?)" );
     query_trackattr.prepare( "INSERT INTO track_attributes(id, k, v) VALUES (?, ?, ?)" );
 
+    // remembered results for these tracks may be beaten by the new files now, so they get resolved again
+    TomahawkSqlQuery query_resolvecache = dbi->newquery();
+    query_resolvecache.prepare( "DELETE FROM resolve_cache WHERE artist = ? AND track = ? AND album IN ( ?, '' )" );
+
     int added = 0;
     QVariant srcid = source()->isLocal() ? QVariant( QVariant::Int ) : source()->id();
     qDebug() << "Adding" << m_files.length() << "files to db for source" << srcid;
 
+    // count what we add for the collection_stats counters, they get updated after the commit
+    const int statsSource = source()->isLocal() ? 0 : source()->id();
+    dbi->ensureCollectionStats( statsSource );
+    resetStats();
+    QSet< int > statsArtists, statsAlbums;
+
+    // ids of local files are reserved already when the op got serialised
+    reserveIds( dbi );
+
     QList<QVariant>::iterator it;
     for ( it = m_files.begin(); it != m_files.end(); ++it )
     {
         QVariant& v = *it;
         QVariantMap m = v.toMap();
 
-        int fileid = 0, artistid = 0, albumid = 0, trackid = 0, composerid = 0;
+        int fileid = m.value( "id" ).toInt(), artistid = 0, albumid = 0, trackid = 0, composerid = 0;
 
         QString url      = m.value( "url" ).toString();
         int mtime        = m.value( "mtime" ).toInt();
@@ -110,25 +165,29 @@ DatabaseCommand_AddFiles::exec( DatabaseImpl* dbi )
         uint discnumber  = m.value( "discnumber" ).toUInt();
         int year         = m.value( "year" ).toInt();
 
-        query_file.bindValue( 0, srcid );
-        query_file.bindValue( 1, url );
-        query_file.bindValue( 2, size );
-        query_file.bindValue( 3, mtime );
-        query_file.bindValue( 4, hash );
-        query_file.bindValue( 5, mimetype );
-        query_file.bindValue( 6, duration );
-        query_file.bindValue( 7, bitrate );
-        query_file.exec();
+        query_file.bindValue( 0, fileid );
+        query_file.bindValue( 1, srcid );
+        query_file.bindValue( 2, url );
+        query_file.bindValue( 3, size );
+        query_file.bindValue( 4, mtime );
+        query_file.bindValue( 5, hash );
+        query_file.bindValue( 6, mimetype );
+        query_file.bindValue( 7, duration );
+        query_file.bindValue( 8, bitrate );
+        if ( !query_file.exec() )
+        {
+            qDebug() << "Error inserting into file table";
+            continue;
+        }
+
+        m_statsFiles++;
+        m_statsDuration += duration;
+        m_statsLastModified = qMax( m_statsLastModified, mtime );
 
         if ( added % 1000 == 0 )
             qDebug() << "Inserted" << added;
 
         // get internal IDs for art/alb/trk
-        fileid = query_file.lastInsertId().toInt();
-        m.insert( "id", fileid );
-        // this is the qvariant(map) the remote will get
-        v = m;
-
         artistid = dbi->artistId( artist, true );
         if ( artistid < 1 )
             continue;
@@ -154,6 +213,15 @@ DatabaseCommand_AddFiles::exec( DatabaseImpl* dbi )
             continue;
         }
 
+        statsArtists << artistid;
+        if ( albumid > 0 )
+            statsAlbums << albumid;
+
+        query_resolvecache.bindValue( 0, DatabaseImpl::sortname( artist, true ) );
+        query_resolvecache.bindValue( 1, DatabaseImpl::sortname( track ) );
+        query_resolvecache.bindValue( 2, DatabaseImpl::sortname( album ) );
+        query_resolvecache.exec();
+
         query_trackattr.bindValue( 0, trackid );
         query_trackattr.bindValue( 1, "releaseyear" );
         query_trackattr.bindValue( 2, year );
@@ -164,6 +232,12 @@ DatabaseCommand_AddFiles::exec( DatabaseImpl* dbi )
     }
     qDebug() << "Inserted" << added << "tracks to database";
 
+    // an artist / album is new to the source unless it has files of it besides the ones we just added
+    int knownArtists = 0, knownAlbums = 0;
+    dbi->countCollectionStatsReferences( statsSource, statsArtists, statsAlbums, m_ids, &knownArtists, &knownAlbums );
+    m_statsArtists = statsArtists.count() - knownArtists;
+    m_statsAlbums = statsAlbums.count() - knownAlbums;
+
     if ( added )
         source()->updateIndexWhenSynced();
 
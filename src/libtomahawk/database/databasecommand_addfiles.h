@@ -35,13 +35,17 @@ Q_PROPERTY( QVariantList files READ files WRITE setFiles )
 
 public:
     explicit DatabaseCommand_AddFiles( QObject* parent = 0 )
-        : DatabaseCommandLoggable( parent )
-    {}
+        : DatabaseCommandLoggable( parent ), m_idsReserved( false )
+    {
+        resetStats();
+    }
 
     explicit DatabaseCommand_AddFiles( const QList<QVariant>& files, const Tomahawk::source_ptr& source, QObject* parent = 0 )
-        : DatabaseCommandLoggable( parent ), m_files( files )
+        : DatabaseCommandLoggable( parent ), m_files( files ), m_idsReserved( false )
     {
+        resetStats();
         setSource( source );
+        setPriority( BulkPriority );
     }
 
     virtual QString commandname() const { return "addfiles"; }
@@ -49,6 +53,7 @@ public:
     virtual void exec( DatabaseImpl* );
     virtual bool doesMutates() const { return true; }
     virtual void postCommitHook();
+    virtual void prepareOp( DatabaseImpl* lib );
 
     QVariantList files() const;
     void setFiles( const QVariantList& f ) { m_files = f; }
@@ -58,8 +63,20 @@ signals:
     void notify( const QList<unsigned int>& ids );
 
 private:
+    void reserveIds( DatabaseImpl* lib );
+    void resetStats();
+
     QVariantList m_files;
+    // the files got their row ids, they are part of the op
+    bool m_idsReserved;
     QList<unsigned int> m_ids;
+
+    // collection_stats changes counted by exec(), applied after the commit
+    int m_statsFiles;
+    int m_statsArtists;
+    int m_statsAlbums;
+    qint64 m_statsDuration;
+    int m_statsLastModified;
 };
 
 #endif // DATABASECOMMAND_ADDFILES_H
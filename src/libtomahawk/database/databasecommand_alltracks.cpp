@@ -33,8 +33,17 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
 {
     TomahawkSqlQuery query = dbi->newquery();
     QList<Tomahawk::query_ptr> ql;
+    QList<TrackStore::Record> fileRecords;
+    QList< QPair< Tomahawk::query_ptr, Tomahawk::result_ptr > > queries;
+    QMultiHash< unsigned int, Tomahawk::result_ptr > trackResults;
+
+    // album, disc and position can be missing, NULLs would never compare equal to the key
+    const QStringList artistKey = QStringList() << "artist.sortname" << "COALESCE( album.sortname, '' )"
+                                                << "COALESCE( file_join.discnumber, 0 )" << "COALESCE( file_join.albumpos, 0 )"
+                                                << "file.id";
 
     QString m_orderToken, sourceToken;
+    QStringList orderColumns;
     switch ( m_sortOrder )
     {
         case 0:
@@ -51,11 +60,36 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
         case AlbumPosition:
             m_orderToken = "file_join.discnumber, file_join.albumpos";
             break;
+
+        case Artist:
+            // a total order, so a page can start right after the last track of the previous one
+            foreach ( const QString& column, artistKey )
+                orderColumns << column + ( m_sortDescending ? " DESC" : "" );
+            m_orderToken = orderColumns.join( ", " );
+            break;
     }
 
     if ( !m_collection.isNull() )
         sourceToken = QString( "AND file.source %1" ).arg( m_collection->source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( m_collection->source()->id() ) );
 
+    // the values of the placeholders, in the order they appear in the statement
+    QVariantList bindValues;
+
+    QString filterToken;
+    if ( !m_filter.isEmpty() )
+    {
+        QStringList sl = m_filter.split( " ", QString::SkipEmptyParts );
+        foreach( QString s, sl )
+        {
+            // the words are matched literally, not as patterns
+            s.replace( '\\', "\\\\" ).replace( '%', "\\%" ).replace( '_', "\\_" );
+            const QString pattern = '%' + s + '%';
+
+            filterToken += " AND ( artist.name LIKE ? ESCAPE '\\' OR album.name LIKE ? ESCAPE '\\' OR track.name LIKE ? ESCAPE '\\' )";
+            bindValues << pattern << pattern << pattern;
+        }
+    }
+
     QString albumToken;
     if ( m_album )
     {
@@ -68,11 +102,30 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
             albumToken = QString( "AND album.id = %1" ).arg( m_album->id() );
     }
 
+    // expands to ( a > ? OR ( a = ? AND ( b > ? OR ... ) ) ), row values need a newer SQLite
+    QString startAfterToken;
+    if ( m_startAfter && m_sortOrder == Artist )
+    {
+        const QString op = m_sortDescending ? "<" : ">";
+        const QVariantList key = QVariantList() << m_startAfterRecord.artistSortname << m_startAfterRecord.albumSortname
+                                                << m_startAfterRecord.discnumber << m_startAfterRecord.albumpos;
+
+        startAfterToken = QString( "file.id %1 ?" ).arg( op );
+        for ( int i = key.count() - 1; i >= 0; i-- )
+            startAfterToken = QString( "%1 %2 ? OR ( %1 = ? AND ( %3 ) )" ).arg( artistKey.at( i ) ).arg( op ).arg( startAfterToken );
+        startAfterToken = QString( "AND ( %1 )" ).arg( startAfterToken );
+
+        foreach ( const QVariant& value, key )
+            bindValues << value << value;
+        bindValues << m_startAfterRecord.fileId;
+    }
+
     QString sql = QString(
             "SELECT file.id, artist.name, album.name, track.name, composer.name, file.size, "   //0
                    "file.duration, file.bitrate, file.url, file.source, file.mtime, "           //6
                    "file.mimetype, file_join.discnumber, file_join.albumpos, artist.id, "       //11
-                   "album.id, track.id, composer.id "                                           //15
+                   "album.id, track.id, composer.id, artist.sortname, "                         //15
+                   "COALESCE( album.sortname, '' ) "                                            //19
             "FROM file, artist, track, file_join "
             "LEFT OUTER JOIN album "
             "ON file_join.album = album.id "
@@ -81,17 +134,21 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
             "WHERE file.id = file_join.file "
             "AND file_join.artist = artist.id "
             "AND file_join.track = track.id "
-            "%1 "
-            "%2 %3 "
-            "%4 %5 %6"
+            "%1 %2 "
+            "%3 %4 %5 "
+            "%6 %7 %8"
             ).arg( sourceToken )
+             .arg( filterToken )
              .arg( !m_artist ? QString() : QString( "AND artist.id = %1" ).arg( m_artist->id() ) )
              .arg( !m_album ? QString() : albumToken )
+             .arg( startAfterToken )
              .arg( m_sortOrder > 0 ? QString( "ORDER BY %1" ).arg( m_orderToken ) : QString() )
-             .arg( m_sortDescending ? "DESC" : QString() )
-             .arg( m_amount > 0 ? QString( "LIMIT 0, %1" ).arg( m_amount ) : QString() );
+             .arg( m_sortDescending && m_sortOrder != Artist ? "DESC" : QString() )
+             .arg( m_amount > 0 ? QString( "LIMIT %1" ).arg( m_amount ) : QString() );
 
     query.prepare( sql );
+    foreach ( const QVariant& value, bindValues )
+        query.addBindValue( value );
     query.exec();
 
     while( query.next() )
@@ -112,7 +169,36 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
                 continue;
             }
 
-            url = QString( "servent://%1\t%2" ).arg( s->userName() ).arg( url );
+            if ( !m_emitRecords )
+                url = QString( "servent://%1\t%2" ).arg( s->userName() ).arg( url );
+        }
+
+        if ( m_emitRecords )
+        {
+            TrackStore::Record record;
+            record.fileId = query.value( 0 ).toUInt();
+            record.sourceId = query.value( 9 ).toUInt();
+            record.url = url;
+            record.mimetype = query.value( 11 ).toString();
+            record.artist = query.value( 1 ).toString();
+            record.artistSortname = query.value( 18 ).toString();
+            record.album = query.value( 2 ).toString();
+            record.albumSortname = query.value( 19 ).toString();
+            record.track = query.value( 3 ).toString();
+            record.composer = query.value( 4 ).toString();
+            record.artistId = query.value( 14 ).toUInt();
+            record.albumId = query.value( 15 ).toUInt();
+            record.composerId = query.value( 17 ).toUInt();
+            record.trackId = query.value( 16 ).toUInt();
+            record.albumpos = query.value( 13 ).toUInt();
+            record.discnumber = query.value( 12 ).toUInt();
+            record.duration = query.value( 6 ).toUInt();
+            record.bitrate = query.value( 7 ).toUInt();
+            record.mtime = query.value( 10 ).toUInt();
+            record.size = query.value( 5 ).toUInt();
+
+            fileRecords << record;
+            continue;
         }
 
         QString artist, track, album, composer;
@@ -142,27 +228,72 @@ DatabaseCommand_AllTracks::exec( DatabaseImpl* dbi )
         result->setScore( 1.0 );
         result->setCollection( s->collection() );
 
+        trackResults.insert( result->trackId(), result );
+
+        queries << QPair< Tomahawk::query_ptr, Tomahawk::result_ptr >( qry, result );
+    }
+
+    // fetch the attributes of all tracks in one go, instead of one query per track
+    if ( !fileRecords.isEmpty() )
+    {
+        // records only carry the release year
+        QHash< unsigned int, int > years;
+        foreach ( const TrackStore::Record& record, fileRecords )
+            years.insert( record.trackId, 0 );
+
+        QStringList trackIds;
+        foreach ( unsigned int id, years.keys() )
+            trackIds << QString::number( id );
+
         TomahawkSqlQuery attrQuery = dbi->newquery();
-        QVariantMap attr;
+        attrQuery.exec( QString( "SELECT id, v FROM track_attributes WHERE k = 'releaseyear' AND id IN ( %1 )" ).arg( trackIds.join( ", " ) ) );
+        while ( attrQuery.next() )
+        {
+            years[ attrQuery.value( 0 ).toUInt() ] = attrQuery.value( 1 ).toInt();
+        }
+
+        for ( int i = 0; i < fileRecords.count(); i++ )
+            fileRecords[i].year = years.value( fileRecords.at( i ).trackId );
+    }
 
-        attrQuery.prepare( "SELECT k, v FROM track_attributes WHERE id = ?" );
-        attrQuery.bindValue( 0, result->trackId() );
-        attrQuery.exec();
+    if ( !trackResults.isEmpty() )
+    {
+        QStringList trackIds;
+        foreach ( unsigned int id, trackResults.uniqueKeys() )
+            trackIds << QString::number( id );
+
+        QHash< unsigned int, QVariantMap > attributes;
+        TomahawkSqlQuery attrQuery = dbi->newquery();
+        attrQuery.exec( QString( "SELECT id, k, v FROM track_attributes WHERE id IN ( %1 )" ).arg( trackIds.join( ", " ) ) );
         while ( attrQuery.next() )
         {
-            attr[ attrQuery.value( 0 ).toString() ] = attrQuery.value( 1 ).toString();
+            attributes[ attrQuery.value( 0 ).toUInt() ][ attrQuery.value( 1 ).toString() ] = attrQuery.value( 2 ).toString();
         }
 
-        result->setAttributes( attr );
+        foreach ( const Tomahawk::result_ptr& result, trackResults )
+            result->setAttributes( attributes.value( result->trackId() ) );
+    }
+
+    for ( int i = 0; i < queries.count(); i++ )
+    {
+        const Tomahawk::query_ptr& qry = queries.at( i ).first;
 
         QList<Tomahawk::result_ptr> results;
-        results << result;
+        results << queries.at( i ).second;
         qry->addResults( results );
         qry->setResolveFinished( true );
 
         ql << qry;
     }
 
+    if ( m_emitRecords )
+    {
+        qDebug() << Q_FUNC_INFO << fileRecords.length();
+        emit records( fileRecords, data() );
+        emit done( m_collection );
+        return;
+    }
+
     qDebug() << Q_FUNC_INFO << ql.length();
 
     emit tracks( ql, data() );
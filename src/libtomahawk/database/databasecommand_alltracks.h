@@ -28,6 +28,7 @@
 #include "query.h"
 #include "artist.h"
 #include "album.h"
+#include "playlist/trackstore.h"
 
 #include "dllmacro.h"
 
@@ -39,7 +40,8 @@ public:
         None = 0,
         Album = 1,
         ModificationTime = 2,
-        AlbumPosition = 3
+        AlbumPosition = 3,
+        Artist = 4
     };
 
     explicit DatabaseCommand_AllTracks( const Tomahawk::collection_ptr& collection = Tomahawk::collection_ptr(), QObject* parent = 0 )
@@ -48,8 +50,10 @@ public:
         , m_artist( 0 )
         , m_album( 0 )
         , m_amount( 0 )
+        , m_startAfter( false )
         , m_sortOrder( DatabaseCommand_AllTracks::None )
         , m_sortDescending( false )
+        , m_emitRecords( false )
     {}
 
     virtual void exec( DatabaseImpl* );
@@ -61,11 +65,19 @@ public:
     void setAlbum( const Tomahawk::album_ptr& album ) { m_album = album; }
 
     void setLimit( unsigned int amount ) { m_amount = amount; }
+    // only the tracks after record in the Artist sort order, to fetch a collection page by page.
+    // unlike an offset this neither skips nor repeats tracks when files get added or removed in between
+    void setStartAfter( const TrackStore::Record& record ) { m_startAfter = true; m_startAfterRecord = record; }
     void setSortOrder( DatabaseCommand_AllTracks::SortOrder order ) { m_sortOrder = order; }
     void setSortDescending( bool descending ) { m_sortDescending = descending; }
+    // emit records() instead of tracks(), without creating a Query and Result per file
+    void setEmitRecords( bool emitRecords ) { m_emitRecords = emitRecords; }
+    // only tracks whose artist, album or title contain every word of filter
+    void setFilter( const QString& filter ) { m_filter = filter; }
 
 signals:
     void tracks( const QList<Tomahawk::query_ptr>&, const QVariant& data );
+    void records( const QList<TrackStore::Record>&, const QVariant& data );
     void done( const Tomahawk::collection_ptr& );
 
 private:
@@ -75,8 +87,12 @@ private:
     Tomahawk::album_ptr m_album;
 
     unsigned int m_amount;
+    bool m_startAfter;
+    TrackStore::Record m_startAfterRecord;
     DatabaseCommand_AllTracks::SortOrder m_sortOrder;
     bool m_sortDescending;
+    bool m_emitRecords;
+    QString m_filter;
 };
 
 #endif // DATABASECOMMAND_ALLTRACKS_H
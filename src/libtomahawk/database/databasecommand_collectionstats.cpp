@@ -38,28 +38,45 @@ DatabaseCommand_CollectionStats::exec( DatabaseImpl* dbi )
     TomahawkSqlQuery query = dbi->newquery();
 
     QVariantMap m;
+    const QString sourceCondition = source()->isLocal() ? QString( "IS NULL" ) : QString( "= %1" ).arg( source()->id() );
+
+    // collection_stats is maintained by the commands changing the file table,
+    // so this is a single row lookup instead of counting the whole collection
+    query.exec( QString( "SELECT numfiles, lastmodified, numartists, numalbums, duration "
+                         "FROM collection_stats "
+                         "WHERE source %1" ).arg( sourceCondition ) );
+
+    if ( !query.next() )
+    {
+        // no stats row yet, this source has never added files
+        query.exec( QString( "SELECT count(*), coalesce(max(mtime), 0), 0, 0, coalesce(sum(duration), 0) "
+                             "FROM file "
+                             "WHERE source %1" ).arg( sourceCondition ) );
+        query.next();
+    }
+
+    if ( query.isValid() )
+    {
+        m.insert( "numfiles", query.value( 0 ).toInt() );
+        m.insert( "lastmodified", query.value( 1 ).toInt() );
+        m.insert( "numartists", query.value( 2 ).toInt() );
+        m.insert( "numalbums", query.value( 3 ).toInt() );
+        m.insert( "duration", query.value( 4 ).toInt() );
+    }
+
     if ( source()->isLocal() )
     {
-        query.exec( "SELECT count(*), max(mtime), (SELECT guid FROM oplog WHERE source IS NULL ORDER BY id DESC LIMIT 1) "
-                    "FROM file "
-                    "WHERE source IS NULL" );
+        query.exec( "SELECT guid FROM oplog WHERE source IS NULL ORDER BY id DESC LIMIT 1" );
     }
     else
     {
-        query.prepare( "SELECT count(*), max(mtime), (SELECT lastop FROM source WHERE id = ?) "
-                       "FROM file "
-                       "WHERE source = ?" );
-        query.addBindValue( source()->id() );
+        query.prepare( "SELECT lastop FROM source WHERE id = ?" );
         query.addBindValue( source()->id() );
         query.exec();
     }
 
     if ( query.next() )
-    {
-        m.insert( "numfiles", query.value( 0 ).toInt() );
-        m.insert( "lastmodified", query.value( 1 ).toInt() );
-        m.insert( "lastop", query.value( 2 ).toString() );
-    }
+        m.insert( "lastop", query.value( 0 ).toString() );
 
     emit done( m );
 }
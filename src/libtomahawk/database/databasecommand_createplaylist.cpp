@@ -46,6 +46,10 @@ DatabaseCommand_CreatePlaylist::DatabaseCommand_CreatePlaylist( const source_ptr
     , m_playlist( playlist )
     , m_report( false ) //this ctor used when creating locally, reporting done elsewhere
 {
+    setPriority( InteractivePriority );
+
+    // stamped here, the op is serialised before exec() runs
+    m_playlist->setCreatedOn( QDateTime::currentDateTime().toTime_t() );
 }
 
 DatabaseCommand_CreatePlaylist::~DatabaseCommand_CreatePlaylist()
@@ -110,8 +114,7 @@ DatabaseCommand_CreatePlaylist::createPlaylist( DatabaseImpl* lib, bool dynamic)
     }
     else
     {
-        now = QDateTime::currentDateTime().toTime_t();
-        m_playlist->setCreatedOn( now );
+        now = m_playlist->createdOn();
     }
 
     TomahawkSqlQuery cre = lib->newquery();
@@ -62,8 +62,14 @@ DatabaseCommand_DeleteDynamicPlaylist::postCommitHook()
     if( playlist.isNull() )
         playlist = source()->collection()->station( m_playlistguid );
 
-    qDebug() << "Just tried to load playlist for deletion:" << m_playlistguid << "Did we get a null one?" << playlist.isNull() << "is it a station?" << (playlist->mode() == OnDemand);
-    Q_ASSERT( !playlist.isNull() );
+    if ( playlist.isNull() )
+    {
+        // this source's playlists aren't loaded yet, there is nothing to report to
+        qDebug() << "Dynamic playlist not loaded, not reporting deletion:" << m_playlistguid;
+        return;
+    }
+
+    qDebug() << "Just tried to load playlist for deletion:" << m_playlistguid << "is it a station?" << (playlist->mode() == OnDemand);
 
     playlist->reportDeleted( playlist );
 
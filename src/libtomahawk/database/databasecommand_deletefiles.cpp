@@ -51,11 +51,26 @@ DatabaseCommand_DeleteFiles::postCommitHook()
     tDebug() << "Notifying of deleted tracks:" << m_idList.size() << "from source" << source()->id();
     emit notify( m_idList );
 
+    // only now the files are gone for real
+    Database::instance()->impl()->collectionStatsFilesRemoved( source()->isLocal() ? 0 : source()->id(), m_statsFiles,
+                                                               m_statsArtists, m_statsAlbums, m_statsDuration, m_statsLastModified );
+
     if ( source()->isLocal() )
         Servent::instance()->triggerDBSync();
 }
 
 
+void
+DatabaseCommand_DeleteFiles::resetStats()
+{
+    m_statsFiles = 0;
+    m_statsArtists = 0;
+    m_statsAlbums = 0;
+    m_statsDuration = 0;
+    m_statsLastModified = 0;
+}
+
+
 void
 DatabaseCommand_DeleteFiles::exec( DatabaseImpl* dbi )
 {
@@ -103,6 +118,12 @@ DatabaseCommand_DeleteFiles::exec( DatabaseImpl* dbi )
         delquery.prepare( QString( "DELETE FROM file WHERE source %1" )
                     .arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) ) );
         delquery.exec();
+
+        delquery.prepare( QString( "DELETE FROM resolve_cache WHERE file NOT NULL AND source %1" )
+                    .arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) ) );
+        delquery.exec();
+
+        dbi->clearCollectionStats( srcid );
     }
     else if ( !m_ids.isEmpty() )
     {
@@ -127,10 +148,49 @@ DatabaseCommand_DeleteFiles::exec( DatabaseImpl* dbi )
             idstring.chop( 2 ); //remove the trailing ", "
         }
 
+        // remember what we are about to remove, the collection_stats counters get updated after the commit
+        resetStats();
+        QSet< int > statsArtists, statsAlbums;
+        if ( !idstring.isEmpty() )
+        {
+            TomahawkSqlQuery statsquery = dbi->newquery();
+            statsquery.exec( QString( "SELECT file.duration, file.mtime, file_join.artist, file_join.album "
+                                      "FROM file LEFT JOIN file_join ON file_join.file = file.id "
+                                      "WHERE file.source %1 AND file.id IN ( %2 )" )
+                                .arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) )
+                                .arg( idstring ) );
+            while ( statsquery.next() )
+            {
+                m_statsFiles++;
+                m_statsDuration += statsquery.value( 0 ).toInt();
+                m_statsLastModified = qMax( m_statsLastModified, statsquery.value( 1 ).toInt() );
+                if ( statsquery.value( 2 ).toInt() > 0 )
+                    statsArtists << statsquery.value( 2 ).toInt();
+                if ( statsquery.value( 3 ).toInt() > 0 )
+                    statsAlbums << statsquery.value( 3 ).toInt();
+            }
+        }
+
         delquery.prepare( QString( "DELETE FROM file WHERE source %1 AND id IN ( %2 )" )
                              .arg( source()->isLocal() ? "IS NULL" : QString( "= %1" ).arg( source()->id() ) )
                              .arg( idstring ) );
-        delquery.exec();
+        if ( !delquery.exec() )
+        {
+            tDebug() << "Error deleting from file table";
+            resetStats();
+        }
+
+        if ( !idstring.isEmpty() )
+        {
+            delquery.prepare( QString( "DELETE FROM resolve_cache WHERE file IN ( %1 )" ).arg( idstring ) );
+            delquery.exec();
+        }
+
+        // whatever isn't referenced by a file of the source anymore is gone
+        int keptArtists = 0, keptAlbums = 0;
+        dbi->countCollectionStatsReferences( srcid, statsArtists, statsAlbums, QList< unsigned int >(), &keptArtists, &keptAlbums );
+        m_statsArtists = statsArtists.count() - keptArtists;
+        m_statsAlbums = statsAlbums.count() - keptAlbums;
     }
 
     if ( m_idList.count() )
@@ -40,24 +40,32 @@ Q_PROPERTY( bool deleteAll READ deleteAll WRITE setDeleteAll )
 public:
     explicit DatabaseCommand_DeleteFiles( QObject* parent = 0 )
         : DatabaseCommandLoggable( parent )
-    {}
+    {
+        resetStats();
+    }
 
     explicit DatabaseCommand_DeleteFiles( const Tomahawk::source_ptr& source, QObject* parent = 0 )
     : DatabaseCommandLoggable( parent ), m_deleteAll( true )
     {
+        resetStats();
         setSource( source );
+        setPriority( BulkPriority );
     }
 
     explicit DatabaseCommand_DeleteFiles( const QDir& dir, const Tomahawk::source_ptr& source, QObject* parent = 0 )
     : DatabaseCommandLoggable( parent ), m_dir( dir ), m_deleteAll( false )
     {
+        resetStats();
         setSource( source );
+        setPriority( BulkPriority );
     }
 
     explicit DatabaseCommand_DeleteFiles( const QVariantList& ids, const Tomahawk::source_ptr& source, QObject* parent = 0 )
     : DatabaseCommandLoggable( parent ), m_ids( ids ), m_deleteAll( false )
     {
+        resetStats();
         setSource( source );
+        setPriority( BulkPriority );
     }
 
     virtual QString commandname() const { return "deletefiles"; }
@@ -66,6 +74,8 @@ public:
     virtual bool doesMutates() const { return true; }
     virtual bool localOnly() const { return false; }
     virtual bool groupable() const { return true; }
+    // the ids of the files in a removed directory only come out of the file table
+    virtual bool logsExecResults() const { return true; }
     virtual void postCommitHook();
 
     QVariantList ids() const { return m_ids; }
@@ -79,10 +89,19 @@ signals:
     void notify( const QList<unsigned int>& ids );
 
 private:
+    void resetStats();
+
     QDir m_dir;
     QVariantList m_ids;
     QList<unsigned int> m_idList;
     bool m_deleteAll;
+
+    // collection_stats changes counted by exec(), applied after the commit
+    int m_statsFiles;
+    int m_statsArtists;
+    int m_statsAlbums;
+    qint64 m_statsDuration;
+    int m_statsLastModified;
 };
 
 #endif // DATABASECOMMAND_DELETEFILES_H
@@ -29,6 +29,7 @@ using namespace Tomahawk;
 DatabaseCommand_DeletePlaylist::DatabaseCommand_DeletePlaylist( const source_ptr& source, const QString& playlistguid )
     : DatabaseCommandLoggable( source )
 {
+    setPriority( InteractivePriority );
     setPlaylistguid( playlistguid );
 }
 
@@ -60,7 +61,12 @@ DatabaseCommand_DeletePlaylist::postCommitHook()
     }
 
     playlist_ptr playlist = source()->collection()->playlist( m_playlistguid );
-    Q_ASSERT( !playlist.isNull() );
+    if ( playlist.isNull() )
+    {
+        // this source's playlists aren't loaded yet, there is nothing to report to
+        qDebug() << "Playlist not loaded, not reporting deletion:" << m_playlistguid;
+        return;
+    }
 
     playlist->reportDeleted( playlist );
 
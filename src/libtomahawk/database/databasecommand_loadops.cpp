@@ -18,12 +18,43 @@
 
 #include "databasecommand_loadops.h"
 
+#include <qjson/serializer.h>
+
 #include "databaseimpl.h"
+#include "opcodec.h"
 #include "tomahawksqlquery.h"
 #include "source.h"
 #include "utils/logger.h"
 
 
+// turns a binary op into the JSON older peers expect. they can't apply
+// playlist deltas either, so revisions get their full list of entries again
+static void
+toLegacyFormat( DatabaseImpl* dbi, const dbop_ptr& op )
+{
+    QVariantMap m = OpCodec::decode( op->compressed ? qUncompress( op->payload ) : op->payload ).toMap();
+    if ( m.contains( "entrydelta" ) )
+    {
+        if ( !m.value( "entrydelta" ).toMap().isEmpty() )
+        {
+            QVariantList orderedguids;
+            foreach ( const QString& guid, dbi->playlistRevisionEntries( m.value( "newrev" ).toString() ) )
+                orderedguids << guid;
+
+            m.insert( "orderedguids", orderedguids );
+        }
+
+        m.remove( "entrydelta" );
+    }
+
+    QJson::Serializer ser;
+    op->payload = ser.serialize( m );
+    if ( op->compressed )
+        op->payload = qCompress( op->payload, 9 );
+    op->format = OpCodec::Json;
+}
+
+
 void
 DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
 {
@@ -47,7 +78,7 @@ DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
 
     TomahawkSqlQuery query = dbi->newquery();
     query.prepare( QString(
-                   "SELECT guid, command, json, compressed, singleton "
+                   "SELECT guid, command, json, compressed, singleton, format "
                    "FROM oplog "
                    "WHERE source %1 "
                    "AND id > coalesce((SELECT id FROM oplog WHERE guid = ?),0) "
@@ -66,6 +97,9 @@ DatabaseCommand_loadOps::exec( DatabaseImpl* dbi )
         op->payload = query.value( 2 ).toByteArray();
         op->compressed = query.value( 3 ).toBool();
         op->singleton = query.value( 4 ).toBool();
+        op->format = query.value( 5 ).toInt();
+        if ( m_legacyFormat && op->format == OpCodec::Binary )
+            toLegacyFormat( dbi, op );
 
         lastguid = op->guid;
         ops << op;
@@ -31,11 +31,14 @@ class DLLEXPORT DatabaseCommand_loadOps : public DatabaseCommand
 Q_OBJECT
 public:
     explicit DatabaseCommand_loadOps( const Tomahawk::source_ptr& src, QString since, QObject* parent = 0 )
-        : DatabaseCommand( src ), m_since( since )
+        : DatabaseCommand( src ), m_since( since ), m_legacyFormat( false )
     {
         Q_UNUSED( parent );
     }
 
+    // for peers that only know JSON ops and full playlist revisions
+    void setLegacyFormat( bool legacy ) { m_legacyFormat = legacy; }
+
     virtual void exec( DatabaseImpl* db );
     virtual bool doesMutates() const { return false; }
     virtual QString commandname() const { return "loadops"; }
@@ -45,6 +48,7 @@ signals:
 
 private:
     QString m_since; // guid to load from
+    bool m_legacyFormat;
 };
 
 #endif // DATABASECOMMAND_LOADOPS_H
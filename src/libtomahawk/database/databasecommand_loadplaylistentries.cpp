@@ -22,7 +22,6 @@
 
 #include "databaseimpl.h"
 #include "query.h"
-#include "qjson/parser.h"
 #include "utils/logger.h"
 
 using namespace Tomahawk;
@@ -41,7 +40,7 @@ void
 DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
 {
     TomahawkSqlQuery query_entries = dbi->newquery();
-    query_entries.prepare( "SELECT entries, playlist, author, timestamp, previous_revision "
+    query_entries.prepare( "SELECT playlist, author, timestamp, previous_revision "
                            "FROM playlist_revision "
                            "WHERE guid = :guid" );
     query_entries.bindValue( ":guid", m_revguid );
@@ -49,14 +48,11 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
 
     tLog( LOGVERBOSE ) << "trying to load playlist entries for guid:" << m_revguid;
     QString prevrev;
-    QJson::Parser parser; bool ok;
 
     if ( query_entries.next() )
     {
-        // entries should be a list of strings:
-        QVariant v = parser.parse( query_entries.value( 0 ).toByteArray(), &ok );
-        Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
-        m_guids = v.toStringList();
+        // entries may be stored as a delta against the previous revision
+        m_guids = dbi->playlistRevisionEntries( m_revguid );
         QString inclause = QString( "('%1')" ).arg( m_guids.join( "', '" ) );
 
         TomahawkSqlQuery query = dbi->newquery();
@@ -82,7 +78,7 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
             m_entrymap.insert( e->guid(), e );
         }
 
-        prevrev = query_entries.value( 4 ).toString();
+        prevrev = query_entries.value( 3 ).toString();
     }
     else
     {
@@ -92,13 +88,9 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
     if ( prevrev.length() )
     {
         TomahawkSqlQuery query_entries_old = dbi->newquery();
-        query_entries_old.prepare( "SELECT entries, "
-                                   "(SELECT currentrevision = ? FROM playlist WHERE guid = ?) "
-                                   "FROM playlist_revision "
-                                   "WHERE guid = ?" );
+        query_entries_old.prepare( "SELECT currentrevision = ? FROM playlist WHERE guid = ?" );
         query_entries_old.addBindValue( m_revguid );
-        query_entries_old.addBindValue( query_entries.value( 1 ).toString() );
-        query_entries_old.addBindValue( prevrev );
+        query_entries_old.addBindValue( query_entries.value( 0 ).toString() );
 
         query_entries_old.exec();
         if ( !query_entries_old.next() )
@@ -107,10 +99,12 @@ DatabaseCommand_LoadPlaylistEntries::generateEntries( DatabaseImpl* dbi )
             Q_ASSERT( false );
         }
 
-        QVariant v = parser.parse( query_entries_old.value( 0 ).toByteArray(), &ok );
-        Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
-        m_oldentries = v.toStringList();
-        m_islatest = query_entries_old.value( 1 ).toBool();
+        bool found;
+        m_oldentries = dbi->playlistRevisionEntries( prevrev, &found );
+        if ( !found )
+            return;
+
+        m_islatest = query_entries_old.value( 0 ).toBool();
     }
 
 //    qDebug() << Q_FUNC_INFO << "entrymap:" << m_entrymap;
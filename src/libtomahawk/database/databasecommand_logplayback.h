@@ -57,6 +57,7 @@ public:
         m_playtime = QDateTime::currentDateTimeUtc().toTime_t();
         m_trackDuration = result->duration();
         setSource( SourceList::instance()->getLocal() );
+        setPriority( InteractivePriority );
 
         setArtist( result->artist()->name() );
         setTrack( result->track() );
@@ -32,6 +32,7 @@ using namespace Tomahawk;
 DatabaseCommand_RenamePlaylist::DatabaseCommand_RenamePlaylist( const source_ptr& source, const QString& playlistguid, const QString& playlistTitle )
     : DatabaseCommandLoggable( source )
 {
+    setPriority( InteractivePriority );
     setPlaylistguid( playlistguid );
     setPlaylistTitle( playlistTitle );
 }
@@ -65,7 +66,12 @@ DatabaseCommand_RenamePlaylist::postCommitHook()
     if( playlist.isNull() )
         playlist = source()->collection()->station( m_playlistguid );
 
-    Q_ASSERT( !playlist.isNull() );
+    if ( playlist.isNull() )
+    {
+        // this source's playlists aren't loaded yet, they come up with the new title
+        qDebug() << "Playlist not loaded, not renaming:" << m_playlistguid;
+        return;
+    }
 
     qDebug() << "Renaming old playlist" << playlist->title() << "to" << m_playlistTitle << m_playlistguid;
     playlist->setTitle( m_playlistTitle );
@@ -27,9 +27,10 @@
 using namespace Tomahawk;
 
 
-DatabaseCommand_Resolve::DatabaseCommand_Resolve( const query_ptr& query )
+DatabaseCommand_Resolve::DatabaseCommand_Resolve( const query_ptr& query, const QSet< QString >& resolvers )
     : DatabaseCommand()
     , m_query( query )
+    , m_resolvers( resolvers )
 {
     Q_ASSERT( Pipeline::instance()->isRunning() );
 }
@@ -64,6 +65,27 @@ DatabaseCommand_Resolve::exec( DatabaseImpl* lib )
         }
     }
 
+    if ( !m_query->isFullTextQuery() )
+    {
+        // the database resolver goes first, so a remembered result saves us asking any other resolver
+        Tomahawk::result_ptr result = lib->resultFromCache( m_query );
+        if ( !result.isNull() )
+        {
+            const bool playable = result->collection().isNull() ?
+                                  m_resolvers.contains( result->friendlySource() ) :
+                                  result->collection()->source()->isOnline();
+            if ( playable )
+            {
+                tDebug( LOGVERBOSE ) << "Using remembered result:" << result->url();
+
+                QList<Tomahawk::result_ptr> res;
+                res << result;
+                emit results( m_query->id(), res );
+                return;
+            }
+        }
+    }
+
     if ( m_query->isFullTextQuery() )
         fullTextResolve( lib );
     else
@@ -116,7 +138,9 @@ DatabaseCommand_Resolve::resolve( DatabaseImpl* lib )
                             "artist.id = file_join.artist AND "
                             "track.id = file_join.track AND "
                             "file.id = file_join.file AND "
-                            "(%1)" )
+                            "%1 AND "
+                            "(%2)" )
+         .arg( lib->onlineSourcesFilter() )
          .arg( trksToken );
 
     files_query.prepare( sql );
@@ -255,7 +279,9 @@ DatabaseCommand_Resolve::fullTextResolve( DatabaseImpl* lib )
                             "artist.id = file_join.artist AND "
                             "track.id = file_join.track AND "
                             "file.id = file_join.file AND "
-                            "%1" )
+                            "%1 AND "
+                            "%2" )
+                        .arg( lib->onlineSourcesFilter() )
                         .arg( trksl.length() > 0 ? trksToken : QString( "0" ) );
 
     files_query.prepare( sql );
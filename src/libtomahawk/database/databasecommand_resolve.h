@@ -25,6 +25,7 @@
 #include "artist.h"
 #include "album.h"
 
+#include <QSet>
 #include <QVariant>
 
 #include "dllmacro.h"
@@ -33,7 +34,8 @@ class DLLEXPORT DatabaseCommand_Resolve : public DatabaseCommand
 {
 Q_OBJECT
 public:
-    explicit DatabaseCommand_Resolve( const Tomahawk::query_ptr& query );
+    // resolvers: names of the loaded resolvers, remembered results of other resolvers aren't playable
+    explicit DatabaseCommand_Resolve( const Tomahawk::query_ptr& query, const QSet< QString >& resolvers = QSet< QString >() );
     virtual ~DatabaseCommand_Resolve();
 
     virtual QString commandname() const { return "dbresolve"; }
@@ -53,6 +55,7 @@ private:
     void resolve( DatabaseImpl* lib );
 
     Tomahawk::query_ptr m_query;
+    QSet< QString > m_resolvers;
 };
 
 #endif // DATABASECOMMAND_RESOLVE_H
@@ -93,9 +93,13 @@ DatabaseCommand_SetDynamicPlaylistRevision::postCommitHook()
         return;
     }
 
-    QStringList orderedentriesguids;
-    foreach( const QVariant& v, orderedguids() )
-        orderedentriesguids << v.toString();
+    if ( m_baseMissing && m_mode == Static )
+    {
+        tLog() << "Not updating playlist" << playlistguid() << "- revision" << newrev() << "is based on one we don't have";
+        return;
+    }
+
+    QStringList orderedentriesguids = orderedEntryGuids();
 
     Q_ASSERT( !source().isNull() );
     Q_ASSERT( !source()->collection().isNull() );
@@ -111,6 +115,14 @@ DatabaseCommand_SetDynamicPlaylistRevision::postCommitHook()
     if( playlist.isNull() ) // if it's neither an auto or station, it must not be auto-loaded, so we MUST have been told about it directly
         rawPl = m_playlist;
 
+    if ( rawPl == 0 )
+    {
+        // this source's playlists aren't loaded yet. the lookups above started
+        // loading them, and they get read with this revision already
+        tDebug() << "Dynamic playlist not loaded, not updating:" << playlistguid() << "from source:" << source()->friendlyName();
+        return;
+    }
+
     // workaround a bug in pre-0.1.0 tomahawks. they created dynamic playlists in OnDemand mode *always*, and then set the mode to the real one.
     // now that we separate them, if we get them as one and then get a changed mode, the playlist ends up in the wrong bucket in Collection.
     // so here we fix it if we have to.
@@ -123,12 +135,13 @@ DatabaseCommand_SetDynamicPlaylistRevision::postCommitHook()
     else if ( rawPl->mode() == OnDemand && source()->collection()->station( playlistguid() ).isNull() ) // should be here
         source()->collection()->moveAutoToStation( playlistguid() );
 
-    if ( rawPl == 0 )
+    if ( m_mode == Static && m_applied && !m_resolvedRevision.isEmpty() )
     {
-        tLog() <<"Got null playlist with guid:" << playlistguid() << "from source and collection:" << source()->friendlyName() << source()->collection()->name() << "and mode is static?:" << (m_mode == Static);
-        Q_ASSERT( false );
+        // revisions that came in before this one went on top of it, their entries are only in the db
+        QMetaObject::invokeMethod( rawPl, "loadRevision", Qt::QueuedConnection, Q_ARG( QString, m_resolvedRevision ) );
         return;
     }
+
     if ( !m_controlsV.isEmpty() && m_controls.isEmpty() )
     {
         QList<QVariantMap> controlMap;
@@ -39,6 +39,7 @@ DatabaseCommand_SetPlaylistRevision::DatabaseCommand_SetPlaylistRevision(
                       const QList<plentry_ptr>& entries )
     : DatabaseCommandLoggable( s )
     , m_applied( false )
+    , m_baseMissing( false )
     , m_newrev( newrev )
     , m_oldrev( oldrev )
     , m_addedentries( addedentries )
@@ -46,6 +47,7 @@ DatabaseCommand_SetPlaylistRevision::DatabaseCommand_SetPlaylistRevision(
 {
     Q_ASSERT( !newrev.isEmpty() );
     m_localOnly = ( newrev == oldrev );
+    setPriority( InteractivePriority );
 
     setPlaylistguid( playlistguid );
 
@@ -57,6 +59,19 @@ DatabaseCommand_SetPlaylistRevision::DatabaseCommand_SetPlaylistRevision(
 }
 
 
+void
+DatabaseCommand_SetPlaylistRevision::setOldOrderedGuids( const QStringList& oldorderedguids )
+{
+    const QVariantList delta = DatabaseImpl::playlistEntriesDelta( oldorderedguids, orderedEntryGuids() );
+    if ( delta.count() >= m_orderedguids.count() )
+        return;
+
+    QVariantMap m;
+    m.insert( "delta", delta );
+    setEntrydelta( m );
+}
+
+
 void
 DatabaseCommand_SetPlaylistRevision::postCommitHook()
 {
@@ -64,19 +79,30 @@ DatabaseCommand_SetPlaylistRevision::postCommitHook()
     if ( m_localOnly )
         return;
 
-    QStringList orderedentriesguids;
-    foreach( const QVariant& v, m_orderedguids )
-        orderedentriesguids << v.toString();
+    if ( m_baseMissing )
+    {
+        tLog() << "Not updating playlist" << m_playlistguid << "- revision" << m_newrev << "is based on one we don't have";
+        return;
+    }
 
     // private, but we are a friend. will recall itself in its own thread:
     playlist_ptr playlist = source()->collection()->playlist( m_playlistguid );
     if ( playlist.isNull() )
     {
-        qDebug() << m_playlistguid;
-        Q_ASSERT( !playlist.isNull() );
+        // this source's playlists aren't loaded yet. the lookup started loading
+        // them, and they get read with this revision already
+        tDebug() << "Playlist not loaded, not updating:" << m_playlistguid;
+        return;
+    }
+
+    if ( m_applied && !m_resolvedRevision.isEmpty() )
+    {
+        // revisions that came in before this one went on top of it, their entries are only in the db
+        QMetaObject::invokeMethod( playlist.data(), "loadRevision", Qt::QueuedConnection, Q_ARG( QString, m_resolvedRevision ) );
         return;
     }
 
+    QStringList orderedentriesguids = orderedEntryGuids();
     playlist->setRevision( m_newrev,
                            orderedentriesguids,
                            m_previous_rev_orderedguids,
@@ -109,10 +135,6 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
         return;
     }
 
-    QVariantList vlist = m_orderedguids;
-    QJson::Serializer ser;
-    const QByteArray entries = ser.serialize( vlist );
-
     // add any new items:
     TomahawkSqlQuery adde = lib->newquery();
     if ( m_localOnly )
@@ -164,6 +186,70 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
         }
     }
 
+    // the entries of the revision we are based on, to diff against
+    bool baseFound = false;
+    int baseDepth = 0;
+    QStringList previousEntries;
+    if ( !m_oldrev.isEmpty() )
+        previousEntries = lib->playlistRevisionEntries( m_oldrev, &baseFound, &baseDepth );
+
+    QJson::Serializer ser;
+    QByteArray entries;
+
+    // a peer may only send us the changes against oldrev. our own revisions have the full list,
+    // their delta is only for the op
+    const bool peerDelta = !m_entrydelta.isEmpty() && !source()->isLocal();
+    QStringList deltaEntries;
+    bool deltaOk = baseFound;
+    if ( peerDelta && baseFound )
+        deltaEntries = DatabaseImpl::applyPlaylistEntriesDelta( previousEntries, m_entrydelta.value( "delta" ).toList(), &deltaOk );
+
+    if ( peerDelta && !deltaOk )
+    {
+        // We don't have the revision this delta is based on, or it doesn't fit it.
+        // Throwing would roll back the whole op group and stall the sync with this
+        // peer forever, so keep the delta as pending: it gets resolved if the base
+        // shows up later, and the sender's next checkpoint carries the full list again.
+        // Until then the playlist stays at the revision it has.
+        tLog() << "Can't apply delta of revision" << m_newrev << "to base revision" << m_oldrev
+               << "of playlist" << m_playlistguid << "- found base:" << baseFound;
+        m_baseMissing = true;
+        m_orderedguids.clear();
+
+        QVariantMap stored = m_entrydelta;
+        stored.insert( "pending", true );
+        if ( baseFound )
+            stored.insert( "broken", true ); // never apply it to the base we have
+        else
+            stored.insert( "base", m_oldrev ); // previous_revision has to exist, see below
+        entries = ser.serialize( stored );
+    }
+    else
+    {
+        if ( peerDelta )
+        {
+            m_orderedguids.clear();
+            foreach ( const QString& guid, deltaEntries )
+                m_orderedguids << guid;
+        }
+
+        const QStringList orderedEntries = orderedEntryGuids();
+        entries = ser.serialize( m_orderedguids );
+
+        // store a delta unless it's time for a checkpoint, or the delta isn't any smaller.
+        // the op was serialised already, none of this goes to peers
+        if ( baseFound && baseDepth + 1 < PLAYLIST_CHECKPOINT_INTERVAL )
+        {
+            QVariantMap stored;
+            stored.insert( "delta", DatabaseImpl::playlistEntriesDelta( previousEntries, orderedEntries ) );
+            stored.insert( "depth", baseDepth + 1 );
+
+            const QByteArray storedDelta = ser.serialize( stored );
+            if ( storedDelta.length() < entries.length() )
+                entries = storedDelta;
+        }
+    }
+
     // add / update the revision:
     TomahawkSqlQuery query = lib->newquery();
     QString sql = "INSERT INTO playlist_revision(guid, playlist, entries, author, timestamp, previous_revision) "
@@ -175,44 +261,58 @@ DatabaseCommand_SetPlaylistRevision::exec( DatabaseImpl* lib )
     query.addBindValue( entries );
     query.addBindValue( source()->isLocal() ? QVariant(QVariant::Int) : source()->id() );
     query.addBindValue( 0 ); //ts
-    query.addBindValue( m_oldrev.isEmpty() ? QVariant(QVariant::String) : m_oldrev );
+    // a missing base would fail the foreign key on commit. it gets linked when it is resolved
+    const bool linkBase = !m_oldrev.isEmpty() && !( m_baseMissing && !baseFound );
+    query.addBindValue( linkBase ? m_oldrev : QVariant(QVariant::String) );
     query.exec();
 
     qDebug() << "Currentrevision:" << m_currentRevision << "oldrev:" << m_oldrev;
-    // if optimistic locking is ok, update current revision to this new one
-    if ( m_currentRevision == m_oldrev )
+    if ( m_baseMissing )
     {
-        qDebug() << "Updating current revision, optimistic locking ok";
+        // the playlist would load empty, and local edits on top of that would wipe it for everybody
+        tDebug() << "Not updating current revision, revision" << m_newrev << "is pending";
+        return;
+    }
 
-        TomahawkSqlQuery query2 = lib->newquery();
-        query2.prepare( "UPDATE playlist SET currentrevision = ? WHERE guid = ?" );
-        query2.bindValue( 0, m_newrev );
-        query2.bindValue( 1, m_playlistguid );
-        query2.exec();
+    // if optimistic locking is ok, update current revision to this new one. Pending revisions
+    // in between don't count, they never became current.
+    const bool afterPending = ( m_currentRevision != m_oldrev && lib->playlistRevisionPending( m_oldrev, m_currentRevision ) );
+    if ( m_currentRevision == m_oldrev || afterPending )
+    {
+        qDebug() << "Updating current revision, optimistic locking ok";
 
         m_applied = true;
 
-        // load previous revision entries, which we need to pass on
+        // previous revision entries, which we need to pass on
         // so the change can be diffed
-        TomahawkSqlQuery query_entries = lib->newquery();
-        query_entries.prepare( "SELECT entries, playlist, author, timestamp, previous_revision "
-                               "FROM playlist_revision "
-                               "WHERE guid = :guid" );
-        query_entries.bindValue( ":guid", m_oldrev );
-        query_entries.exec();
-        if ( query_entries.next() )
-        {
-            bool ok;
-            QJson::Parser parser;
-            QVariant v = parser.parse( query_entries.value( 0 ).toByteArray(), &ok );
-            Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
-
-            m_previous_rev_orderedguids = v.toStringList();
-        }
+        m_previous_rev_orderedguids = afterPending ? lib->playlistRevisionEntries( m_currentRevision ) : previousEntries;
     }
     else if ( !m_oldrev.isEmpty() )
     {
         tDebug() << "Not updating current revision, optimistic locking fail";
 //        Q_ASSERT( false );
     }
+
+    // deltas that arrived before the revision they are based on can be resolved now
+    m_resolvedRevision = lib->resolvePendingPlaylistRevisions( m_playlistguid, m_newrev, orderedEntryGuids() );
+
+    if ( m_applied )
+    {
+        TomahawkSqlQuery query2 = lib->newquery();
+        query2.prepare( "UPDATE playlist SET currentrevision = ? WHERE guid = ?" );
+        query2.bindValue( 0, m_resolvedRevision.isEmpty() ? m_newrev : m_resolvedRevision );
+        query2.bindValue( 1, m_playlistguid );
+        query2.exec();
+    }
+}
+
+
+QStringList
+DatabaseCommand_SetPlaylistRevision::orderedEntryGuids() const
+{
+    QStringList guids;
+    foreach( const QVariant& v, m_orderedguids )
+        guids << v.toString();
+
+    return guids;
 }
@@ -25,6 +25,11 @@
 
 #include "dllmacro.h"
 
+// store a full list of entries at least every this many revisions,
+// so loading a revision never has to apply more deltas than that.
+// peers get the full list as often, so the ones that missed a revision catch up
+#define PLAYLIST_CHECKPOINT_INTERVAL 32
+
 using namespace Tomahawk;
 
 class DLLEXPORT DatabaseCommand_SetPlaylistRevision : public DatabaseCommandLoggable
@@ -34,12 +39,14 @@ Q_PROPERTY( QString playlistguid      READ playlistguid  WRITE setPlaylistguid )
 Q_PROPERTY( QString newrev            READ newrev        WRITE setNewrev )
 Q_PROPERTY( QString oldrev            READ oldrev        WRITE setOldrev )
 Q_PROPERTY( QVariantList orderedguids READ orderedguids  WRITE setOrderedguids )
+Q_PROPERTY( QVariantMap entrydelta    READ entrydelta    WRITE setEntrydelta )
 Q_PROPERTY( QVariantList addedentries READ addedentriesV WRITE setAddedentriesV )
 
 public:
     explicit DatabaseCommand_SetPlaylistRevision( QObject* parent = 0 )
         : DatabaseCommandLoggable( parent )
         , m_applied( false )
+        , m_baseMissing( false )
         , m_localOnly( false )
     {}
 
@@ -90,11 +97,24 @@ public:
     QString oldrev() const { return m_oldrev; }
     QString playlistguid() const { return m_playlistguid; }
 
+    // when we have a delta against oldrev, only the delta goes over the wire
     void setOrderedguids( const QVariantList& l ) { m_orderedguids = l; }
-    QVariantList orderedguids() const { return m_orderedguids; }
+    QVariantList orderedguids() const { return m_entrydelta.isEmpty() ? m_orderedguids : QVariantList(); }
+
+    void setEntrydelta( const QVariantMap& m ) { m_entrydelta = m; }
+    QVariantMap entrydelta() const { return m_entrydelta; }
+
+    // the entries of oldrev, so only the changes against it go over the wire.
+    // has to be called before the command is enqueued, that's when the op gets serialised
+    void setOldOrderedGuids( const QStringList& oldorderedguids );
 
 protected:
     bool m_applied;
+    // a peer sent a delta against a revision we don't have, so the entries are unknown.
+    // the revision is stored as pending and doesn't become the current one
+    bool m_baseMissing;
+    // pending revisions based on this one that could be resolved now, the newest of them
+    QString m_resolvedRevision;
     QStringList m_previous_rev_orderedguids;
     QString m_playlistguid;
     QString m_newrev, m_oldrev;
@@ -102,8 +122,12 @@ protected:
 
     QString m_currentRevision;
 
+    // the full list of entry guids of the new revision, also when we got a delta
+    QStringList orderedEntryGuids() const;
+
 private:
     QVariantList m_orderedguids;
+    QVariantMap m_entrydelta;
     QList<Tomahawk::plentry_ptr> m_addedentries, m_entries;
 
     bool m_localOnly;
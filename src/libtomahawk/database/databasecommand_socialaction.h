@@ -72,6 +72,7 @@ public:
         : DatabaseCommandLoggable( parent ), m_query( query ), m_action( action )
     {
         setSource( SourceList::instance()->getLocal() );
+        setPriority( InteractivePriority );
 
         setArtist( query->artist() );
         setTrack( query->track() );
@@ -36,4 +36,8 @@ DatabaseCommand_SourceOffline::exec( DatabaseImpl* lib )
     TomahawkSqlQuery q = lib->newquery();
     q.exec( QString( "UPDATE source SET isonline = 'false' WHERE id = %1" )
             .arg( m_id ) );
+
+    // whatever we remembered to be resolved by this peer is gone with it
+    q.exec( QString( "DELETE FROM resolve_cache WHERE source = %1" )
+            .arg( m_id ) );
 }
@@ -0,0 +1,118 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databasecommand_updateresolvecache.h"
+
+#include <QDateTime>
+
+#include "databaseimpl.h"
+#include "tomahawksqlquery.h"
+#include "collection.h"
+#include "query.h"
+#include "result.h"
+#include "source.h"
+#include "utils/logger.h"
+
+
+DatabaseCommand_UpdateResolveCache::DatabaseCommand_UpdateResolveCache( const QList< Tomahawk::query_ptr >& queries )
+    : DatabaseCommand()
+    , m_queries( queries )
+{
+}
+
+
+void
+DatabaseCommand_UpdateResolveCache::exec( DatabaseImpl* lib )
+{
+    const uint now = QDateTime::currentDateTime().toTime_t();
+
+    TomahawkSqlQuery query = lib->newquery();
+    query.prepare( "DELETE FROM resolve_cache WHERE expires <= ?" );
+    query.addBindValue( now );
+    query.exec();
+
+    TomahawkSqlQuery existing = lib->newquery();
+    existing.prepare( "SELECT url, source FROM resolve_cache WHERE artist = ? AND track = ? AND album = ?" );
+
+    TomahawkSqlQuery file = lib->newquery();
+    TomahawkSqlQuery insert = lib->newquery();
+    insert.prepare( "INSERT OR REPLACE INTO resolve_cache(artist, track, album, url, source, file, resolver, score, duration, expires) "
+                    "VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)" );
+
+    int updated = 0;
+    foreach ( const Tomahawk::query_ptr& q, m_queries )
+    {
+        if ( q->isFullTextQuery() || !q->playable() )
+            continue;
+
+        const QList< Tomahawk::result_ptr > results = q->results();
+        if ( results.isEmpty() )
+            continue;
+
+        const Tomahawk::result_ptr r = results.first();
+        QString url = r->url();
+        QVariant source;
+        QVariant fileId;
+        uint expires = now + RESOLVECACHE_RESOLVER_TTL;
+
+        if ( !r->collection().isNull() )
+        {
+            const Tomahawk::source_ptr s = r->collection()->source();
+            if ( !s->isLocal() )
+            {
+                // servent://<user>\t<url>
+                url = url.mid( url.indexOf( '\t' ) + 1 );
+                source = s->id();
+            }
+
+            file.prepare( QString( "SELECT id FROM file WHERE source %1 AND url = ?" )
+                          .arg( s->isLocal() ? "IS NULL" : QString( "= %1" ).arg( s->id() ) ) );
+            file.addBindValue( url );
+            file.exec();
+            if ( !file.next() )
+                continue;
+
+            fileId = file.value( 0 );
+            expires = now + RESOLVECACHE_COLLECTION_TTL;
+        }
+
+        // don't push the expiry of a result that got served from the cache
+        existing.addBindValue( q->artistSortname() );
+        existing.addBindValue( q->trackSortname() );
+        existing.addBindValue( q->albumSortname() );
+        existing.exec();
+        if ( existing.next() && existing.value( 0 ).toString() == url && existing.value( 1 ).toInt() == source.toInt() )
+            continue;
+
+        insert.addBindValue( q->artistSortname() );
+        insert.addBindValue( q->trackSortname() );
+        insert.addBindValue( q->albumSortname() );
+        insert.addBindValue( url );
+        insert.addBindValue( source );
+        insert.addBindValue( fileId );
+        insert.addBindValue( r->friendlySource() );
+        insert.addBindValue( r->score() );
+        insert.addBindValue( r->duration() );
+        insert.addBindValue( expires );
+        insert.exec();
+
+        updated++;
+    }
+
+    tDebug( LOGVERBOSE ) << Q_FUNC_INFO << "Remembered" << updated << "of" << m_queries.count() << "results";
+}
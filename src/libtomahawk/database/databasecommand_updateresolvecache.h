@@ -0,0 +1,51 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATABASECOMMAND_UPDATERESOLVECACHE_H
+#define DATABASECOMMAND_UPDATERESOLVECACHE_H
+
+#include "databasecommand.h"
+#include "typedefs.h"
+
+#include "dllmacro.h"
+
+// how long remembered results are good for, in seconds
+#define RESOLVECACHE_COLLECTION_TTL (30 * 24 * 60 * 60)
+#define RESOLVECACHE_RESOLVER_TTL (24 * 60 * 60)
+
+/*
+    Remembers the best result of each of the given (resolved) queries in
+    resolve_cache, and drops expired entries.
+*/
+class DLLEXPORT DatabaseCommand_UpdateResolveCache : public DatabaseCommand
+{
+Q_OBJECT
+
+public:
+    explicit DatabaseCommand_UpdateResolveCache( const QList< Tomahawk::query_ptr >& queries );
+
+    virtual QString commandname() const { return "updateresolvecache"; }
+
+    bool doesMutates() const { return true; }
+    void exec( DatabaseImpl* lib );
+
+private:
+    QList< Tomahawk::query_ptr > m_queries;
+};
+
+#endif // DATABASECOMMAND_UPDATERESOLVECACHE_H
@@ -33,13 +33,33 @@ public:
 
     explicit DatabaseCommandLoggable( QObject* parent = 0 )
         : DatabaseCommand( parent )
+        , m_encodedOpCompressed( false )
     {}
 
     explicit DatabaseCommandLoggable( const Tomahawk::source_ptr& s, QObject* parent = 0 )
         : DatabaseCommand( s, parent )
+        , m_encodedOpCompressed( false )
     {}
 
     virtual bool loggable() const { return true; }
+
+    // true if the logged properties are only known after exec(), the op then
+    // gets serialised inside the write transaction
+    virtual bool logsExecResults() const { return false; }
+
+    // called on the thread enqueueing the command right before the op gets serialised,
+    // to fill in properties exec() would otherwise produce. only thread safe parts of
+    // DatabaseImpl may be used here
+    virtual void prepareOp( DatabaseImpl* /*lib*/ ) {}
+
+    // the op as it goes into the oplog, when it got serialised on enqueueing
+    void setEncodedOp( const QByteArray& payload, bool compressed ) { m_encodedOp = payload; m_encodedOpCompressed = compressed; }
+    const QByteArray& encodedOp() const { return m_encodedOp; }
+    bool encodedOpCompressed() const { return m_encodedOpCompressed; }
+
+private:
+    QByteArray m_encodedOp;
+    bool m_encodedOpCompressed;
 };
 
 #endif // DATABASECOMMANDLOGGABLE_H
@@ -21,13 +21,18 @@
 #include "databaseimpl.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QRegExp>
 #include <QStringList>
 #include <QtAlgorithms>
 #include <QFile>
 
+#include <qjson/parser.h>
+#include <qjson/serializer.h>
+
 #include "database/database.h"
 #include "databasecommand_updatesearchindex.h"
+#include "opcodec.h"
 #include "sourcelist.h"
 #include "result.h"
 #include "artist.h"
@@ -41,7 +46,7 @@
 */
 #include "schema.sql.h"
 
-#define CURRENT_SCHEMA_VERSION 28
+#define CURRENT_SCHEMA_VERSION 31
 
 
 DatabaseImpl::DatabaseImpl( const QString& dbname, Database* parent )
@@ -49,6 +54,7 @@ DatabaseImpl::DatabaseImpl( const QString& dbname, Database* parent )
     , m_lastartid( 0 )
     , m_lastalbid( 0 )
     , m_lasttrkid( 0 )
+    , m_nextFileId( 0 )
 {
     QTime t;
     t.start();
@@ -79,6 +85,12 @@ DatabaseImpl::DatabaseImpl( const QString& dbname, Database* parent )
     // in case of unclean shutdown last time:
     query.exec( "UPDATE source SET isonline = 'false'" );
 
+    // file ids are handed out by reserveFileIds() from here on. a rolled back insert may
+    // have lowered the sequence again, so start after the highest id ever used
+    query.exec( "SELECT max( coalesce( ( SELECT seq FROM sqlite_sequence WHERE name = 'file' ), 0 ), "
+                "coalesce( ( SELECT max(id) FROM file ), 0 ) )" );
+    m_nextFileId = query.next() ? query.value( 0 ).toInt() + 1 : 1;
+
     m_fuzzyIndex = new FuzzyIndex( *this, schemaUpdated );
     if ( schemaUpdated )
         QTimer::singleShot( 0, this, SLOT( updateIndex() ) );
@@ -99,6 +111,20 @@ DatabaseImpl::~DatabaseImpl()
 }
 
 
+void
+DatabaseImpl::moveToMainThread()
+{
+    QThread* main = QCoreApplication::instance()->thread();
+    if ( thread() == main )
+        return;
+
+    // must happen on the thread we were created on
+    Q_ASSERT( thread() == QThread::currentThread() );
+    m_fuzzyIndex->moveToThread( main );
+    moveToThread( main );
+}
+
+
 void
 DatabaseImpl::dumpDatabase()
 {
@@ -113,20 +139,56 @@ DatabaseImpl::dumpDatabase()
         QTextStream dumpout( &dump );
         TomahawkSqlQuery query = newquery();
 
+        QJson::Serializer serializer;
         query.exec( "SELECT * FROM oplog" );
         while ( query.next() )
         {
+            QByteArray payload = query.value( 5 ).toBool() ? qUncompress( query.value( 6 ).toByteArray() ) : query.value( 6 ).toByteArray();
+            if ( query.value( 7 ).toInt() == OpCodec::Binary )
+                payload = serializer.serialize( OpCodec::decode( payload ) );
+
             dumpout << "ID: " << query.value( 0 ).toInt() << endl
                     << "GUID: " << query.value( 2 ).toString() << endl
                     << "Command: " << query.value( 3 ).toString() << endl
                     << "Singleton: " << query.value( 4 ).toBool() << endl
-                    << "JSON: " << ( query.value( 5 ).toBool() ? qUncompress( query.value( 6 ).toByteArray() ) : query.value( 6 ).toByteArray() )
+                    << "JSON: " << payload
                     << endl << endl << endl;
         }
     }
 }
 
 
+void
+DatabaseImpl::setSourceOnline( int srcid, bool online )
+{
+    if ( srcid <= 0 )
+        return;
+
+    QWriteLocker lock( &m_onlineLock );
+    if ( online )
+        m_onlineSources.insert( srcid );
+    else
+        m_onlineSources.remove( srcid );
+}
+
+
+QString
+DatabaseImpl::onlineSourcesFilter() const
+{
+    QStringList ids;
+    {
+        QReadLocker lock( &m_onlineLock );
+        foreach ( int id, m_onlineSources )
+            ids << QString::number( id );
+    }
+
+    if ( ids.isEmpty() )
+        return QString( "file.source IS NULL" );
+
+    return QString( "(file.source IS NULL OR file.source IN (%1))" ).arg( ids.join( "," ) );
+}
+
+
 void
 DatabaseImpl::loadIndex()
 {
@@ -477,19 +539,460 @@ DatabaseImpl::getTrackFids( int tid )
 
 
 QString
-DatabaseImpl::sortname( const QString& str, bool replaceArticle )
+DatabaseImpl::sortname( const QString& str, bool replaceArticle, bool stripDiacritics )
 {
-    QString s = str.toLower().trimmed().replace( QRegExp( "[\\s]{2,}" ), " " );
+    // Single pass equivalent of toLower().trimmed() plus collapsing runs of two or
+    // more whitespace characters into one space. Sortnames are stored in the
+    // database, so this must not change what it produces.
+    const QChar* in = str.constData();
+    int length = str.length();
+
+    bool ascii = true;
+    for ( int i = 0; i < length; i++ )
+    {
+        if ( in[i].unicode() >= 0x80 )
+        {
+            ascii = false;
+            break;
+        }
+    }
+
+    // outside of ASCII, lowercasing a character can yield more than one
+    QString lowered;
+    if ( !ascii )
+    {
+        lowered = str.toLower();
+        in = lowered.constData();
+        length = lowered.length();
+    }
 
-    if ( replaceArticle && s.startsWith( "the " ) )
+    QString s( length, Qt::Uninitialized );
+    QChar* out = s.data();
+    int n = 0;
+    int spaces = 0;
+    QChar space;
+
+    for ( int i = 0; i < length; i++ )
     {
-        s = s.mid( 4 );
+        QChar c = in[i];
+        if ( c.isSpace() )
+        {
+            if ( !spaces++ )
+                space = c;
+            continue;
+        }
+
+        if ( spaces )
+        {
+            // leading whitespace is dropped, a single whitespace character is kept as it is
+            if ( n )
+                out[n++] = ( spaces > 1 ? QChar( ' ' ) : space );
+            spaces = 0;
+        }
+
+        if ( ascii )
+        {
+            if ( c.unicode() >= 'A' && c.unicode() <= 'Z' )
+                c = QChar( c.unicode() + 32 );
+        }
+        else if ( stripDiacritics )
+        {
+            while ( c.decompositionTag() == QChar::Canonical )
+                c = c.decomposition().at( 0 );
+        }
+
+        out[n++] = c;
     }
 
+    s.resize( n );
+
+    if ( replaceArticle && s.startsWith( QLatin1String( "the " ) ) )
+        s.remove( 0, 4 );
+
     return s;
 }
 
 
+int
+DatabaseImpl::reserveFileIds( int count )
+{
+    return m_nextFileId.fetchAndAddOrdered( count );
+}
+
+
+static QString
+sourceCondition( int srcid )
+{
+    return srcid > 0 ? QString( "= %1" ).arg( srcid ) : QString( "IS NULL" );
+}
+
+
+void
+DatabaseImpl::ensureCollectionStats( int srcid )
+{
+    TomahawkSqlQuery query = newquery();
+    query.exec( QString( "SELECT 1 FROM collection_stats WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+    if ( !query.next() )
+        recalcCollectionStats( srcid );
+}
+
+
+void
+DatabaseImpl::recalcCollectionStats( int srcid )
+{
+    TomahawkSqlQuery query = newquery();
+    query.exec( QString( "DELETE FROM collection_stats WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+
+    query.prepare( QString( "INSERT INTO collection_stats(source, numfiles, numartists, numalbums, duration, lastmodified) "
+                            "SELECT ?, count(*), count(DISTINCT file_join.artist), count(DISTINCT file_join.album), "
+                            "coalesce(sum(file.duration), 0), coalesce(max(file.mtime), 0) "
+                            "FROM file LEFT JOIN file_join ON file_join.file = file.id "
+                            "WHERE file.source %1" ).arg( sourceCondition( srcid ) ) );
+    query.addBindValue( srcid > 0 ? QVariant( srcid ) : QVariant( QVariant::Int ) );
+    query.exec();
+}
+
+
+void
+DatabaseImpl::clearCollectionStats( int srcid )
+{
+    TomahawkSqlQuery query = newquery();
+    query.exec( QString( "DELETE FROM collection_stats WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+
+    query.prepare( "INSERT INTO collection_stats(source) VALUES(?)" );
+    query.addBindValue( srcid > 0 ? QVariant( srcid ) : QVariant( QVariant::Int ) );
+    query.exec();
+}
+
+
+static QString
+idList( const QList< int >& ids )
+{
+    if ( ids.isEmpty() )
+        return QString( "NULL" );
+
+    QStringList l;
+    foreach ( int id, ids )
+        l << QString::number( id );
+
+    return l.join( ", " );
+}
+
+
+void
+DatabaseImpl::countCollectionStatsReferences( int srcid, const QSet< int >& artists, const QSet< int >& albums,
+                                              const QList< unsigned int >& exceptFiles, int* artistCount, int* albumCount )
+{
+    *artistCount = 0;
+    *albumCount = 0;
+    if ( artists.isEmpty() && albums.isEmpty() )
+        return;
+
+    QList< int > except;
+    foreach ( unsigned int id, exceptFiles )
+        except << id;
+
+    TomahawkSqlQuery query = newquery();
+    query.exec( QString( "SELECT "
+                         "( SELECT count(DISTINCT file_join.artist) FROM file_join, file "
+                         "  WHERE file.id = file_join.file AND file.source %1 AND file_join.artist IN ( %2 ) AND file.id NOT IN ( %4 ) ), "
+                         "( SELECT count(DISTINCT file_join.album) FROM file_join, file "
+                         "  WHERE file.id = file_join.file AND file.source %1 AND file_join.album IN ( %3 ) AND file.id NOT IN ( %4 ) )" )
+                   .arg( sourceCondition( srcid ) )
+                   .arg( idList( artists.toList() ) )
+                   .arg( idList( albums.toList() ) )
+                   .arg( idList( except ) ) );
+
+    if ( query.next() )
+    {
+        *artistCount = query.value( 0 ).toInt();
+        *albumCount = query.value( 1 ).toInt();
+    }
+}
+
+
+void
+DatabaseImpl::collectionStatsFilesAdded( int srcid, int files, int artists, int albums, qint64 duration, int lastModified )
+{
+    if ( !files )
+        return;
+
+    TomahawkSqlQuery query = newquery();
+    query.prepare( QString( "UPDATE collection_stats SET numfiles = numfiles + ?, numartists = numartists + ?, "
+                            "numalbums = numalbums + ?, duration = duration + ?, lastmodified = max( lastmodified, ? ) "
+                            "WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+    query.addBindValue( files );
+    query.addBindValue( artists );
+    query.addBindValue( albums );
+    query.addBindValue( duration );
+    query.addBindValue( lastModified );
+    query.exec();
+}
+
+
+void
+DatabaseImpl::collectionStatsFilesRemoved( int srcid, int files, int artists, int albums, qint64 duration, int lastModified )
+{
+    if ( !files )
+        return;
+
+    TomahawkSqlQuery query = newquery();
+    query.prepare( QString( "UPDATE collection_stats SET numfiles = max( numfiles - ?, 0 ), numartists = max( numartists - ?, 0 ), "
+                            "numalbums = max( numalbums - ?, 0 ), duration = max( duration - ?, 0 ) "
+                            "WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+    query.addBindValue( files );
+    query.addBindValue( artists );
+    query.addBindValue( albums );
+    query.addBindValue( duration );
+    query.exec();
+
+    // only when we removed the newest file we have to look for the new maximum
+    query.exec( QString( "SELECT lastmodified FROM collection_stats WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+    if ( query.next() && lastModified >= query.value( 0 ).toInt() )
+    {
+        query.exec( QString( "UPDATE collection_stats SET lastmodified = "
+                             "coalesce( ( SELECT max(mtime) FROM file WHERE source %1 ), 0 ) "
+                             "WHERE source %1" ).arg( sourceCondition( srcid ) ) );
+    }
+}
+
+
+QStringList
+DatabaseImpl::playlistRevisionEntries( const QString& revguid, bool* found, int* depth )
+{
+    if ( found )
+        *found = false;
+    if ( depth )
+        *depth = 0;
+
+    // walk back to the last checkpoint, collecting the deltas on the way
+    QList< QVariantList > deltas;
+    QStringList entries;
+    QString guid = revguid;
+    QJson::Parser parser;
+
+    TomahawkSqlQuery query = newquery();
+    query.prepare( "SELECT entries, previous_revision FROM playlist_revision WHERE guid = ?" );
+
+    while ( !guid.isEmpty() )
+    {
+        query.bindValue( 0, guid );
+        query.exec();
+        if ( !query.next() )
+        {
+            tLog() << "Missing playlist revision" << guid << "while loading" << revguid;
+            return QStringList();
+        }
+
+        bool ok;
+        QVariant v = parser.parse( query.value( 0 ).toByteArray(), &ok );
+        if ( ok && v.type() == QVariant::Map && ( v.toMap().contains( "broken" ) || v.toMap().contains( "pending" ) ) )
+        {
+            tLog() << "Playlist revision" << guid << "has an unusable delta, while loading" << revguid;
+            return QStringList();
+        }
+
+        if ( ok && v.type() == QVariant::Map && v.toMap().contains( "delta" ) )
+        {
+            deltas.prepend( v.toMap().value( "delta" ).toList() );
+            guid = query.value( 1 ).toString();
+            continue;
+        }
+
+        Q_ASSERT( ok && v.type() == QVariant::List ); //TODO
+        entries = v.toStringList();
+        break;
+    }
+
+    foreach ( const QVariantList& delta, deltas )
+        entries = applyPlaylistEntriesDelta( entries, delta );
+
+    if ( found )
+        *found = true;
+    if ( depth )
+        *depth = deltas.count();
+
+    return entries;
+}
+
+
+bool
+DatabaseImpl::playlistRevisionPending( const QString& revguid, const QString& since )
+{
+    QString guid = revguid;
+    QJson::Parser parser;
+
+    TomahawkSqlQuery query = newquery();
+    query.prepare( "SELECT entries, previous_revision FROM playlist_revision WHERE guid = ?" );
+
+    while ( !guid.isEmpty() && guid != since )
+    {
+        query.bindValue( 0, guid );
+        query.exec();
+        if ( !query.next() )
+            return true; // the base of the pending ones, which we never got
+
+        bool ok;
+        const QVariant v = parser.parse( query.value( 0 ).toByteArray(), &ok );
+        if ( !ok || v.type() != QVariant::Map || !v.toMap().contains( "pending" ) )
+            return false;
+
+        // pending revisions with a missing base keep it in the entries, not in previous_revision
+        guid = v.toMap().value( "base", query.value( 1 ) ).toString();
+    }
+
+    return guid == since;
+}
+
+
+QString
+DatabaseImpl::resolvePendingPlaylistRevisions( const QString& playlistguid, const QString& revguid, const QStringList& entries )
+{
+    QString resolved;
+    QString guid = revguid;
+    QStringList current = entries;
+    QJson::Parser parser;
+    QJson::Serializer ser;
+
+    TomahawkSqlQuery query = newquery();
+    query.prepare( "SELECT guid, entries, previous_revision FROM playlist_revision "
+                   "WHERE playlist = ? AND ( previous_revision = ? OR previous_revision IS NULL )" );
+    TomahawkSqlQuery update = newquery();
+    update.prepare( "UPDATE playlist_revision SET entries = ?, previous_revision = ? WHERE guid = ?" );
+
+    while ( !guid.isEmpty() )
+    {
+        query.bindValue( 0, playlistguid );
+        query.bindValue( 1, guid );
+        query.exec();
+
+        QList< QPair< QString, QVariantMap > > pending;
+        while ( query.next() )
+        {
+            bool ok;
+            QVariantMap m = parser.parse( query.value( 1 ).toByteArray(), &ok ).toMap();
+            if ( !ok || !m.contains( "pending" ) || m.contains( "broken" ) )
+                continue;
+            if ( m.value( "base", query.value( 2 ) ).toString() != guid )
+                continue;
+
+            pending << qMakePair( query.value( 0 ).toString(), m );
+        }
+
+        QString next;
+        QStringList nextEntries;
+        for ( int i = 0; i < pending.count(); i++ )
+        {
+            const QString child = pending.at( i ).first;
+            QVariantMap m = pending.at( i ).second;
+            m.remove( "base" );
+
+            bool deltaOk;
+            const QStringList childEntries = applyPlaylistEntriesDelta( current, m.value( "delta" ).toList(), &deltaOk );
+            if ( !deltaOk )
+            {
+                tLog() << "Pending playlist revision" << child << "doesn't fit its base" << guid;
+                m.insert( "broken", true );
+                update.bindValue( 0, ser.serialize( m ) );
+                update.bindValue( 1, guid );
+                update.bindValue( 2, child );
+                update.exec();
+                continue;
+            }
+
+            // a checkpoint, so loading it doesn't depend on how deep the chain got
+            tDebug() << "Resolved pending playlist revision" << child << "of playlist" << playlistguid;
+            QVariantList checkpoint;
+            foreach ( const QString& entry, childEntries )
+                checkpoint << entry;
+            update.bindValue( 0, ser.serialize( checkpoint ) );
+            update.bindValue( 1, guid );
+            update.bindValue( 2, child );
+            update.exec();
+
+            // a sender only has one current revision, so there's only one chain to follow
+            next = child;
+            nextEntries = childEntries;
+        }
+
+        if ( next.isEmpty() )
+            break;
+
+        resolved = next;
+        guid = next;
+        current = nextEntries;
+    }
+
+    return resolved;
+}
+
+
+QVariantList
+DatabaseImpl::playlistEntriesDelta( const QStringList& from, const QStringList& to )
+{
+    QHash< QString, int > fromPos;
+    for ( int i = 0; i < from.count(); i++ )
+        fromPos.insert( from.at( i ), i );
+
+    QVariantList delta;
+    int i = 0;
+    while ( i < to.count() )
+    {
+        const int start = fromPos.value( to.at( i ), -1 );
+        if ( start < 0 )
+        {
+            delta << to.at( i );
+            i++;
+            continue;
+        }
+
+        int count = 1;
+        while ( i + count < to.count() && start + count < from.count() && from.at( start + count ) == to.at( i + count ) )
+            count++;
+
+        QVariantList run;
+        run << start << count;
+        delta << QVariant( run );
+        i += count;
+    }
+
+    return delta;
+}
+
+
+QStringList
+DatabaseImpl::applyPlaylistEntriesDelta( const QStringList& from, const QVariantList& delta, bool* ok )
+{
+    if ( ok )
+        *ok = true;
+
+    QStringList to;
+    foreach ( const QVariant& v, delta )
+    {
+        if ( v.type() != QVariant::List )
+        {
+            to << v.toString();
+            continue;
+        }
+
+        const QVariantList run = v.toList();
+        const int start = run.value( 0 ).toInt();
+        const int count = run.value( 1 ).toInt();
+        if ( run.count() != 2 || start < 0 || count < 0 || start + count > from.count() )
+        {
+            tLog() << "Invalid playlist revision delta run:" << run << "base size:" << from.count();
+            if ( ok )
+                *ok = false;
+            continue;
+        }
+
+        to << from.mid( start, count );
+    }
+
+    return to;
+}
+
+
 QVariantMap
 DatabaseImpl::artist( int id )
 {
@@ -546,7 +1049,13 @@ DatabaseImpl::album( int id )
 Tomahawk::result_ptr
 DatabaseImpl::resultFromHint( const Tomahawk::query_ptr& origquery )
 {
-    QString url = origquery->resultHint();
+    return resultFromUrl( origquery->resultHint() );
+}
+
+
+Tomahawk::result_ptr
+DatabaseImpl::resultFromUrl( const QString& url )
+{
     TomahawkSqlQuery query = newquery();
     Tomahawk::source_ptr s;
     Tomahawk::result_ptr res;
@@ -664,6 +1173,62 @@ DatabaseImpl::resultFromHint( const Tomahawk::query_ptr& origquery )
 }
 
 
+Tomahawk::result_ptr
+DatabaseImpl::resultFromCache( const Tomahawk::query_ptr& origquery )
+{
+    Tomahawk::result_ptr res;
+
+    TomahawkSqlQuery query = newquery();
+    // a collection result only counts while its file is still there
+    query.prepare( "SELECT resolve_cache.url, resolve_cache.source, resolve_cache.file, resolver, score, resolve_cache.duration "
+                   "FROM resolve_cache LEFT JOIN file ON file.id = resolve_cache.file "
+                   "WHERE artist = ? AND track = ? AND album = ? AND expires > ? "
+                   "AND ( resolve_cache.file IS NULL OR file.id IS NOT NULL )" );
+    query.addBindValue( origquery->artistSortname() );
+    query.addBindValue( origquery->trackSortname() );
+    query.addBindValue( origquery->albumSortname() );
+    query.addBindValue( QDateTime::currentDateTime().toTime_t() );
+    query.exec();
+
+    if ( !query.next() )
+        return res;
+
+    QString url = query.value( 0 ).toString();
+    if ( !query.value( 2 ).isNull() )
+    {
+        // a file from a collection, the file table knows the rest
+        if ( !query.value( 1 ).isNull() )
+        {
+            Tomahawk::source_ptr s = SourceList::instance()->get( query.value( 1 ).toUInt() );
+            if ( s.isNull() )
+                return res;
+
+            url = QString( "servent://%1\t%2" ).arg( s->userName() ).arg( url );
+        }
+
+        return resultFromUrl( url );
+    }
+
+    bool cached = Tomahawk::Result::isCached( url );
+    res = Tomahawk::Result::get( url );
+    if ( cached )
+        return res;
+
+    Tomahawk::artist_ptr artist = Tomahawk::Artist::get( artistId( origquery->artist(), false ), origquery->artist() );
+    Tomahawk::album_ptr album = Tomahawk::Album::get( albumId( artist->id(), origquery->album(), false ), origquery->album(), artist );
+
+    res->setArtist( artist );
+    res->setAlbum( album );
+    res->setTrack( origquery->track() );
+    res->setDuration( query.value( 5 ).toUInt() );
+    res->setFriendlySource( query.value( 3 ).toString() );
+    res->setScore( query.value( 4 ).toFloat() );
+    res->setRID( uuid() );
+
+    return res;
+}
+
+
 bool
 DatabaseImpl::openDatabase( const QString& dbname )
 {
@@ -29,15 +29,20 @@
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QHash>
+#include <QSet>
 #include <QThread>
+#include <QReadWriteLock>
+#include <QAtomicInt>
 
 #include "tomahawksqlquery.h"
 #include "fuzzyindex.h"
 #include "typedefs.h"
 
+#include "dllmacro.h"
+
 class Database;
 
-class DatabaseImpl : public QObject
+class DLLEXPORT DatabaseImpl : public QObject
 {
 Q_OBJECT
 
@@ -49,6 +54,8 @@ public:
     ~DatabaseImpl();
 
     bool openDatabase( const QString& dbname );
+    // hands this and the search index to the main thread, after opening elsewhere
+    void moveToMainThread();
 
     TomahawkSqlQuery newquery() { return TomahawkSqlQuery( m_db ); }
     QSqlDatabase& database() { return m_db; }
@@ -61,13 +68,17 @@ public:
     QList< QPair<int, float> > searchAlbum( const Tomahawk::query_ptr& query, uint limit = 0 );
     QList< int > getTrackFids( int tid );
 
-    static QString sortname( const QString& str, bool replaceArticle = false );
+    // lowercased, trimmed, whitespace runs collapsed, optionally without a leading "the " and diacritics
+    static QString sortname( const QString& str, bool replaceArticle = false, bool stripDiacritics = false );
 
     QVariantMap artist( int id );
     QVariantMap album( int id );
     QVariantMap track( int id );
     Tomahawk::result_ptr file( int fid );
     Tomahawk::result_ptr resultFromHint( const Tomahawk::query_ptr& query );
+    Tomahawk::result_ptr resultFromUrl( const QString& url );
+    // the result remembered in resolve_cache for query, if it hasn't expired yet
+    Tomahawk::result_ptr resultFromCache( const Tomahawk::query_ptr& query );
 
     static bool scorepairSorter( const QPair<int,float>& left, const QPair<int,float>& right )
     {
@@ -76,6 +87,46 @@ public:
 
     QString dbid() const { return m_dbid; }
 
+    // maintenance of the materialized collection_stats counters, srcid 0 is the local source.
+    // ensure, recalc and clear must be called from within the transaction of the command
+    // changing the file table. What a command counted in there gets applied with
+    // collectionStatsFilesAdded / Removed once its transaction is committed.
+    void ensureCollectionStats( int srcid );
+    void recalcCollectionStats( int srcid );
+    // for when all files of the source are gone, no need to count anything
+    void clearCollectionStats( int srcid );
+    // how many of artists / albums have files of the source other than exceptFiles, in one query
+    void countCollectionStatsReferences( int srcid, const QSet< int >& artists, const QSet< int >& albums,
+                                         const QList< unsigned int >& exceptFiles, int* artistCount, int* albumCount );
+    void collectionStatsFilesAdded( int srcid, int files, int artists, int albums, qint64 duration, int lastModified );
+    void collectionStatsFilesRemoved( int srcid, int files, int artists, int albums, qint64 duration, int lastModified );
+
+    // hands out ids for new file rows ahead of the insert, so an AddFiles op can be
+    // serialised when it gets enqueued. every file insert has to use these. the ids
+    // come from a counter that is set up when the database is opened, so this is
+    // safe from any thread and two callers never get the same ids.
+    int reserveFileIds( int count );
+
+    // playlist_revision.entries is either a full list of entry guids (a checkpoint),
+    // or a delta against previous_revision. this resolves the chain to the full list.
+    QStringList playlistRevisionEntries( const QString& revguid, bool* found = 0, int* depth = 0 );
+    // a delta that came in before the revision it is based on is stored as pending.
+    // true if revguid and the revisions before it, back to since, are pending or missing
+    bool playlistRevisionPending( const QString& revguid, const QString& since );
+    // turns the pending deltas based on revguid, and the ones based on those, into checkpoints.
+    // returns the newest revision that got resolved, or an empty string
+    QString resolvePendingPlaylistRevisions( const QString& playlistguid, const QString& revguid, const QStringList& entries );
+
+    // a delta is a list of runs copied from the old list ([start, count]) and inserted guids
+    static QVariantList playlistEntriesDelta( const QStringList& from, const QStringList& to );
+    static QStringList applyPlaylistEntriesDelta( const QStringList& from, const QVariantList& delta, bool* ok = 0 );
+
+    // ids of the remote sources that are currently online, kept up to date by Source.
+    // resolving only looks at files of these (and the local source), safe to use from any thread.
+    void setSourceOnline( int srcid, bool online );
+    // a WHERE clause fragment restricting the file table to online sources
+    QString onlineSourcesFilter() const;
+
     void loadIndex();
 
 signals:
@@ -97,6 +148,12 @@ private:
 
     QString m_dbid;
     FuzzyIndex* m_fuzzyIndex;
+
+    // first file id not handed out yet, 0 until the first reservation
+    QAtomicInt m_nextFileId;
+
+    mutable QReadWriteLock m_onlineLock;
+    QSet< int > m_onlineSources;
 };
 
 #endif // DATABASEIMPL_H
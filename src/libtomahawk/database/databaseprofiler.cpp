@@ -0,0 +1,194 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "databaseprofiler.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThreadStorage>
+
+#include <climits>
+
+static QThreadStorage< int* > s_rowCount;
+
+
+DatabaseCommandProfile::DatabaseCommandProfile( const QString& commandname )
+    : m_commandname( commandname )
+{
+}
+
+
+int
+DatabaseCommandProfile::bucket( int ms )
+{
+    int b = 0;
+    while ( ms > 0 && b < DATABASEPROFILER_BUCKETS - 1 )
+    {
+        ms >>= 1;
+        b++;
+    }
+
+    return b;
+}
+
+
+void
+DatabaseCommandProfile::record( Metric metric, qint64 elapsed )
+{
+    const int ms = (int)qBound( (qint64)0, elapsed, (qint64)INT_MAX );
+
+    m_count[metric].fetchAndAddRelaxed( 1 );
+    m_total[metric].fetchAndAddRelaxed( ms );
+    m_histogram[metric][bucket( ms )].fetchAndAddRelaxed( 1 );
+
+    int max = m_max[metric];
+    while ( ms > max && !m_max[metric].testAndSetRelaxed( max, ms ) )
+        max = m_max[metric];
+}
+
+
+int
+DatabaseCommandProfile::percentile( Metric metric, int percent ) const
+{
+    const int total = m_count[metric];
+    if ( !total )
+        return 0;
+
+    const qint64 wanted = ( (qint64)total * percent + 99 ) / 100;
+    qint64 seen = 0;
+    for ( int i = 0; i < DATABASEPROFILER_BUCKETS - 1; i++ )
+    {
+        seen += m_histogram[metric][i];
+        if ( seen >= wanted )
+            return ( 1 << i ) - 1;
+    }
+
+    return m_max[metric];
+}
+
+
+QString
+DatabaseCommandProfile::metricName( Metric metric )
+{
+    switch ( metric )
+    {
+        case QueueWait:
+            return "queue";
+        case Exec:
+            return "exec";
+        case Commit:
+            return "commit";
+    }
+
+    return QString();
+}
+
+
+DatabaseProfiler::DatabaseProfiler( const QString& name )
+    : m_name( name )
+{
+}
+
+
+DatabaseProfiler::~DatabaseProfiler()
+{
+    QMutexLocker lock( &m_mutex );
+    qDeleteAll( m_profiles );
+}
+
+
+DatabaseCommandProfile*
+DatabaseProfiler::profile( const QString& commandname )
+{
+    // Only the owning thread ever inserts, so it can look up without locking.
+    DatabaseCommandProfile* p = m_profiles.value( commandname );
+    if ( p )
+        return p;
+
+    p = new DatabaseCommandProfile( commandname );
+
+    QMutexLocker lock( &m_mutex );
+    m_profiles.insert( commandname, p );
+    return p;
+}
+
+
+QString
+DatabaseProfiler::report() const
+{
+    QMutexLocker lock( &m_mutex );
+
+    QStringList names = m_profiles.keys();
+    names.sort();
+
+    QString out = QString( "    %1:\n" ).arg( m_name );
+    if ( names.isEmpty() )
+        out.append( "      no commands run yet\n" );
+
+    foreach ( const QString& name, names )
+    {
+        const DatabaseCommandProfile* p = m_profiles.value( name );
+        out.append( QString( "      %1: count %2, rows %3\n" )
+                       .arg( name )
+                       .arg( p->count( DatabaseCommandProfile::Exec ) )
+                       .arg( p->rows() ) );
+
+        for ( int m = 0; m < DatabaseCommandProfile::MetricCount; m++ )
+        {
+            const DatabaseCommandProfile::Metric metric = (DatabaseCommandProfile::Metric)m;
+            const int count = p->count( metric );
+            if ( !count )
+                continue;
+
+            out.append( QString( "        %1: avg %2ms, p50 %3ms, p95 %4ms, p99 %5ms, max %6ms, total %7ms\n" )
+                           .arg( DatabaseCommandProfile::metricName( metric ), -6 )
+                           .arg( p->total( metric ) / count )
+                           .arg( p->percentile( metric, 50 ) )
+                           .arg( p->percentile( metric, 95 ) )
+                           .arg( p->percentile( metric, 99 ) )
+                           .arg( p->max( metric ) )
+                           .arg( p->total( metric ) ) );
+        }
+    }
+
+    return out;
+}
+
+
+void
+DatabaseProfiler::countRow()
+{
+    if ( !s_rowCount.hasLocalData() )
+        s_rowCount.setLocalData( new int( 0 ) );
+
+    (*s_rowCount.localData())++;
+}
+
+
+int
+DatabaseProfiler::takeRowCount()
+{
+    if ( !s_rowCount.hasLocalData() )
+        return 0;
+
+    int* rows = s_rowCount.localData();
+    const int count = *rows;
+    *rows = 0;
+
+    return count;
+}
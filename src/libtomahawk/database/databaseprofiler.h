@@ -0,0 +1,103 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATABASEPROFILER_H
+#define DATABASEPROFILER_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "dllmacro.h"
+
+// log2 buckets in milliseconds: 0ms, 1ms, 2-3ms, 4-7ms, ... , >= 16s
+#define DATABASEPROFILER_BUCKETS 16
+
+/*
+    Timing counters for a single DatabaseCommand::commandname() on a single
+    DatabaseWorker. Only the owning worker thread records into it, anybody
+    may read from it at any time - all counters are atomics, so neither
+    side ever takes a lock.
+*/
+class DLLEXPORT DatabaseCommandProfile
+{
+public:
+    enum Metric
+    {
+        QueueWait = 0,
+        Exec = 1,
+        Commit = 2
+    };
+    static const int MetricCount = 3;
+
+    explicit DatabaseCommandProfile( const QString& commandname );
+
+    QString commandname() const { return m_commandname; }
+
+    void record( Metric metric, qint64 ms );
+    void addRows( int rows ) { m_rows.fetchAndAddRelaxed( rows ); }
+
+    int count( Metric metric ) const { return m_count[metric]; }
+    int total( Metric metric ) const { return m_total[metric]; }
+    int max( Metric metric ) const { return m_max[metric]; }
+    int rows() const { return m_rows; }
+
+    // upper bound in ms of the bucket containing the given percentile
+    int percentile( Metric metric, int percent ) const;
+
+    static QString metricName( Metric metric );
+
+private:
+    static int bucket( int ms );
+
+    QString m_commandname;
+
+    QAtomicInt m_count[MetricCount];
+    QAtomicInt m_total[MetricCount];
+    QAtomicInt m_max[MetricCount];
+    QAtomicInt m_histogram[MetricCount][DATABASEPROFILER_BUCKETS];
+    QAtomicInt m_rows;
+};
+
+
+class DLLEXPORT DatabaseProfiler
+{
+public:
+    explicit DatabaseProfiler( const QString& name );
+    ~DatabaseProfiler();
+
+    QString name() const { return m_name; }
+
+    // must only be called from the thread owning this profiler
+    DatabaseCommandProfile* profile( const QString& commandname );
+
+    QString report() const;
+
+    // row counting for the command currently running on the calling thread
+    static void countRow();
+    static int takeRowCount();
+
+private:
+    QString m_name;
+
+    mutable QMutex m_mutex;
+    QHash< QString, DatabaseCommandProfile* > m_profiles;
+};
+
+#endif // DATABASEPROFILER_H
@@ -36,7 +36,8 @@ DatabaseResolver::DatabaseResolver( int weight )
 void
 DatabaseResolver::resolve( const Tomahawk::query_ptr& query )
 {
-    DatabaseCommand_Resolve* cmd = new DatabaseCommand_Resolve( query );
+    // taken here, so the database thread never waits for the pipeline lock
+    DatabaseCommand_Resolve* cmd = new DatabaseCommand_Resolve( query, Tomahawk::Pipeline::instance()->resolverNames() );
 
     connect( cmd, SIGNAL( results( Tomahawk::QID, QList< Tomahawk::result_ptr > ) ),
                     SLOT( gotResults( Tomahawk::QID, QList< Tomahawk::result_ptr > ) ), Qt::QueuedConnection );
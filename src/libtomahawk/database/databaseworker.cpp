@@ -20,27 +20,30 @@
 #include "databaseworker.h"
 
 #include <QTimer>
-#include <QTime>
+#include <QElapsedTimer>
 #include <QSqlQuery>
 
 #include "source.h"
 #include "database.h"
 #include "databaseimpl.h"
 #include "databasecommandloggable.h"
+#include "opcodec.h"
 #include "tomahawksqlquery.h"
 #include "utils/logger.h"
 
-#ifndef QT_NO_DEBUG
-    //#define DEBUG_TIMING TRUE
-#endif
+// limits for grouping bulk commands (e.g. peer sync ops) into one transaction
+#define DATABASEWORKER_BULK_GROUP 100
+#define DATABASEWORKER_BULK_BUDGET 20 // ms
+// bulk commands waiting longer than this get served ahead of the other lanes
+#define DATABASEWORKER_BULK_MAX_WAIT 500 // ms
 
 DatabaseWorker::DatabaseWorker( DatabaseImpl* lib, Database* db, bool mutates )
     : QThread()
     , m_dbimpl( lib )
     , m_outstanding( 0 )
+    , m_profiler( mutates ? "read-write worker" : "read-only worker" )
 {
     Q_UNUSED( db );
-    Q_UNUSED( mutates );
 
     moveToThread( this );
 
@@ -76,9 +79,17 @@ DatabaseWorker::run()
 void
 DatabaseWorker::enqueue( const QList< QSharedPointer<DatabaseCommand> >& cmds )
 {
+    foreach ( const QSharedPointer<DatabaseCommand>& cmd, cmds )
+        encodeAhead( cmd );
+
     QMutexLocker lock( &m_mut );
+    foreach ( const QSharedPointer<DatabaseCommand>& cmd, cmds )
+    {
+        cmd->setQueued();
+        append( cmd );
+    }
+
     m_outstanding += cmds.count();
-    m_commands << cmds;
 
     if ( m_outstanding == cmds.count() )
         QTimer::singleShot( 0, this, SLOT( doWork() ) );
@@ -88,9 +99,13 @@ DatabaseWorker::enqueue( const QList< QSharedPointer<DatabaseCommand> >& cmds )
 void
 DatabaseWorker::enqueue( const QSharedPointer<DatabaseCommand>& cmd )
 {
+    encodeAhead( cmd );
+
     QMutexLocker lock( &m_mut );
+    cmd->setQueued();
+
     m_outstanding++;
-    m_commands << cmd;
+    append( cmd );
 
     if ( m_outstanding == 1 )
         QTimer::singleShot( 0, this, SLOT( doWork() ) );
@@ -108,33 +123,56 @@ DatabaseWorker::doWork()
 
      */
 
-#ifdef DEBUG_TIMING
-    QTime timer;
-    timer.start();
-#endif
-
-    QList< QSharedPointer<DatabaseCommand> > cmdGroup;
-    QSharedPointer<DatabaseCommand> cmd;
+    QElapsedTimer timer;
+    QElapsedTimer groupTimer;
+    QList< QSharedPointer<DatabaseCommand> > group;
     {
         QMutexLocker lock( &m_mut );
-        cmd = m_commands.takeFirst();
+        group = takeGroup();
     }
 
+    // our own ops got serialised when they were enqueued, see encodeAhead()
+    QList< QByteArray > payloads;
+    QList< bool > compressed;
+    foreach ( const QSharedPointer<DatabaseCommand>& c, group )
+    {
+        bool comp = false;
+        QByteArray payload;
+        if ( c->loggable() )
+        {
+            DatabaseCommandLoggable* command = (DatabaseCommandLoggable*)c.data();
+            payload = command->encodedOp();
+            comp = command->encodedOpCompressed();
+        }
+
+        payloads << payload;
+        compressed << comp;
+    }
+
+    QSharedPointer<DatabaseCommand> cmd = group.first();
     if ( cmd->doesMutates() )
     {
         bool transok = m_dbimpl->database().transaction();
         Q_ASSERT( transok );
         Q_UNUSED( transok );
     }
+    groupTimer.start();
 
+    QList< QSharedPointer<DatabaseCommand> > cmdGroup;
     unsigned int completed = 0;
     try
     {
-        bool finished = false;
         {
-            while ( !finished )
+            for ( int i = 0; i < group.count(); i++ )
             {
+                cmd = group.at( i );
                 completed++;
+
+                DatabaseCommandProfile* profile = m_profiler.profile( cmd->commandname() );
+                profile->record( DatabaseCommandProfile::QueueWait, cmd->queuedFor() );
+                DatabaseProfiler::takeRowCount();
+                timer.start();
+
                 cmd->_exec( m_dbimpl ); // runs actual SQL stuff
 
                 if ( cmd->loggable() )
@@ -149,7 +187,14 @@ DatabaseWorker::doWork()
                     {
                         // save to op-log
                         DatabaseCommandLoggable* command = (DatabaseCommandLoggable*)cmd.data();
-                        logOp( command );
+                        if ( payloads.at( i ).isNull() )
+                        {
+                            bool comp = false;
+                            payloads[ i ] = encodeOp( command, &comp );
+                            compressed[ i ] = comp;
+                        }
+
+                        logOp( command, payloads.at( i ), compressed.at( i ) );
                     }
                     else
                     {
@@ -171,44 +216,41 @@ DatabaseWorker::doWork()
                     }
                 }
 
+                profile->record( DatabaseCommandProfile::Exec, timer.elapsed() );
+                profile->addRows( DatabaseProfiler::takeRowCount() );
+
                 cmdGroup << cmd;
-                if ( cmd->groupable() && !m_commands.isEmpty() )
+
+                // Anything more urgent that came in meanwhile ends the transaction. Bulk
+                // groups are also bounded in time, the next interactive command never
+                // waits for more than one of them. The rest goes back in line.
+                if ( i + 1 < group.count() )
                 {
                     QMutexLocker lock( &m_mut );
-                    if ( m_commands.first()->groupable() )
-                    {
-                        cmd = m_commands.takeFirst();
-                    }
-                    else
+                    const int next = nextPriority();
+                    if ( ( next >= 0 && next < cmd->priority() ) ||
+                         ( cmd->priority() == DatabaseCommand::BulkPriority && groupTimer.elapsed() >= DATABASEWORKER_BULK_BUDGET ) )
                     {
-                        finished = true;
+                        putBack( group.mid( i + 1 ) );
+                        break;
                     }
                 }
-                else
-                    finished = true;
             }
 
             if ( cmd->doesMutates() )
             {
                 qDebug() << "Committing" << cmd->commandname() << cmd->guid();
+                timer.start();
                 if ( !m_dbimpl->database().commit() )
                 {
                     tDebug() << "FAILED TO COMMIT TRANSACTION*";
                     throw "commit failed";
                 }
+                m_profiler.profile( cmd->commandname() )->record( DatabaseCommandProfile::Commit, timer.elapsed() );
             }
 
-#ifdef DEBUG_TIMING
-            uint duration = timer.elapsed();
-            tDebug() << "DBCmd Duration:" << duration << "ms, now running postcommit for" << cmd->commandname();
-#endif
-
             foreach ( QSharedPointer<DatabaseCommand> c, cmdGroup )
                 c->postCommit();
-
-#ifdef DEBUG_TIMING
-            tDebug() << "Post commit finished in" << timer.elapsed() - duration << "ms for" << cmd->commandname();
-#endif
         }
     }
     catch( const char * msg )
@@ -224,6 +266,13 @@ DatabaseWorker::doWork()
         if ( cmd->doesMutates() )
             m_dbimpl->database().rollback();
 
+        // the commands after the failed one didn't run, they get their own chance
+        if ( (int)completed < group.count() )
+        {
+            QMutexLocker lock( &m_mut );
+            putBack( group.mid( completed ) );
+        }
+
         Q_ASSERT( false );
     }
     catch(...)
@@ -240,38 +289,178 @@ DatabaseWorker::doWork()
         c->emitFinished();
 
     QMutexLocker lock( &m_mut );
+    for ( unsigned int i = 0; i < completed; i++ )
+        ran( group.at( i ) );
+
     m_outstanding -= completed;
     if ( m_outstanding > 0 )
         QTimer::singleShot( 0, this, SLOT( doWork() ) );
 }
 
 
-// this should take a const command, need to check/make json stuff mutable for some objs tho maybe.
+int
+DatabaseWorker::queueDepth( DatabaseCommand::Priority priority ) const
+{
+    QMutexLocker lock( &m_mut );
+    return m_commands[ priority ].count();
+}
+
+
+int
+DatabaseWorker::nextPriority() const
+{
+    for ( int i = 0; i < DatabaseCommand::PriorityCount; i++ )
+    {
+        if ( !m_commands[ i ].isEmpty() )
+            return i;
+    }
+
+    return -1;
+}
+
+
+int
+DatabaseWorker::orderedSource( const QSharedPointer<DatabaseCommand>& cmd )
+{
+    // a peer's changes have to be applied in the order it made them. our own
+    // depend on each other too (e.g. DirMtimes on the AddFiles before it), and
+    // peers replay the oplog in the order they commit. commands without a source
+    // are local ones, they share its id 0.
+    if ( !cmd->doesMutates() )
+        return -1;
+
+    if ( cmd->source().isNull() || cmd->source()->isLocal() )
+        return 0;
+
+    return cmd->source()->id();
+}
+
+
 void
-DatabaseWorker::logOp( DatabaseCommandLoggable* command )
+DatabaseWorker::append( const QSharedPointer<DatabaseCommand>& cmd )
 {
-    TomahawkSqlQuery oplogquery = m_dbimpl->newquery();
-    qDebug() << "INSERTING INTO OPTLOG:" << command->source()->id() << command->guid() << command->commandname();
-    oplogquery.prepare( "INSERT INTO oplog(source, guid, command, singleton, compressed, json) "
-                        "VALUES(?, ?, ?, ?, ?, ?)" );
+    // a mutating command must not overtake those of its source still waiting
+    // in a less urgent lane, so it joins them there
+    const int source = orderedSource( cmd );
+    if ( source >= 0 )
+    {
+        for ( int i = DatabaseCommand::PriorityCount - 1; i > cmd->priority(); i-- )
+        {
+            if ( m_pendingBySource[ i ].value( source ) > 0 )
+            {
+                cmd->setPriority( (DatabaseCommand::Priority)i );
+                break;
+            }
+        }
 
-    QVariantMap variant = QJson::QObjectHelper::qobject2qvariant( command );
-    QByteArray ba = m_serializer.serialize( variant );
+        m_pendingBySource[ cmd->priority() ][ source ]++;
+    }
+
+    m_commands[ cmd->priority() ] << cmd;
+}
+
+
+void
+DatabaseWorker::ran( const QSharedPointer<DatabaseCommand>& cmd )
+{
+    const int source = orderedSource( cmd );
+    if ( source >= 0 && --m_pendingBySource[ cmd->priority() ][ source ] <= 0 )
+        m_pendingBySource[ cmd->priority() ].remove( source );
+}
+
+
+QSharedPointer<DatabaseCommand>
+DatabaseWorker::takeNext()
+{
+    int priority = nextPriority();
+    Q_ASSERT( priority >= 0 );
+
+    // steady interactive work must not starve syncing, bulk commands that waited
+    // too long get their turn. unless their source has older commands in line.
+    const QList< QSharedPointer<DatabaseCommand> >& bulk = m_commands[ DatabaseCommand::BulkPriority ];
+    if ( priority != DatabaseCommand::BulkPriority && !bulk.isEmpty() &&
+         bulk.first()->queuedFor() > DATABASEWORKER_BULK_MAX_WAIT )
+    {
+        const int source = orderedSource( bulk.first() );
+        bool blocked = false;
+        for ( int i = 0; i < DatabaseCommand::BulkPriority && source >= 0; i++ )
+            blocked = blocked || m_pendingBySource[ i ].contains( source );
+
+        if ( !blocked )
+            priority = DatabaseCommand::BulkPriority;
+    }
+
+    return m_commands[ priority ].takeFirst();
+}
+
+
+QList< QSharedPointer<DatabaseCommand> >
+DatabaseWorker::takeGroup()
+{
+    QList< QSharedPointer<DatabaseCommand> > group;
+    group << takeNext();
 
-//     qDebug() << "OP JSON:" << ba.isNull() << ba << "from:" << variant; // debug
+    // groupable commands following in the same lane share the transaction
+    const QSharedPointer<DatabaseCommand>& first = group.first();
+    if ( !first->groupable() )
+        return group;
 
-    bool compressed = false;
-    if( ba.length() >= 512 )
+    QList< QSharedPointer<DatabaseCommand> >& lane = m_commands[ first->priority() ];
+    while ( !lane.isEmpty() && lane.first()->groupable() &&
+            ( first->priority() != DatabaseCommand::BulkPriority || group.count() < DATABASEWORKER_BULK_GROUP ) )
     {
-        // We need to compress this in this thread, since inserting into the log
-        // has to happen as part of the same transaction as the dbcmd.
-        // (we are in a worker thread for RW dbcmds anyway, so it's ok)
-        //qDebug() << "Compressing DB OP JSON, uncompressed size:" << ba.length();
-        ba = qCompress( ba, 9 );
-        compressed = true;
-        //qDebug() << "Compressed DB OP JSON size:" << ba.length();
+        group << lane.takeFirst();
     }
 
+    return group;
+}
+
+
+void
+DatabaseWorker::putBack( const QList< QSharedPointer<DatabaseCommand> >& cmds )
+{
+    for ( int i = cmds.count() - 1; i >= 0; i-- )
+        m_commands[ cmds.at( i )->priority() ].prepend( cmds.at( i ) );
+}
+
+
+void
+DatabaseWorker::encodeAhead( const QSharedPointer<DatabaseCommand>& cmd )
+{
+    // Serialise our own ops on the thread enqueueing them, so the writer only
+    // runs the SQL. Commands that log what exec() produced have to wait for it,
+    // they get serialised inside the transaction.
+    if ( !cmd->loggable() || cmd->localOnly() || cmd->source().isNull() || !cmd->source()->isLocal() )
+        return;
+
+    DatabaseCommandLoggable* command = (DatabaseCommandLoggable*)cmd.data();
+    if ( command->logsExecResults() || !command->encodedOp().isNull() )
+        return;
+
+    command->prepareOp( m_dbimpl );
+
+    bool comp = false;
+    const QByteArray payload = encodeOp( command, &comp );
+    command->setEncodedOp( payload, comp );
+}
+
+
+QByteArray
+DatabaseWorker::encodeOp( DatabaseCommandLoggable* command, bool* compressed )
+{
+    const QVariantMap variant = QJson::QObjectHelper::qobject2qvariant( command );
+    return OpCodec::encode( variant, compressed );
+}
+
+
+void
+DatabaseWorker::logOp( DatabaseCommandLoggable* command, const QByteArray& payload, bool compressed )
+{
+    TomahawkSqlQuery oplogquery = m_dbimpl->newquery();
+    qDebug() << "INSERTING INTO OPTLOG:" << command->source()->id() << command->guid() << command->commandname();
+    oplogquery.prepare( "INSERT INTO oplog(source, guid, command, singleton, compressed, json, format) "
+                        "VALUES(?, ?, ?, ?, ?, ?, ?)" );
+
     if ( command->singletonCmd() )
     {
         tDebug() << "Singleton command, deleting previous oplog commands";
@@ -285,7 +474,7 @@ DatabaseWorker::logOp( DatabaseCommandLoggable* command )
     }
 
     tDebug() << "Saving to oplog:" << command->commandname()
-             << "bytes:" << ba.length()
+             << "bytes:" << payload.length()
              << "guid:" << command->guid();
 
     oplogquery.bindValue( 0, command->source()->isLocal() ?
@@ -294,7 +483,8 @@ DatabaseWorker::logOp( DatabaseCommandLoggable* command )
     oplogquery.bindValue( 2, command->commandname() );
     oplogquery.bindValue( 3, command->singletonCmd() );
     oplogquery.bindValue( 4, compressed );
-    oplogquery.bindValue( 5, ba );
+    oplogquery.bindValue( 5, payload );
+    oplogquery.bindValue( 6, (int)OpCodec::Binary );
     if( !oplogquery.exec() )
     {
         tLog() << "Error saving to oplog";
@@ -23,6 +23,7 @@
 #include <QThread>
 #include <QMutex>
 #include <QList>
+#include <QHash>
 #include <QSharedPointer>
 
 #include <qjson/parser.h>
@@ -30,6 +31,7 @@
 #include <qjson/qobjecthelper.h>
 
 #include "databasecommand.h"
+#include "databaseprofiler.h"
 
 class Database;
 class DatabaseCommandLoggable;
@@ -44,6 +46,10 @@ public:
 
     bool busy() const { return m_outstanding > 0; }
     unsigned int outstandingJobs() const { return m_outstanding; }
+    // commands waiting in one priority lane
+    int queueDepth( DatabaseCommand::Priority priority ) const;
+
+    const DatabaseProfiler& profiler() const { return m_profiler; }
 
 public slots:
     void enqueue( const QSharedPointer<DatabaseCommand>& );
@@ -56,14 +62,35 @@ private slots:
     void doWork();
 
 private:
-    void logOp( DatabaseCommandLoggable* command );
+    // called with m_mut locked
+    int nextPriority() const;
+    void append( const QSharedPointer<DatabaseCommand>& cmd );
+    // a command that was taken has run (or failed), those after it may overtake it now
+    void ran( const QSharedPointer<DatabaseCommand>& cmd );
+    QSharedPointer<DatabaseCommand> takeNext();
+    // the next command, with the groupable ones following it in its lane
+    QList< QSharedPointer<DatabaseCommand> > takeGroup();
+    // returns taken commands that didn't run to the front of their lanes
+    void putBack( const QList< QSharedPointer<DatabaseCommand> >& cmds );
+
+    // id of the source whose commands have to stay in order (0 for our own), -1 if there is none
+    static int orderedSource( const QSharedPointer<DatabaseCommand>& cmd );
+
+    // serialises a local op for the oplog, called on the thread enqueueing it
+    void encodeAhead( const QSharedPointer<DatabaseCommand>& cmd );
+    static QByteArray encodeOp( DatabaseCommandLoggable* command, bool* compressed );
+    void logOp( DatabaseCommandLoggable* command, const QByteArray& payload, bool compressed );
 
-    QMutex m_mut;
+    mutable QMutex m_mut;
     DatabaseImpl* m_dbimpl;
-    QList< QSharedPointer<DatabaseCommand> > m_commands;
+    // one FIFO per DatabaseCommand::Priority, served from the most urgent one unless
+    // the bulk one waited too long
+    QList< QSharedPointer<DatabaseCommand> > m_commands[ DatabaseCommand::PriorityCount ];
+    // per lane, how many mutating commands of each source wait in it or run
+    QHash< int, int > m_pendingBySource[ DatabaseCommand::PriorityCount ];
     int m_outstanding;
 
-    QJson::Serializer m_serializer;
+    DatabaseProfiler m_profiler;
 };
 
 #endif // DATABASEWORKER_H
@@ -29,6 +29,7 @@ struct DBOp
     QByteArray payload;
     bool compressed;
     bool singleton;
+    int format; // OpCodec::Format
 };
 
 typedef QSharedPointer<DBOp> dbop_ptr;
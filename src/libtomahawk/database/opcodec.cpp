@@ -0,0 +1,342 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "opcodec.h"
+
+#include <QtEndian>
+
+#include <climits>
+#include <cstring>
+
+#include "utils/logger.h"
+
+#define OPCODEC_MAGIC "TOP"
+#define OPCODEC_MAGIC_SIZE 3
+// ops smaller than this are sent as they are
+#define OPCODEC_COMPRESS_THRESHOLD 512
+// favour speed, this runs on the database writer
+#define OPCODEC_COMPRESS_LEVEL 1
+// ops come from peers, don't let them nest lists and maps deep enough to exhaust the stack
+#define OPCODEC_MAX_DEPTH 32
+
+namespace
+{
+    enum Tag
+    {
+        TagNull = 0,
+        TagFalse,
+        TagTrue,
+        TagInt,
+        TagUInt,
+        TagDouble,
+        TagString,
+        TagByteArray,
+        TagList,
+        TagMap
+    };
+
+
+    void
+    writeVarint( QByteArray& out, quint64 v )
+    {
+        while ( v >= 0x80 )
+        {
+            out.append( char( ( v & 0x7f ) | 0x80 ) );
+            v >>= 7;
+        }
+        out.append( char( v ) );
+    }
+
+
+    void
+    writeBytes( QByteArray& out, const QByteArray& bytes )
+    {
+        writeVarint( out, bytes.length() );
+        out.append( bytes );
+    }
+
+
+    void
+    writeValue( QByteArray& out, const QVariant& v )
+    {
+        switch ( v.type() )
+        {
+            case QVariant::Invalid:
+                out.append( char( TagNull ) );
+                break;
+
+            case QVariant::Bool:
+                out.append( char( v.toBool() ? TagTrue : TagFalse ) );
+                break;
+
+            case QVariant::Int:
+            case QVariant::LongLong:
+            {
+                const qint64 i = v.toLongLong();
+                out.append( char( TagInt ) );
+                writeVarint( out, ( quint64( i ) << 1 ) ^ quint64( i >> 63 ) );
+                break;
+            }
+
+            case QVariant::UInt:
+            case QVariant::ULongLong:
+                out.append( char( TagUInt ) );
+                writeVarint( out, v.toULongLong() );
+                break;
+
+            case QVariant::Double:
+            {
+                const double d = v.toDouble();
+                quint64 bits;
+                memcpy( &bits, &d, sizeof( bits ) );
+
+                uchar le[ sizeof( bits ) ];
+                qToLittleEndian( bits, le );
+                out.append( char( TagDouble ) );
+                out.append( (const char*)le, sizeof( le ) );
+                break;
+            }
+
+            case QVariant::ByteArray:
+                out.append( char( TagByteArray ) );
+                writeBytes( out, v.toByteArray() );
+                break;
+
+            case QVariant::List:
+            case QVariant::StringList:
+            {
+                const QVariantList list = v.toList();
+                out.append( char( TagList ) );
+                writeVarint( out, list.count() );
+                foreach ( const QVariant& item, list )
+                    writeValue( out, item );
+                break;
+            }
+
+            case QVariant::Map:
+            {
+                const QVariantMap map = v.toMap();
+                out.append( char( TagMap ) );
+                writeVarint( out, map.count() );
+
+                QVariantMap::const_iterator it = map.constBegin();
+                for ( ; it != map.constEnd(); ++it )
+                {
+                    writeBytes( out, it.key().toUtf8() );
+                    writeValue( out, it.value() );
+                }
+                break;
+            }
+
+            default:
+                out.append( char( TagString ) );
+                writeBytes( out, v.toString().toUtf8() );
+        }
+    }
+
+
+    class Reader
+    {
+    public:
+        Reader( const QByteArray& data, int pos ) : m_data( data ), m_pos( pos ), m_depth( 0 ), m_ok( true ) {}
+
+        bool ok() const { return m_ok && m_pos == m_data.length(); }
+
+        QVariant readValue()
+        {
+            if ( !m_ok || m_pos >= m_data.length() )
+                return fail();
+
+            switch ( m_data.at( m_pos++ ) )
+            {
+                case TagNull:
+                    return QVariant();
+
+                case TagFalse:
+                    return QVariant( false );
+
+                case TagTrue:
+                    return QVariant( true );
+
+                case TagInt:
+                {
+                    const quint64 z = readVarint();
+                    const qint64 i = qint64( z >> 1 ) ^ -qint64( z & 1 );
+                    if ( i >= INT_MIN && i <= INT_MAX )
+                        return QVariant( int( i ) );
+                    return QVariant( i );
+                }
+
+                case TagUInt:
+                {
+                    const quint64 u = readVarint();
+                    if ( u <= UINT_MAX )
+                        return QVariant( uint( u ) );
+                    return QVariant( u );
+                }
+
+                case TagDouble:
+                {
+                    if ( m_pos + 8 > m_data.length() )
+                        return fail();
+
+                    const quint64 bits = qFromLittleEndian< quint64 >( (const uchar*)m_data.constData() + m_pos );
+                    m_pos += 8;
+
+                    double d;
+                    memcpy( &d, &bits, sizeof( d ) );
+                    return QVariant( d );
+                }
+
+                case TagString:
+                    return QVariant( QString::fromUtf8( readBytes() ) );
+
+                case TagByteArray:
+                    return QVariant( readBytes() );
+
+                case TagList:
+                {
+                    if ( ++m_depth > OPCODEC_MAX_DEPTH )
+                        return fail();
+
+                    const quint64 count = readVarint();
+                    QVariantList list;
+                    for ( quint64 i = 0; i < count && m_ok; i++ )
+                        list << readValue();
+
+                    m_depth--;
+                    return list;
+                }
+
+                case TagMap:
+                {
+                    if ( ++m_depth > OPCODEC_MAX_DEPTH )
+                        return fail();
+
+                    const quint64 count = readVarint();
+                    QVariantMap map;
+                    for ( quint64 i = 0; i < count && m_ok; i++ )
+                    {
+                        const QString key = QString::fromUtf8( readBytes() );
+                        map.insert( key, readValue() );
+                    }
+
+                    m_depth--;
+                    return map;
+                }
+
+                default:
+                    return fail();
+            }
+        }
+
+    private:
+        QVariant fail()
+        {
+            m_ok = false;
+            return QVariant();
+        }
+
+        quint64 readVarint()
+        {
+            quint64 v = 0;
+            for ( int shift = 0; shift < 64; shift += 7 )
+            {
+                if ( m_pos >= m_data.length() )
+                    break;
+
+                const uchar b = m_data.at( m_pos++ );
+                v |= quint64( b & 0x7f ) << shift;
+                if ( !( b & 0x80 ) )
+                    return v;
+            }
+
+            m_ok = false;
+            return 0;
+        }
+
+        QByteArray readBytes()
+        {
+            const quint64 length = readVarint();
+            if ( !m_ok || length > quint64( m_data.length() - m_pos ) )
+            {
+                m_ok = false;
+                return QByteArray();
+            }
+
+            const QByteArray bytes = m_data.mid( m_pos, length );
+            m_pos += length;
+            return bytes;
+        }
+
+        const QByteArray& m_data;
+        int m_pos;
+        // lists and maps we are in
+        int m_depth;
+        bool m_ok;
+    };
+}
+
+
+QByteArray
+OpCodec::encode( const QVariant& op, bool* compressed )
+{
+    QByteArray ba( OPCODEC_MAGIC );
+    ba.append( char( version ) );
+    writeValue( ba, op );
+
+    *compressed = false;
+    if ( ba.length() >= OPCODEC_COMPRESS_THRESHOLD )
+    {
+        QByteArray packed = qCompress( ba, OPCODEC_COMPRESS_LEVEL );
+        if ( packed.length() < ba.length() )
+        {
+            ba = packed;
+            *compressed = true;
+        }
+    }
+
+    return ba;
+}
+
+
+QVariant
+OpCodec::decode( const QByteArray& data )
+{
+    if ( data.length() <= OPCODEC_MAGIC_SIZE || !data.startsWith( OPCODEC_MAGIC ) )
+    {
+        tLog() << "Not a binary op";
+        return QVariant();
+    }
+
+    if ( quint8( data.at( OPCODEC_MAGIC_SIZE ) ) > version )
+    {
+        tLog() << "Binary op of unknown version" << quint8( data.at( OPCODEC_MAGIC_SIZE ) );
+        return QVariant();
+    }
+
+    Reader reader( data, OPCODEC_MAGIC_SIZE + 1 );
+    const QVariant v = reader.readValue();
+    if ( !reader.ok() )
+    {
+        tLog() << "Malformed binary op";
+        return QVariant();
+    }
+
+    return v;
+}
@@ -0,0 +1,59 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPCODEC_H
+#define OPCODEC_H
+
+#include <QByteArray>
+#include <QVariant>
+
+#include "dllmacro.h"
+
+/*
+    Compact binary encoding for the properties of loggable database commands,
+    as stored in the oplog and sent to peers. Much cheaper to write and read
+    than JSON: values are tagged, integers are varints and strings UTF-8.
+
+    Version 1 layout: "TOP" + version byte, followed by one value:
+      tag (1 byte) and
+        Null, False, True: nothing
+        Int: zigzag varint, UInt: varint, Double: 8 bytes little endian
+        String, ByteArray: varint length + bytes (strings in UTF-8)
+        List: varint count + values
+        Map: varint count + (varint length + UTF-8 key, value) pairs
+    Any other type gets stored as its string representation.
+*/
+class DLLEXPORT OpCodec
+{
+public:
+    // value of oplog.format
+    enum Format
+    {
+        Json = 0,
+        Binary = 1
+    };
+
+    static const quint8 version = 1;
+
+    // compresses the result when that pays off, and tells whether it did
+    static QByteArray encode( const QVariant& op, bool* compressed );
+    // expects uncompressed data, returns an invalid QVariant on malformed or too deeply nested input
+    static QVariant decode( const QByteArray& data );
+};
+
+#endif // OPCODEC_H
@@ -9,7 +9,8 @@ CREATE TABLE IF NOT EXISTS oplog (
     command TEXT NOT NULL,
     singleton BOOLEAN NOT NULL,
     compressed BOOLEAN NOT NULL,
-    json TEXT NOT NULL
+    json TEXT NOT NULL,
+    format INTEGER NOT NULL DEFAULT 0 -- 0: json, 1: binary
 );
 CREATE UNIQUE INDEX oplog_guid ON oplog(guid);
 CREATE INDEX oplog_source ON oplog(source);
@@ -184,6 +185,42 @@ CREATE INDEX file_join_track  ON file_join(track);
 CREATE INDEX file_join_artist ON file_join(artist);
 CREATE INDEX file_join_album  ON file_join(album);
 
+-- per-source collection counters, kept up to date by the commands that
+-- add or remove files, so we never have to count the file table.
+-- if source=null, these are the stats of the local collection
+CREATE TABLE IF NOT EXISTS collection_stats (
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    numfiles INTEGER NOT NULL DEFAULT 0,
+    numartists INTEGER NOT NULL DEFAULT 0,
+    numalbums INTEGER NOT NULL DEFAULT 0,
+    duration INTEGER NOT NULL DEFAULT 0,     -- seconds
+    lastmodified INTEGER NOT NULL DEFAULT 0  -- max(file.mtime)
+);
+CREATE UNIQUE INDEX collection_stats_source ON collection_stats(source);
+
+
+
+-- winning resolve results, so known queries don't need the whole pipeline
+-- again on the next start. keyed by the sortnames of the query.
+-- source and file are set for results from a collection (source=null: local),
+-- and are null for results of script resolvers.
+CREATE TABLE IF NOT EXISTS resolve_cache (
+    artist TEXT NOT NULL,
+    track TEXT NOT NULL,
+    album TEXT NOT NULL,
+    url TEXT NOT NULL,                  -- file.url for collection results
+    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    file INTEGER REFERENCES file(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,
+    resolver TEXT NOT NULL,             -- friendly source of the result
+    score REAL NOT NULL,
+    duration INTEGER NOT NULL DEFAULT 0,
+    expires INTEGER NOT NULL            -- timestamp
+);
+CREATE UNIQUE INDEX resolve_cache_key ON resolve_cache(artist, track, album);
+CREATE INDEX resolve_cache_source ON resolve_cache(source);
+CREATE INDEX resolve_cache_file ON resolve_cache(file);
+CREATE INDEX resolve_cache_expires ON resolve_cache(expires);
+
 
 
 -- tags, weighted and by source (rock, jazz etc)
@@ -295,4 +332,4 @@ CREATE TABLE IF NOT EXISTS settings (
     v TEXT NOT NULL DEFAULT ''
 );
 
-INSERT INTO settings(k,v) VALUES('schema_version', '28');
+INSERT INTO settings(k,v) VALUES('schema_version', '31');
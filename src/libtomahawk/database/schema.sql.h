@@ -1,5 +1,5 @@
 /*
-    This file was automatically generated from ./schema.sql on Fri Nov 18 14:00:37 CET 2011.
+    This file was automatically generated from ./schema.sql on Mon Oct 19 15:51:04 UTC 2026.
 */
 
 static const char * tomahawk_schema_sql = 
@@ -10,7 +10,8 @@ static const char * tomahawk_schema_sql =
 "    command TEXT NOT NULL,"
 "    singleton BOOLEAN NOT NULL,"
 "    compressed BOOLEAN NOT NULL,"
-"    json TEXT NOT NULL"
+"    json TEXT NOT NULL,"
+"    format INTEGER NOT NULL DEFAULT 0 "
 ");"
 "CREATE UNIQUE INDEX oplog_guid ON oplog(guid);"
 "CREATE INDEX oplog_source ON oplog(source);"
@@ -107,6 +108,7 @@ static const char * tomahawk_schema_sql =
 ");"
 "CREATE UNIQUE INDEX file_url_src_uniq ON file(source, url);"
 "CREATE INDEX file_source ON file(source);"
+"CREATE INDEX file_mtime ON file(mtime);"
 "CREATE TABLE IF NOT EXISTS dirs_scanned ("
 "    name TEXT PRIMARY KEY,"
 "    mtime INTEGER NOT NULL"
@@ -123,6 +125,31 @@ static const char * tomahawk_schema_sql =
 "CREATE INDEX file_join_track  ON file_join(track);"
 "CREATE INDEX file_join_artist ON file_join(artist);"
 "CREATE INDEX file_join_album  ON file_join(album);"
+"CREATE TABLE IF NOT EXISTS collection_stats ("
+"    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    numfiles INTEGER NOT NULL DEFAULT 0,"
+"    numartists INTEGER NOT NULL DEFAULT 0,"
+"    numalbums INTEGER NOT NULL DEFAULT 0,"
+"    duration INTEGER NOT NULL DEFAULT 0,     "
+"    lastmodified INTEGER NOT NULL DEFAULT 0  "
+");"
+"CREATE UNIQUE INDEX collection_stats_source ON collection_stats(source);"
+"CREATE TABLE IF NOT EXISTS resolve_cache ("
+"    artist TEXT NOT NULL,"
+"    track TEXT NOT NULL,"
+"    album TEXT NOT NULL,"
+"    url TEXT NOT NULL,                  "
+"    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    file INTEGER REFERENCES file(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
+"    resolver TEXT NOT NULL,             "
+"    score REAL NOT NULL,"
+"    duration INTEGER NOT NULL DEFAULT 0,"
+"    expires INTEGER NOT NULL            "
+");"
+"CREATE UNIQUE INDEX resolve_cache_key ON resolve_cache(artist, track, album);"
+"CREATE INDEX resolve_cache_source ON resolve_cache(source);"
+"CREATE INDEX resolve_cache_file ON resolve_cache(file);"
+"CREATE INDEX resolve_cache_expires ON resolve_cache(expires);"
 "CREATE TABLE IF NOT EXISTS track_tags ("
 "    id INTEGER PRIMARY KEY,   "
 "    source INTEGER REFERENCES source(id) ON DELETE CASCADE ON UPDATE CASCADE DEFERRABLE INITIALLY DEFERRED,"
@@ -191,7 +218,7 @@ static const char * tomahawk_schema_sql =
 "    k TEXT NOT NULL PRIMARY KEY,"
 "    v TEXT NOT NULL DEFAULT ''"
 ");"
-"INSERT INTO settings(k,v) VALUES('schema_version', '28');"
+"INSERT INTO settings(k,v) VALUES('schema_version', '31');"
     ;
 
 const char * get_tomahawk_sql()
@@ -24,6 +24,7 @@
 #include <QSqlError>
 #include <QTime>
 
+#include "databaseprofiler.h"
 #include "utils/logger.h"
 
 #define TOMAHAWK_QUERY_THRESHOLD 60
@@ -64,6 +65,15 @@ public:
         return ret;
     }
 
+    bool next()
+    {
+        bool ret = QSqlQuery::next();
+        if ( ret )
+            DatabaseProfiler::countRow();
+
+        return ret;
+    }
+
 private:
     void showError()
     {
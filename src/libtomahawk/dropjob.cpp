@@ -31,6 +31,7 @@
 #include "utils/shortenedlinkparser.h"
 #include "utils/logger.h"
 #include "utils/tomahawkutils.h"
+#include "utils/deduplicator.h"
 #include "globalactionmanager.h"
 #include "infosystem/infosystem.h"
 #include "utils/xspfloader.h"
@@ -47,7 +48,6 @@
 using namespace Tomahawk;
 
 bool DropJob::s_canParseSpotifyPlaylists = false;
-static QString s_dropJobInfoId = "dropjob";
 
 DropJob::DropJob( QObject *parent )
     : QObject( parent )
@@ -58,6 +58,7 @@ DropJob::DropJob( QObject *parent )
     , m_top10( false )
     , m_dropAction( Default )
     , m_dropJob( 0 )
+    , m_infoId( uuid() )
 {
 }
 
@@ -760,24 +761,21 @@ void
 DropJob::removeDuplicates()
 {
     QList< Tomahawk::query_ptr > list;
+    Deduplicator dupes;
+
     foreach ( const Tomahawk::query_ptr& item, m_resultList )
     {
-        bool contains = false;
-        foreach( const Tomahawk::query_ptr &tmpItem, list )
+        const QString key = Deduplicator::key( item->artist(), item->album(), item->track() );
+        const int i = dupes.indexOf( key, item->albumpos() );
+        if ( i < 0 )
         {
-            if ( item->album() == tmpItem->album()
-                 && item->artist() == tmpItem->artist()
-                 && item->track() == tmpItem->track() )
-            {
-                if ( item->playable() && !tmpItem->playable() )
-                    list.replace( list.indexOf( tmpItem ), item );
-
-                contains = true;
-                break;
-            }
-        }
-        if ( !contains )
+            dupes.insert( key, item->albumpos(), list.count() );
             list.append( item );
+        }
+        else if ( item->playable() && !list.at( i )->playable() )
+        {
+            list.replace( i, item );
+        }
     }
 
     m_resultList = list;
@@ -806,7 +804,7 @@ DropJob::removeRemoteSources()
 void
 DropJob::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output )
 {
-    if ( requestData.caller == s_dropJobInfoId )
+    if ( requestData.caller == m_infoId )
     {
         const Tomahawk::InfoSystem::InfoStringHash info = requestData.input.value< Tomahawk::InfoSystem::InfoStringHash >();
 
@@ -886,21 +884,17 @@ DropJob::getAlbum(const QString &artist, const QString &album)
 void
 DropJob::getTopTen( const QString &artist )
 {
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
     Tomahawk::InfoSystem::InfoStringHash artistInfo;
     artistInfo["artist"] = artist;
 
     Tomahawk::InfoSystem::InfoRequestData requestData;
-    requestData.caller = s_dropJobInfoId;
+    requestData.caller = m_infoId;
     requestData.customData = QVariantMap();
 
     requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( artistInfo );
 
     requestData.type = Tomahawk::InfoSystem::InfoArtistSongs;
-    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
 
     m_queryCount++;
 }
@@ -909,22 +903,18 @@ DropJob::getTopTen( const QString &artist )
 void
 DropJob::getAlbumFromInfoystem( const QString& artist, const QString& album )
 {
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
     Tomahawk::InfoSystem::InfoStringHash artistInfo;
     artistInfo["artist"] = artist;
     artistInfo["album"] = album;
 
     Tomahawk::InfoSystem::InfoRequestData requestData;
-    requestData.caller = s_dropJobInfoId;
+    requestData.caller = m_infoId;
     requestData.customData = QVariantMap();
 
     requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( artistInfo );
 
     requestData.type = Tomahawk::InfoSystem::InfoAlbumSongs;
-    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
 
     m_queryCount++;
 }
@@ -152,6 +152,8 @@ private:
     DropAction m_dropAction;
 
     Tomahawk::DropJobNotifier* m_dropJob;
+    // caller of our InfoSystem requests, so the replies reach this job only
+    QString m_infoId;
 
     QList< Tomahawk::query_ptr > m_resultList;
     QSet< Tomahawk::album_ptr > m_albumsToKeep;
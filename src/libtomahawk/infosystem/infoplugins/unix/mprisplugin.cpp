@@ -75,16 +75,6 @@ MprisPlugin::MprisPlugin()
     // Connect to AudioEngine's seeked signal
     connect( AudioEngine::instance(), SIGNAL( seeked( qint64 ) ),
                                         SLOT( onSeeked( qint64 ) ) );
-
-    // Connect to the InfoSystem (we need to get album covers via getInfo)
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( finished( QString ) ),
-             SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -292,7 +282,7 @@ MprisPlugin::metadata() const
             requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( trackInfo );
             requestData.customData = QVariantMap();
 
-            Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+            Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
         }
     }
 
@@ -19,6 +19,7 @@
  */
 
 #include <QCoreApplication>
+#include <QDateTime>
 
 #include "infosystem.h"
 #include "tomahawksettings.h"
@@ -35,6 +36,7 @@ namespace InfoSystem
 
 InfoPlugin::InfoPlugin()
     : QObject()
+    , m_maxConcurrentRequests( INFOPLUGIN_MAX_CONCURRENT_REQUESTS )
 {
 }
 
@@ -70,6 +72,10 @@ InfoSystem::InfoSystem( QObject *parent )
     m_infoSystemWorkerThreadController = new InfoSystemWorkerThread( this );
     m_infoSystemWorkerThreadController->start();
 
+    m_checkReceiversTimer.setInterval( 60 * 1000 );
+    connect( &m_checkReceiversTimer, SIGNAL( timeout() ), SLOT( checkReceiversTimerFired() ) );
+    m_checkReceiversTimer.start();
+
     QTimer::singleShot( 0, this, SLOT( init() ) );
 }
 
@@ -121,9 +127,9 @@ InfoSystem::init()
              worker, SLOT( infoSlot( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ), Qt::UniqueConnection );
 
     connect( worker, SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             this,       SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ), Qt::UniqueConnection );
+             this,       SLOT( infoSlot( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ), Qt::UniqueConnection );
 
-    connect( worker, SIGNAL( finished( QString ) ), this, SIGNAL( finished( QString ) ), Qt::UniqueConnection );
+    connect( worker, SIGNAL( finished( QString ) ), this, SLOT( finishedSlot( QString ) ), Qt::UniqueConnection );
 
     connect( worker, SIGNAL( finished( QString, Tomahawk::InfoSystem::InfoType ) ),
              this, SIGNAL( finished( QString, Tomahawk::InfoSystem::InfoType ) ), Qt::UniqueConnection );
@@ -148,6 +154,129 @@ InfoSystem::getInfo( const InfoRequestData &requestData )
 }
 
 
+bool
+InfoSystem::getInfo( const InfoRequestData &requestData, QObject *receiver )
+{
+    // register before sending the request off, so the reply can't overtake us
+    {
+        QMutexLocker lock( &m_receiversMutex );
+        Receiver& r = m_receivers[ requestData.caller ];
+        if ( r.object != receiver )
+        {
+            r.object = receiver;
+            r.timeout = 0;
+        }
+
+        if ( !requestData.timeoutMillis )
+            r.timeout = -1;
+        else if ( r.timeout >= 0 )
+            r.timeout = qMax< qint64 >( r.timeout, requestData.timeoutMillis + INFOSYSTEM_RECEIVER_GRACE );
+
+        r.expires = QDateTime::currentMSecsSinceEpoch() + r.timeout;
+    }
+
+    connect( receiver, SIGNAL( destroyed( QObject* ) ), this, SLOT( receiverDestroyed() ), Qt::UniqueConnection );
+
+    if ( getInfo( requestData ) )
+        return true;
+
+    QMutexLocker lock( &m_receiversMutex );
+    m_receivers.remove( requestData.caller );
+    return false;
+}
+
+
+void
+InfoSystem::infoSlot( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output )
+{
+    QObject *receiver = 0;
+    {
+        QMutexLocker lock( &m_receiversMutex );
+        QHash< QString, Receiver >::iterator it = m_receivers.find( requestData.caller );
+        if ( it != m_receivers.end() )
+        {
+            receiver = it.value().object.data();
+            if ( !receiver )
+            {
+                m_receivers.erase( it );
+                return;
+            }
+
+            it.value().expires = QDateTime::currentMSecsSinceEpoch() + it.value().timeout;
+        }
+    }
+
+    if ( receiver )
+    {
+        QMetaObject::invokeMethod( receiver, "infoSystemInfo", Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ), Q_ARG( QVariant, output ) );
+        return;
+    }
+
+    emit info( requestData, output );
+}
+
+
+void
+InfoSystem::finishedSlot( QString target )
+{
+    QPointer< QObject > receiver;
+    bool targeted = false;
+    {
+        QMutexLocker lock( &m_receiversMutex );
+        if ( m_receivers.contains( target ) )
+        {
+            receiver = m_receivers.take( target ).object;
+            targeted = true;
+        }
+    }
+
+    if ( targeted )
+    {
+        if ( !receiver.isNull() && receiver.data()->metaObject()->indexOfMethod( "infoSystemFinished(QString)" ) >= 0 )
+            QMetaObject::invokeMethod( receiver.data(), "infoSystemFinished", Q_ARG( QString, target ) );
+        return;
+    }
+
+    emit finished( target );
+}
+
+
+void
+InfoSystem::receiverDestroyed()
+{
+    // the guards got cleared before destroyed() was emitted
+    QMutexLocker lock( &m_receiversMutex );
+    QHash< QString, Receiver >::iterator it = m_receivers.begin();
+    while ( it != m_receivers.end() )
+    {
+        if ( it.value().object.isNull() )
+            it = m_receivers.erase( it );
+        else
+            ++it;
+    }
+}
+
+
+void
+InfoSystem::checkReceiversTimerFired()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QMutexLocker lock( &m_receiversMutex );
+    QHash< QString, Receiver >::iterator it = m_receivers.begin();
+    while ( it != m_receivers.end() )
+    {
+        if ( it.value().object.isNull() || ( it.value().timeout >= 0 && it.value().expires < now ) )
+        {
+            tDebug() << Q_FUNC_INFO << "Forgetting receiver of caller" << it.key();
+            it = m_receivers.erase( it );
+        }
+        else
+            ++it;
+    }
+}
+
+
 bool
 InfoSystem::getInfo( const QString &caller, const QVariantMap &customData, const InfoTypeMap &inputMap, const InfoTimeoutMap &timeoutMap, bool allSources )
 {
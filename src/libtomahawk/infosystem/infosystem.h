@@ -23,13 +23,17 @@
 #include <QtCore/QCryptographicHash>
 #include <QtCore/QObject>
 #include <QtCore/QtDebug>
+#include <QtCore/QHash>
 #include <QtCore/QMap>
+#include <QtCore/QMutex>
+#include <QtCore/QPointer>
 #include <QtCore/QWeakPointer>
 #include <QtCore/QSet>
 #include <QtCore/QLinkedList>
 #include <QtCore/QUrl>
 #include <QtCore/QVariant>
 #include <QtCore/QThread>
+#include <QtCore/QTimer>
 #include <QtCore/QStringList>
 
 #include "dllmacro.h"
@@ -44,6 +48,12 @@ namespace InfoSystem {
 class InfoSystemCache;
 class InfoSystemWorker;
 
+// default limit of requests a single plugin works on at once
+#define INFOPLUGIN_MAX_CONCURRENT_REQUESTS 4
+// a receiver that got nothing for this long after its requests' timeout is forgotten,
+// requests can wait for a free plugin slot before their timeout starts
+#define INFOSYSTEM_RECEIVER_GRACE (5 * 60 * 1000)
+
 enum InfoType { // as items are saved in cache, mark them here to not change them
     InfoNoInfo = 0, //WARNING: *ALWAYS* keep this first!
     InfoTrackID = 1,
@@ -174,6 +184,8 @@ public:
 
     QSet< InfoType > supportedGetTypes() const { return m_supportedGetTypes; }
     QSet< InfoType > supportedPushTypes() const { return m_supportedPushTypes; }
+    // how many fetches after a cache miss the worker hands to this plugin at once, the rest get queued
+    int maxConcurrentRequests() const { return m_maxConcurrentRequests; }
 
 signals:
     void getCachedInfo( Tomahawk::InfoSystem::InfoStringHash criteria, qint64 newMaxAge, Tomahawk::InfoSystem::InfoRequestData requestData );
@@ -190,6 +202,7 @@ protected:
     InfoType m_type;
     QSet< InfoType > m_supportedGetTypes;
     QSet< InfoType > m_supportedPushTypes;
+    int m_maxConcurrentRequests;
 
 private:
     friend class InfoSystem;
@@ -238,6 +251,11 @@ public:
     ~InfoSystem();
 
     bool getInfo( const InfoRequestData &requestData );
+    // Delivers the replies for requestData.caller only to receiver, by invoking its
+    // infoSystemInfo( InfoRequestData, QVariant ) and, if it has one, infoSystemFinished( QString )
+    // slot, instead of broadcasting them to everybody connected to info() and finished().
+    // The receiver is forgotten once the caller's requests finished or timed out, or it got destroyed
+    bool getInfo( const InfoRequestData &requestData, QObject *receiver );
     //WARNING: if changing timeoutMillis above, also change in below function in .cpp file
     bool getInfo( const QString &caller, const QVariantMap &customData, const InfoTypeMap &inputMap, const InfoTimeoutMap &timeoutMap = InfoTimeoutMap(), bool allSources = false );
     bool pushInfo( const QString &caller, const InfoType type, const QVariant &input );
@@ -255,8 +273,27 @@ signals:
 private slots:
     void init();
 
+    void infoSlot( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
+    void finishedSlot( QString target );
+
+    void receiverDestroyed();
+    void checkReceiversTimerFired();
+
 private:
+    struct Receiver
+    {
+        QPointer< QObject > object;
+        // how long the receiver waits for a reply, -1 if it waits forever
+        qint64 timeout;
+        qint64 expires;
+    };
+
     bool m_inited;
+
+    QMutex m_receiversMutex;
+    QHash< QString, Receiver > m_receivers;
+    QTimer m_checkReceiversTimer;
+
     InfoSystemCacheThread* m_infoSystemCacheThreadController;
     InfoSystemWorkerThread* m_infoSystemWorkerThreadController;
 
@@ -20,8 +20,10 @@
 #include <QtDebug>
 
 #include <QDir>
-#include <QSettings>
 #include <QCryptographicHash>
+#include <QDataStream>
+#include <QSqlError>
+#include <QSqlQuery>
 
 #ifndef ENABLE_HEADLESS
     #include <QDesktopServices>
@@ -42,7 +44,7 @@ namespace InfoSystem
 InfoSystemCache::InfoSystemCache( QObject* parent )
     : QObject( parent )
     , m_cacheBaseDir( TomahawkSettings::instance()->storageCacheLocation() + "/InfoSystemCache/" )
-    , m_cacheVersion( 2 )
+    , m_cacheVersion( 3 )
 {
     tDebug() << Q_FUNC_INFO;
     TomahawkSettings *s = TomahawkSettings::instance();
@@ -61,6 +63,9 @@ InfoSystemCache::InfoSystemCache( QObject* parent )
         s->setInfoSystemCacheVersion( m_cacheVersion );
     }
 
+    if ( !openStore() )
+        tLog() << "Failed to open the info system cache, caching is disabled";
+
     m_pruneTimer.setInterval( 300000 );
     m_pruneTimer.setSingleShot( false );
     connect( &m_pruneTimer, SIGNAL( timeout() ), SLOT( pruneTimerFired() ) );
@@ -71,15 +76,63 @@ InfoSystemCache::InfoSystemCache( QObject* parent )
 InfoSystemCache::~InfoSystemCache()
 {
     tDebug() << Q_FUNC_INFO;
+
+    const QString connectionName = m_db.connectionName();
+    m_db.close();
+    m_db = QSqlDatabase();
+    if ( !connectionName.isEmpty() )
+        QSqlDatabase::removeDatabase( connectionName );
+}
+
+
+bool
+InfoSystemCache::openStore()
+{
+    QDir dir( m_cacheBaseDir );
+    if ( !dir.exists() && !dir.mkpath( m_cacheBaseDir ) )
+    {
+        tLog() << "Failed to create cache dir" << m_cacheBaseDir;
+        return false;
+    }
+
+    m_db = QSqlDatabase::addDatabase( "QSQLITE", "infosystemcache" );
+    m_db.setDatabaseName( m_cacheBaseDir + "infosystemcache.db" );
+    if ( !m_db.open() )
+    {
+        tLog() << "Failed to open cache database:" << m_db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query( m_db );
+    // it's only a cache, losing the last few writes on a crash is fine
+    query.exec( "PRAGMA synchronous = OFF" );
+    query.exec( "PRAGMA journal_mode = WAL" );
+
+    if ( !query.exec( "CREATE TABLE IF NOT EXISTS cache ( "
+                      "type INTEGER NOT NULL, "
+                      "criteria TEXT NOT NULL, "
+                      "expires INTEGER NOT NULL, "
+                      "data BLOB NOT NULL, "
+                      "PRIMARY KEY ( type, criteria ) )" ) ||
+         !query.exec( "CREATE INDEX IF NOT EXISTS cache_expires ON cache( expires )" ) )
+    {
+        tLog() << "Failed to create cache table:" << query.lastError().text();
+        m_db.close();
+        return false;
+    }
+
+    return true;
 }
 
+
 void
 InfoSystemCache::doUpgrade( uint oldVersion, uint newVersion )
 {
     Q_UNUSED( newVersion );
     qDebug() << Q_FUNC_INFO;
-    if ( oldVersion == 0 || oldVersion == 1  )
+    if ( oldVersion == 0 || oldVersion == 1 || oldVersion == 2 )
     {
+        // versions up to 2 kept one INI file per item, in one directory per type
         qDebug() << Q_FUNC_INFO << "Wiping cache";
 
         for ( int i = InfoNoInfo; i <= InfoLastInfo; i++ )
@@ -92,6 +145,8 @@ InfoSystemCache::doUpgrade( uint oldVersion, uint newVersion )
                 if ( !QFile::remove( file.canonicalFilePath() ) )
                     tLog() << "During upgrade, failed to remove cache file " << file.canonicalFilePath();
             }
+
+            QDir( m_cacheBaseDir ).rmdir( QString::number( (int)type ) );
         }
     }
 }
@@ -101,29 +156,17 @@ void
 InfoSystemCache::pruneTimerFired()
 {
     qDebug() << Q_FUNC_INFO << "Pruning infosystemcache";
-    qlonglong currentMSecsSinceEpoch = QDateTime::currentMSecsSinceEpoch();
+    if ( !m_db.isOpen() )
+        return;
 
-    for ( int i = InfoNoInfo; i <= InfoLastInfo; i++ )
-    {
-        InfoType type = (InfoType)(i);
-        QHash< QString, QString > fileLocationHash = m_fileLocationCache[type];
-        const QString cacheDirName = m_cacheBaseDir + QString::number( (int)type );
-        QFileInfoList fileList = QDir( cacheDirName ).entryInfoList( QDir::Files | QDir::NoDotAndDotDot );
-        foreach ( QFileInfo file, fileList )
-        {
-            QString baseName = file.baseName();
-            if ( file.suffix().toLongLong() < currentMSecsSinceEpoch )
-            {
-                if ( !QFile::remove( file.canonicalFilePath() ) )
-                    tLog() << "Failed to remove stale cache file" << file.canonicalFilePath();
-                else
-                    qDebug() << "Removed stale cache file" << file.canonicalFilePath();
-            }
-            if ( fileLocationHash.contains( baseName ) )
-                fileLocationHash.remove( baseName );
-        }
-        m_fileLocationCache[type] = fileLocationHash;
-    }
+    // served by the expiry index, only touches what actually expired
+    QSqlQuery query( m_db );
+    query.prepare( "DELETE FROM cache WHERE expires < ?" );
+    query.addBindValue( QDateTime::currentMSecsSinceEpoch() );
+    if ( !query.exec() )
+        tLog() << "Failed to prune cache:" << query.lastError().text();
+    else if ( query.numRowsAffected() > 0 )
+        qDebug() << "Removed" << query.numRowsAffected() << "stale cache items";
 }
 
 
@@ -133,82 +176,59 @@ InfoSystemCache::getCachedInfoSlot( Tomahawk::InfoSystem::InfoStringHash criteri
     QObject* sendingObj = sender();
     const QString criteriaHashVal = criteriaMd5( criteria );
     const QString criteriaHashValWithType = criteriaMd5( criteria, requestData.type );
-    QHash< QString, QString > fileLocationHash = m_fileLocationCache[ requestData.type ];
-    if ( !fileLocationHash.contains( criteriaHashVal ) )
-    {
-        if ( !fileLocationHash.isEmpty() )
-        {
-            //We already know of some values, so no need to re-read the directory again as it's already happened
-            qDebug() << Q_FUNC_INFO << "notInCache -- filelocationhash empty";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
-
-        const QString cacheDir = m_cacheBaseDir + QString::number( (int)requestData.type );
-        QDir dir( cacheDir );
-        if ( !dir.exists() )
-        {
-            //Dir doesn't exist so clearly not in cache
-            qDebug() << Q_FUNC_INFO << "notInCache -- dir doesn't exist";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
 
-        QFileInfoList fileList = dir.entryInfoList( QDir::Files | QDir::NoDotAndDotDot );
-        foreach ( QFileInfo file, fileList )
-        {
-            QString baseName = file.baseName();
-            fileLocationHash[ baseName ] = file.canonicalFilePath();
-        }
+    if ( !m_db.isOpen() )
+    {
+        notInCache( sendingObj, criteria, requestData );
+        return;
+    }
 
-        //Store what we've loaded up
-        m_fileLocationCache[ requestData.type ] = fileLocationHash;
-        if ( !fileLocationHash.contains( criteriaHashVal ) )
-        {
-            //Still didn't find it? It's really not in the cache then
-            qDebug() << Q_FUNC_INFO << "notInCache -- filelocationhash doesn't contain criteria val";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
+    QSqlQuery query( m_db );
+    query.prepare( "SELECT expires, data FROM cache WHERE type = ? AND criteria = ?" );
+    query.addBindValue( (int)requestData.type );
+    query.addBindValue( criteriaHashVal );
+    if ( !query.exec() || !query.next() )
+    {
+        notInCache( sendingObj, criteria, requestData );
+        return;
     }
 
-    QFileInfo file( fileLocationHash[ criteriaHashVal ] );
-    qlonglong currMaxAge = file.suffix().toLongLong();
+    const qlonglong currMaxAge = query.value( 0 ).toLongLong();
+    const qlonglong now = QDateTime::currentMSecsSinceEpoch();
 
-    if ( currMaxAge < QDateTime::currentMSecsSinceEpoch() )
+    if ( currMaxAge < now )
     {
-        if ( !QFile::remove( file.canonicalFilePath() ) )
-            tLog() << "Failed to remove stale cache file" << file.canonicalFilePath();
-        else
-            qDebug() << "Removed stale cache file" << file.canonicalFilePath();
+        QSqlQuery remove( m_db );
+        remove.prepare( "DELETE FROM cache WHERE type = ? AND criteria = ?" );
+        remove.addBindValue( (int)requestData.type );
+        remove.addBindValue( criteriaHashVal );
+        if ( !remove.exec() )
+            tLog() << "Failed to remove stale cache item:" << remove.lastError().text();
 
-        fileLocationHash.remove( criteriaHashVal );
-        m_fileLocationCache[ requestData.type ] = fileLocationHash;
         m_dataCache.remove( criteriaHashValWithType );
 
-        qDebug() << Q_FUNC_INFO << "notInCache -- file was stale";
+        qDebug() << Q_FUNC_INFO << "notInCache -- item was stale";
         notInCache( sendingObj, criteria, requestData );
         return;
     }
     else if ( newMaxAge > 0 )
     {
-        const QString newFilePath = QString( file.dir().canonicalPath() + '/' + criteriaHashVal + '.' + QString::number( QDateTime::currentMSecsSinceEpoch() + newMaxAge ) );
-
-        if ( !QFile::rename( file.canonicalFilePath(), newFilePath ) )
-        {
-            qDebug() << Q_FUNC_INFO << "notInCache -- failed to move old cache file to new location";
-            notInCache( sendingObj, criteria, requestData );
-            return;
-        }
-
-        fileLocationHash[ criteriaHashVal ] = newFilePath;
-        m_fileLocationCache[ requestData.type ] = fileLocationHash;
+        QSqlQuery update( m_db );
+        update.prepare( "UPDATE cache SET expires = ? WHERE type = ? AND criteria = ?" );
+        update.addBindValue( now + newMaxAge );
+        update.addBindValue( (int)requestData.type );
+        update.addBindValue( criteriaHashVal );
+        if ( !update.exec() )
+            tLog() << "Failed to update cache item expiry:" << update.lastError().text();
     }
 
     if ( !m_dataCache.contains( criteriaHashValWithType ) )
     {
-        QSettings cachedSettings( fileLocationHash[ criteriaHashVal ], QSettings::IniFormat );
-        QVariant output = cachedSettings.value( "data" );
+        QVariant output;
+        QByteArray data = query.value( 1 ).toByteArray();
+        QDataStream stream( &data, QIODevice::ReadOnly );
+        stream >> output;
+
         m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
 
         emit info( requestData, output );
@@ -223,7 +243,7 @@ InfoSystemCache::getCachedInfoSlot( Tomahawk::InfoSystem::InfoStringHash criteri
 void
 InfoSystemCache::notInCache( QObject *receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData )
 {
-    QMetaObject::invokeMethod( receiver, "notInCacheSlot", Q_ARG( Tomahawk::InfoSystem::InfoStringHash, criteria ), Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ) );
+    emit cacheMiss( receiver, criteria, requestData );
 }
 
 
@@ -233,50 +253,24 @@ InfoSystemCache::updateCacheSlot( Tomahawk::InfoSystem::InfoStringHash criteria,
     qDebug() << Q_FUNC_INFO;
     const QString criteriaHashVal = criteriaMd5( criteria );
     const QString criteriaHashValWithType = criteriaMd5( criteria, type );
-    const QString cacheDir = m_cacheBaseDir + QString::number( (int)type );
-    const QString settingsFilePath( cacheDir + '/' + criteriaHashVal + '.' + QString::number( QDateTime::currentMSecsSinceEpoch() + maxAge ) );
 
-    QHash< QString, QString > fileLocationHash = m_fileLocationCache[ type ];
-    if ( fileLocationHash.contains( criteriaHashVal ) )
-    {
-        if ( !QFile::rename( fileLocationHash[ criteriaHashVal ], settingsFilePath ) )
-        {
-            tLog() << "Failed to move old cache file to new location!";
-            return;
-        }
-        fileLocationHash[ criteriaHashVal ] = settingsFilePath;
-        m_fileLocationCache[ type ] = fileLocationHash;
-
-        QSettings cachedSettings( fileLocationHash[ criteriaHashVal ], QSettings::IniFormat );
-        cachedSettings.setValue( "data", output );
-
-        m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
+    m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
 
+    if ( !m_db.isOpen() )
         return;
-    }
 
-    QDir dir( cacheDir );
-    if( !dir.exists( cacheDir ) )
-    {
-        qDebug() << "Creating cache directory " << cacheDir;
-        if( !dir.mkpath( cacheDir ) )
-        {
-            tLog() << "Failed to create cache dir! Bailing...";
-            return;
-        }
-    }
-
-    QSettings cachedSettings( settingsFilePath, QSettings::IniFormat );
-    QStringList keys = criteria.keys();
-    cachedSettings.beginGroup( "criteria" );
-    for( int i = 0; i < criteria.size(); i++ )
-        cachedSettings.setValue( keys.at( i ), criteria[keys.at( i )] );
-    cachedSettings.endGroup();
-    cachedSettings.setValue( "data", output );
-
-    fileLocationHash[criteriaHashVal] = settingsFilePath;
-    m_fileLocationCache[type] = fileLocationHash;
-    m_dataCache.insert( criteriaHashValWithType, new QVariant( output ) );
+    QByteArray data;
+    QDataStream stream( &data, QIODevice::WriteOnly );
+    stream << output;
+
+    QSqlQuery query( m_db );
+    query.prepare( "INSERT OR REPLACE INTO cache( type, criteria, expires, data ) VALUES( ?, ?, ?, ? )" );
+    query.addBindValue( (int)type );
+    query.addBindValue( criteriaHashVal );
+    query.addBindValue( QDateTime::currentMSecsSinceEpoch() + maxAge );
+    query.addBindValue( data );
+    if ( !query.exec() )
+        tLog() << "Failed to store cache item:" << query.lastError().text();
 }
 
 
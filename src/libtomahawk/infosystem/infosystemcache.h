@@ -23,6 +23,7 @@
 #include <QCache>
 #include <QDateTime>
 #include <QObject>
+#include <QSqlDatabase>
 #include <QtDebug>
 #include <QTimer>
 
@@ -45,6 +46,8 @@ public:
 
 signals:
     void info( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
+    // the plugin that asked has to fetch it, the worker decides when
+    void cacheMiss( QObject* receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData );
 
 public slots:
     void getCachedInfoSlot( Tomahawk::InfoSystem::InfoStringHash criteria, qint64 newMaxAge, Tomahawk::InfoSystem::InfoRequestData requestData );
@@ -56,10 +59,12 @@ private slots:
 private:
     void notInCache( QObject *receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData );
     void doUpgrade( uint oldVersion, uint newVersion );
+    bool openStore();
     const QString criteriaMd5( const Tomahawk::InfoSystem::InfoStringHash &criteria, Tomahawk::InfoSystem::InfoType type = Tomahawk::InfoSystem::InfoNoInfo ) const;
-    
+
     QString m_cacheBaseDir;
-    QHash< InfoType, QHash< QString, QString > > m_fileLocationCache;
+    // all cached items, keyed by type and criteria, with an index on their expiry time
+    QSqlDatabase m_db;
     QTimer m_pruneTimer;
     QCache< QString, QVariant > m_dataCache;
 
@@ -79,6 +79,10 @@ InfoSystemWorker::init( Tomahawk::InfoSystem::InfoSystemCache* cache )
 {
     tDebug() << Q_FUNC_INFO;
     m_cache = cache;
+
+    // the fetches plugins do after a cache miss are the ones that get limited
+    connect( m_cache, SIGNAL( cacheMiss( QObject*, Tomahawk::InfoSystem::InfoStringHash, Tomahawk::InfoSystem::InfoRequestData ) ),
+                        SLOT( notInCacheSlot( QObject*, Tomahawk::InfoSystem::InfoStringHash, Tomahawk::InfoSystem::InfoRequestData ) ) );
 #ifndef ENABLE_HEADLESS
     addInfoPlugin( new EchoNestPlugin() );
     addInfoPlugin( new MusixMatchPlugin() );
@@ -169,6 +173,15 @@ InfoSystemWorker::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
     if ( !requestData.allSources )
         providers = QList< InfoPluginPtr >( providers.mid( 0, 1 ) );
 
+    // somebody already asked the same thing, just wait for that answer
+    const QString key = requestData.allSources ? QString() : coalescingKey( requestData );
+    if ( !key.isEmpty() && m_inFlight.contains( key ) )
+    {
+        m_dataTracker[ requestData.caller ][ requestData.type ] = m_dataTracker[ requestData.caller ][ requestData.type ] + 1;
+        m_followers[ m_inFlight.value( key ) ] << requestData;
+        return;
+    }
+
     bool foundOne = false;
     foreach ( InfoPluginPtr ptr, providers )
     {
@@ -188,11 +201,6 @@ InfoSystemWorker::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
 
         quint64 requestId = requestData.internalId;
         m_requestSatisfiedMap[ requestId ] = false;
-        if ( requestData.timeoutMillis != 0 )
-        {
-            qint64 currMs = QDateTime::currentMSecsSinceEpoch();
-            m_timeRequestMapper.insert( currMs + requestData.timeoutMillis, requestId );
-        }
     //    qDebug() << "Assigning request with requestId" << requestId << "and type" << requestData.type;
         m_dataTracker[ requestData.caller ][ requestData.type ] = m_dataTracker[ requestData.caller ][ requestData.type ] + 1;
     //    qDebug() << "Current count in dataTracker for target" << requestData.caller << "and type" << requestData.type << "is" << m_dataTracker[ requestData.caller ][ requestData.type ];
@@ -204,7 +212,13 @@ InfoSystemWorker::getInfo( Tomahawk::InfoSystem::InfoRequestData requestData )
         data->customData = requestData.customData;
         m_savedRequestMap[ requestId ] = data;
 
-        QMetaObject::invokeMethod( ptr.data(), "getInfo", Qt::QueuedConnection, Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ) );
+        if ( !key.isEmpty() )
+        {
+            m_inFlight[ key ] = requestId;
+            m_inFlightKeys[ requestId ] = key;
+        }
+
+        dispatch( ptr.data(), requestData );
     }
 
     if ( !foundOne )
@@ -254,6 +268,148 @@ InfoSystemWorker::infoSlot( Tomahawk::InfoSystem::InfoRequestData requestData, Q
     delete m_savedRequestMap[ requestId ];
     m_savedRequestMap.remove( requestId );
     checkFinished( requestData );
+
+    requestDone( requestId );
+    answerFollowers( requestId, output );
+}
+
+
+QString
+InfoSystemWorker::coalescingKey( const Tomahawk::InfoSystem::InfoRequestData &requestData ) const
+{
+    QString key = QString::number( (int)requestData.type ) + '\n';
+
+    if ( requestData.input.canConvert< Tomahawk::InfoSystem::InfoStringHash >() )
+    {
+        const InfoStringHash criteria = requestData.input.value< Tomahawk::InfoSystem::InfoStringHash >();
+        QStringList keys = criteria.keys();
+        keys.sort();
+        foreach ( const QString& k, keys )
+            key += k + '\t' + criteria.value( k ) + '\n';
+    }
+    else if ( requestData.input.type() == QVariant::String )
+    {
+        key += requestData.input.toString();
+    }
+    else
+    {
+        // we can't tell whether two of those are the same, so never merge them
+        return QString();
+    }
+
+    return key;
+}
+
+
+void
+InfoSystemWorker::dispatch( InfoPlugin* plugin, const Tomahawk::InfoSystem::InfoRequestData &requestData )
+{
+    // looking into the cache is cheap, only the fetch after a miss is limited
+    startTimeout( requestData );
+    QMetaObject::invokeMethod( plugin, "getInfo", Qt::QueuedConnection, Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ) );
+}
+
+
+void
+InfoSystemWorker::notInCacheSlot( QObject* receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData )
+{
+    InfoPlugin* plugin = qobject_cast< InfoPlugin* >( receiver );
+    if ( !plugin )
+        return;
+
+    // timed out while looking into the cache
+    if ( m_requestSatisfiedMap.value( requestData.internalId, true ) )
+        return;
+
+    if ( m_runningRequests.value( plugin ) >= plugin->maxConcurrentRequests() )
+    {
+        // waiting for a free slot doesn't count against the timeout, it starts again when the fetch does
+        stopTimeout( requestData.internalId );
+        m_queuedRequests[ plugin ] << qMakePair( criteria, requestData );
+        return;
+    }
+
+    fetch( plugin, criteria, requestData );
+}
+
+
+void
+InfoSystemWorker::fetch( InfoPlugin* plugin, const Tomahawk::InfoSystem::InfoStringHash &criteria, const Tomahawk::InfoSystem::InfoRequestData &requestData )
+{
+    m_runningRequests[ plugin ] = m_runningRequests.value( plugin ) + 1;
+    m_requestPlugins[ requestData.internalId ] = plugin;
+
+    startTimeout( requestData );
+    QMetaObject::invokeMethod( plugin, "notInCacheSlot", Qt::QueuedConnection,
+                               Q_ARG( Tomahawk::InfoSystem::InfoStringHash, criteria ), Q_ARG( Tomahawk::InfoSystem::InfoRequestData, requestData ) );
+}
+
+
+void
+InfoSystemWorker::requestDone( quint64 requestId )
+{
+    stopTimeout( requestId );
+
+    InfoPlugin* plugin = m_requestPlugins.take( requestId );
+    if ( !plugin )
+        return;
+
+    m_runningRequests[ plugin ] = m_runningRequests.value( plugin ) - 1;
+
+    QList< QPair< InfoStringHash, InfoRequestData > >& queue = m_queuedRequests[ plugin ];
+    while ( !queue.isEmpty() && m_runningRequests.value( plugin ) < plugin->maxConcurrentRequests() )
+    {
+        const QPair< InfoStringHash, InfoRequestData > next = queue.takeFirst();
+
+        // answered some other way while waiting in the queue
+        if ( m_requestSatisfiedMap.value( next.second.internalId, true ) )
+            continue;
+
+        fetch( plugin, next.first, next.second );
+    }
+}
+
+
+void
+InfoSystemWorker::startTimeout( const Tomahawk::InfoSystem::InfoRequestData &requestData )
+{
+    stopTimeout( requestData.internalId );
+    if ( requestData.timeoutMillis == 0 )
+        return;
+
+    const qint64 time = QDateTime::currentMSecsSinceEpoch() + requestData.timeoutMillis;
+    m_timeRequestMapper.insert( time, requestData.internalId );
+    m_requestTimeouts[ requestData.internalId ] = time;
+}
+
+
+void
+InfoSystemWorker::stopTimeout( quint64 requestId )
+{
+    if ( !m_requestTimeouts.contains( requestId ) )
+        return;
+
+    const qint64 time = m_requestTimeouts.take( requestId );
+    m_timeRequestMapper.remove( time, requestId );
+}
+
+
+void
+InfoSystemWorker::answerFollowers( quint64 requestId, const QVariant &output )
+{
+    const QString key = m_inFlightKeys.take( requestId );
+    if ( key.isEmpty() )
+        return;
+
+    m_inFlight.remove( key );
+
+    foreach ( const InfoRequestData& follower, m_followers.take( requestId ) )
+    {
+        emit info( follower, output );
+
+        m_dataTracker[ follower.caller ][ follower.type ] = m_dataTracker[ follower.caller ][ follower.type ] - 1;
+        checkFinished( follower );
+    }
 }
 
 
@@ -286,9 +442,7 @@ InfoSystemWorker::checkTimeoutsTimerFired()
                 if ( m_requestSatisfiedMap[ requestId ] )
                 {
 //                    qDebug() << Q_FUNC_INFO << "Removing mapping of" << requestId << "which expired at time" << time << "and was already satisfied";
-                    m_timeRequestMapper.remove( time, requestId );
-                    if ( !m_timeRequestMapper.count( time ) )
-                        m_timeRequestMapper.remove( time );
+                    stopTimeout( requestId );
                     continue;
                 }
 
@@ -310,11 +464,12 @@ InfoSystemWorker::checkTimeoutsTimerFired()
 //                qDebug() << "Current count in dataTracker for target" << returnData.caller << "is" << m_dataTracker[ returnData.caller ][ returnData.type ];
 
                 m_requestSatisfiedMap[ requestId ] = true;
-                m_timeRequestMapper.remove( time, requestId );
-                if ( !m_timeRequestMapper.count( time ) )
-                    m_timeRequestMapper.remove( time );
+                stopTimeout( requestId );
 
                 checkFinished( returnData );
+
+                requestDone( requestId );
+                answerFollowers( requestId, QVariant() );
             }
             else
             {
@@ -29,6 +29,7 @@
 #include <QtCore/QWeakPointer>
 #include <QtCore/QSet>
 #include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtCore/QVariant>
 #include <QtCore/QTimer>
 
@@ -67,17 +68,37 @@ public slots:
 
 private slots:
     void checkTimeoutsTimerFired();
+    void notInCacheSlot( QObject* receiver, Tomahawk::InfoSystem::InfoStringHash criteria, Tomahawk::InfoSystem::InfoRequestData requestData );
 
 private:
 
     void checkFinished( const Tomahawk::InfoSystem::InfoRequestData &target );
     QList< InfoPluginPtr > determineOrderedMatches( const InfoType type ) const;
+    QString coalescingKey( const Tomahawk::InfoSystem::InfoRequestData &requestData ) const;
+    void dispatch( InfoPlugin* plugin, const Tomahawk::InfoSystem::InfoRequestData &requestData );
+    void fetch( InfoPlugin* plugin, const Tomahawk::InfoSystem::InfoStringHash &criteria, const Tomahawk::InfoSystem::InfoRequestData &requestData );
+    void requestDone( quint64 requestId );
+    void startTimeout( const Tomahawk::InfoSystem::InfoRequestData &requestData );
+    void stopTimeout( quint64 requestId );
+    void answerFollowers( quint64 requestId, const QVariant &output );
 
     QHash< QString, QHash< InfoType, int > > m_dataTracker;
     QMultiMap< qint64, quint64 > m_timeRequestMapper;
+    QHash< quint64, qint64 > m_requestTimeouts;
     QHash< uint, bool > m_requestSatisfiedMap;
     QHash< uint, InfoRequestData* > m_savedRequestMap;
 
+    // identical requests get merged while one of them is in flight: the internal id of
+    // the request that was actually sent, and the requests waiting for its answer
+    QHash< QString, quint64 > m_inFlight;
+    QHash< quint64, QString > m_inFlightKeys;
+    QHash< quint64, QList< InfoRequestData > > m_followers;
+
+    // fetches after a cache miss currently running per plugin, and the ones waiting for a free slot
+    QHash< quint64, InfoPlugin* > m_requestPlugins;
+    QHash< InfoPlugin*, int > m_runningRequests;
+    QHash< InfoPlugin*, QList< QPair< InfoStringHash, InfoRequestData > > > m_queuedRequests;
+
     // NOTE Cache object lives in a different thread, do not call methods on it directly
     InfoSystemCache* m_cache;
 
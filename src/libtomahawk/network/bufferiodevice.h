@@ -23,7 +23,9 @@
 #include <QMutexLocker>
 #include <QFile>
 
-class BufferIODevice : public QIODevice
+#include "dllmacro.h"
+
+class DLLEXPORT BufferIODevice : public QIODevice
 {
 Q_OBJECT
 
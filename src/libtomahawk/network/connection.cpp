@@ -25,7 +25,7 @@
 #include "network/servent.h"
 #include "utils/logger.h"
 
-#define PROTOVER "4" // must match remote peer, or we can't talk.
+#define PROTOVER "4" // must match remote peer, or we can't talk. the format of db ops is negotiated by DBSyncConnection
 
 
 Connection::Connection( Servent* parent )
@@ -35,6 +35,7 @@
 #include "database/databasecommand.h"
 #include "database/databasecommand_collectionstats.h"
 #include "database/databasecommand_loadops.h"
+#include "database/opcodec.h"
 #include "remotecollection.h"
 #include "source.h"
 #include "sourcelist.h"
@@ -167,6 +168,8 @@ DBSyncConnection::fetchOpsData( const QString& sinceguid )
     QVariantMap msg;
     msg.insert( "method", "fetchops" );
     msg.insert( "lastop", sinceguid );
+    // older peers don't send this, they get JSON ops with full playlist revisions
+    msg.insert( "opformat", (int)OpCodec::Binary );
     sendMsg( msg );
 }
 
@@ -195,9 +198,9 @@ DBSyncConnection::handleMsg( msg_ptr msg )
         return;
     }
 
-    Q_ASSERT( msg->is( Msg::JSON ) );
+    Q_ASSERT( msg->is( Msg::JSON ) || msg->is( Msg::DBOP ) );
 
-    QVariantMap m = msg->json().toMap();
+    QVariantMap m = msg->is( Msg::DBOP ) ? msg->dbop().toMap() : msg->json().toMap();
     if ( m.empty() )
     {
         tLog() << "Failed to parse msg in dbsync" << m_source->id() << m_source->friendlyName();
@@ -211,6 +214,8 @@ DBSyncConnection::handleMsg( msg_ptr msg )
         DatabaseCommand* cmd = DatabaseCommand::factory( m, m_source );
         if ( cmd )
         {
+            // never let a peer's backlog hold up what the user is doing
+            cmd->setPriority( DatabaseCommand::BulkPriority );
             QSharedPointer<DatabaseCommand> cmdsp = QSharedPointer<DatabaseCommand>(cmd);
             m_source->addCommand( cmdsp );
         }
@@ -260,6 +265,7 @@ DBSyncConnection::sendOps()
     source_ptr src = SourceList::instance()->getLocal();
 
     DatabaseCommand_loadOps* cmd = new DatabaseCommand_loadOps( src, m_uscache.value( "lastop" ).toString() );
+    cmd->setLegacyFormat( m_uscache.value( "opformat" ).toInt() < OpCodec::Binary );
     connect( cmd, SIGNAL( done( QString, QString, QList< dbop_ptr > ) ),
                     SLOT( sendOpsData( QString, QString, QList< dbop_ptr > ) ) );
 
@@ -286,7 +292,8 @@ DBSyncConnection::sendOpsData( QString sinceguid, QString lastguid, QList< dbop_
     int i;
     for( i = 0; i < ops.length(); ++i )
     {
-        quint8 flags = Msg::JSON | Msg::DBOP;
+        quint8 flags = Msg::DBOP;
+        flags |= ops.at( i )->format == OpCodec::Binary ? Msg::RAW : Msg::JSON;
 
         if ( ops.at( i )->compressed )
             flags |= Msg::COMPRESSED;
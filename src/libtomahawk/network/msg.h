@@ -39,6 +39,8 @@
 #include <qjson/serializer.h>
 #include <qjson/qobjecthelper.h>
 
+#include "database/opcodec.h"
+
 class Msg;
 typedef QSharedPointer<Msg> msg_ptr;
 
@@ -126,6 +128,22 @@ public:
         return m_json;
     }
 
+    /// db sync ops come either as json or in the binary OpCodec encoding (RAW)
+    QVariant& dbop()
+    {
+        Q_ASSERT( is(DBOP) );
+        if( is(JSON) )
+            return json();
+
+        Q_ASSERT( !is(COMPRESSED) );
+        if( !m_json_parsed )
+        {
+            m_json = OpCodec::decode( m_payload );
+            m_json_parsed = true;
+        }
+        return m_json;
+    }
+
     char flags() const { return m_flags; }
 
 private:
@@ -123,6 +123,16 @@ MsgProcessor::process( msg_ptr msg, quint32 mode, quint32 threshold )
         msg->m_json_parsed = true;
     }
 
+    // same for binary db ops
+    if( (mode & PARSE_JSON) &&
+        msg->is( Msg::DBOP ) && msg->is( Msg::RAW ) &&
+        !msg->is( Msg::COMPRESSED ) &&
+        msg->m_json_parsed == false )
+    {
+        msg->m_json = OpCodec::decode( msg->payload() );
+        msg->m_json_parsed = true;
+    }
+
     // compress if needed
     if( (mode & COMPRESS_IF_LARGE) &&
         !msg->is( Msg::COMPRESSED )
@@ -41,7 +41,9 @@
 
 #include "msg.h"
 
-class MsgProcessor : public QObject
+#include "dllmacro.h"
+
+class DLLEXPORT MsgProcessor : public QObject
 {
 Q_OBJECT
 public:
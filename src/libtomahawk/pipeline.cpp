@@ -22,6 +22,7 @@
 
 #include "functimeout.h"
 #include "database/database.h"
+#include "database/databasecommand_updateresolvecache.h"
 #include "ExternalResolver.h"
 #include "resolvers/scriptresolver.h"
 #include "resolvers/qtscriptresolver.h"
@@ -34,6 +35,10 @@
 #define MAX_CONCURRENT_QUERIES 16
 #define CLEANUP_TIMEOUT 5 * 60 * 1000
 #define MINSCORE 0.5
+// how many watched queries get re-resolved at once
+#define REFRESH_BATCH_SIZE 250
+// collect resolved queries for this long before writing them to the resolve cache
+#define RESOLVECACHE_FLUSH_INTERVAL 5000
 
 using namespace Tomahawk;
 
@@ -50,6 +55,7 @@ Pipeline::instance()
 Pipeline::Pipeline( QObject* parent )
     : QObject( parent )
     , m_running( false )
+    , m_refreshScheduled( false )
 {
     s_instance = this;
 
@@ -58,6 +64,14 @@ Pipeline::Pipeline( QObject* parent )
 
     m_temporaryQueryTimer.setInterval( CLEANUP_TIMEOUT );
     connect( &m_temporaryQueryTimer, SIGNAL( timeout() ), SLOT( onTemporaryQueryTimer() ) );
+
+    m_resolveCacheTimer.setInterval( RESOLVECACHE_FLUSH_INTERVAL );
+    m_resolveCacheTimer.setSingleShot( true );
+    connect( &m_resolveCacheTimer, SIGNAL( timeout() ), SLOT( flushResolveCache() ) );
+
+    // resolvers may get added from other threads
+    connect( this, SIGNAL( resolverAdded( Resolver* ) ), SLOT( onResolversChanged() ), Qt::QueuedConnection );
+    connect( this, SIGNAL( resolverRemoved( Resolver* ) ), SLOT( onResolversChanged() ), Qt::QueuedConnection );
 }
 
 
@@ -72,6 +86,8 @@ Pipeline::~Pipeline()
             r.data()->deleteLater();
 
     m_scriptResolvers.clear();
+
+    s_instance = 0;
 }
 
 
@@ -79,6 +95,7 @@ void
 Pipeline::databaseReady()
 {
     connect( Database::instance(), SIGNAL( indexReady() ), this, SLOT( start() ), Qt::QueuedConnection );
+    connect( Database::instance(), SIGNAL( indexReady() ), this, SLOT( onIndexReady() ), Qt::QueuedConnection );
     Database::instance()->loadIndex();
 }
 
@@ -121,6 +138,19 @@ Pipeline::addResolver( Resolver* r )
 }
 
 
+QSet< QString >
+Pipeline::resolverNames()
+{
+    QMutexLocker lock( &m_mut );
+
+    QSet< QString > names;
+    foreach ( Resolver* r, m_resolvers )
+        names << r->name();
+
+    return names;
+}
+
+
 void
 Pipeline::addExternalResolverFactory( ResolverFactoryFunc resolverFactory )
 {
@@ -368,6 +398,18 @@ Pipeline::shuntNext()
         rc = m_resolvers.count();
         if ( m_queries_pending.isEmpty() )
         {
+            // feed the next batch of queries waiting to be resolved again
+            QMutexLocker watchLock( &m_watchMut );
+            if ( !m_refreshQueued.isEmpty() )
+            {
+                if ( !m_refreshScheduled )
+                {
+                    m_refreshScheduled = true;
+                    QMetaObject::invokeMethod( this, "refreshNext", Qt::QueuedConnection );
+                }
+                return;
+            }
+
             if ( m_qidsState.isEmpty() )
                 emit idle();
             return;
@@ -481,6 +523,15 @@ Pipeline::setQIDState( const Tomahawk::query_ptr& query, int state )
         m_qidsState.remove( query->id() );
         query->onResolvingFinished();
 
+        if ( !query->isFullTextQuery() && query->playable() && !m_queries_temporary.contains( query ) )
+        {
+            // timers must be started from the thread they live in
+            if ( m_resolveCacheQueue.isEmpty() )
+                QMetaObject::invokeMethod( &m_resolveCacheTimer, "start", Qt::QueuedConnection );
+
+            m_resolveCacheQueue << query;
+        }
+
         if ( !m_queries_temporary.contains( query ) )
             m_qids.remove( query->id() );
 
@@ -536,3 +587,141 @@ Pipeline::onTemporaryQueryTimer()
         m_qids.remove( q->id() );
     }
 }
+
+
+void
+Pipeline::watch( const query_ptr& q, bool onIndexReady )
+{
+    if ( q.isNull() )
+        return;
+
+    QMutexLocker lock( &m_watchMut );
+    m_watched.insert( q.data(), qMakePair( q.toWeakRef(), onIndexReady ) );
+}
+
+
+void
+Pipeline::unwatch( Tomahawk::Query* q )
+{
+    QMutexLocker lock( &m_watchMut );
+    m_watched.remove( q );
+    m_refreshQueued.remove( q );
+}
+
+
+void
+Pipeline::setVisibleQueries( const QList< query_ptr >& queries )
+{
+    QMutexLocker lock( &m_watchMut );
+
+    m_visibleQueries.clear();
+    foreach ( const query_ptr& q, queries )
+        m_visibleQueries << q.toWeakRef();
+}
+
+
+void
+Pipeline::onIndexReady()
+{
+    queueRefresh( true );
+}
+
+
+void
+Pipeline::onResolversChanged()
+{
+    queueRefresh( false );
+}
+
+
+void
+Pipeline::queueRefresh( bool indexReady )
+{
+    int queued = 0;
+    {
+        QMutexLocker lock( &m_watchMut );
+
+        QHash< Query*, QPair< QWeakPointer< Query >, bool > >::const_iterator it = m_watched.constBegin();
+        for ( ; it != m_watched.constEnd(); ++it )
+        {
+            if ( m_refreshQueued.contains( it.key() ) )
+                continue;
+
+            query_ptr q = it.value().first.toStrongRef();
+            if ( q.isNull() || !q->resolvingFinished() )
+                continue;
+
+            if ( indexReady ? !it.value().second : q->solved() )
+                continue;
+
+            m_refreshQueue << it.value().first;
+            m_refreshQueued << it.key();
+        }
+
+        queued = m_refreshQueued.count();
+    }
+
+    tDebug() << Q_FUNC_INFO << "Queries waiting to be resolved again:" << queued;
+
+    // feeds the first batch, unless other queries are still pending
+    shuntNext();
+}
+
+
+void
+Pipeline::refreshNext()
+{
+    QList< query_ptr > visible;
+    QList< query_ptr > batch;
+    {
+        QMutexLocker lock( &m_watchMut );
+        m_refreshScheduled = false;
+
+        foreach ( const QWeakPointer< Query >& ref, m_visibleQueries )
+        {
+            query_ptr q = ref.toStrongRef();
+            if ( !q.isNull() && m_refreshQueued.remove( q.data() ) )
+                visible << q;
+        }
+
+        while ( visible.count() + batch.count() < REFRESH_BATCH_SIZE && !m_refreshQueue.isEmpty() )
+        {
+            query_ptr q = m_refreshQueue.takeFirst().toStrongRef();
+            if ( q.isNull() || !m_refreshQueued.remove( q.data() ) )
+                continue;
+
+            batch << q;
+        }
+
+        if ( m_refreshQueued.isEmpty() )
+            m_refreshQueue.clear();
+    }
+
+    // only queries which finished resolving in the meantime need to start over
+    foreach ( const query_ptr& q, visible + batch )
+    {
+        if ( q->resolvingFinished() )
+            q->m_resolveFinished = false;
+    }
+
+    resolve( visible, true );
+    resolve( batch, false );
+}
+
+
+void
+Pipeline::flushResolveCache()
+{
+    QList< query_ptr > queries;
+    {
+        QMutexLocker lock( &m_mut );
+        queries = m_resolveCacheQueue;
+        m_resolveCacheQueue.clear();
+    }
+
+    if ( queries.isEmpty() || !Database::instance() )
+        return;
+
+    DatabaseCommand_UpdateResolveCache* cmd = new DatabaseCommand_UpdateResolveCache( queries );
+    Database::instance()->enqueue( QSharedPointer< DatabaseCommand >( cmd ) );
+}
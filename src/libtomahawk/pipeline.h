@@ -26,6 +26,7 @@
 #include <QList>
 #include <QMap>
 #include <QMutex>
+#include <QSet>
 #include <QTimer>
 
 #include <boost/function.hpp>
@@ -66,6 +67,18 @@ public:
 
     void addResolver( Resolver* r );
     void removeResolver( Resolver* r );
+    // names of the loaded resolvers, the friendly source of their results
+    QSet< QString > resolverNames();
+
+    /*
+        Queries that have to be resolved again once the search index got
+        rebuilt (onIndexReady) or a resolver was added or removed (unsolved
+        queries only). Re-resolving happens in bounded batches, queries
+        passed to setVisibleQueries() first.
+    */
+    void watch( const query_ptr& q, bool onIndexReady );
+    void unwatch( Tomahawk::Query* q );
+    void setVisibleQueries( const QList< query_ptr >& queries );
 
     query_ptr query( const QID& qid ) const
     {
@@ -100,7 +113,15 @@ private slots:
 
     void onTemporaryQueryTimer();
 
+    void onIndexReady();
+    void onResolversChanged();
+    void refreshNext();
+
+    void flushResolveCache();
+
 private:
+    void queueRefresh( bool indexReady );
+
     Tomahawk::Resolver* nextResolver( const Tomahawk::query_ptr& query ) const;
 
     void setQIDState( const Tomahawk::query_ptr& query, int state );
@@ -126,6 +147,19 @@ private:
     bool m_running;
     QTimer m_temporaryQueryTimer;
 
+    QMutex m_watchMut; // for everything below, always taken after m_mut
+
+    // value tells whether the query gets resolved again when the index is ready
+    QHash< Tomahawk::Query*, QPair< QWeakPointer< Tomahawk::Query >, bool > > m_watched;
+    QList< QWeakPointer< Tomahawk::Query > > m_refreshQueue;
+    QSet< Tomahawk::Query* > m_refreshQueued;
+    QList< QWeakPointer< Tomahawk::Query > > m_visibleQueries;
+    bool m_refreshScheduled;
+
+    // resolved queries whose results still have to be written to the resolve cache
+    QList< query_ptr > m_resolveCacheQueue;
+    QTimer m_resolveCacheTimer;
+
     static Pipeline* s_instance;
 };
 
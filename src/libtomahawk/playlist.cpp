@@ -96,6 +96,7 @@ Playlist::Playlist( const source_ptr& author )
     : m_source( author )
     , m_lastmodified( 0 )
     , m_updater( 0 )
+    , m_deltasSinceCheckpoint( 0 )
 {
 }
 
@@ -155,6 +156,8 @@ Playlist::init()
     m_busy = false;
     m_deleted = false;
     m_locallyChanged = false;
+    // the first revision after loading goes out in full
+    m_deltasSinceCheckpoint = PLAYLIST_CHECKPOINT_INTERVAL;
     connect( Pipeline::instance(), SIGNAL( idle() ), SLOT( onResolvingFinished() ) );
 }
 
@@ -327,6 +330,22 @@ Playlist::createNewRevision( const QString& newrev, const QString& oldrev, const
                                                      added,
                                                      entries );
 
+    // our entries are those of oldrev, unless it's a queued revision based on an older one
+    if ( newrev != oldrev && !oldrev.isEmpty() && oldrev == currentrevision() &&
+         m_deltasSinceCheckpoint + 1 < PLAYLIST_CHECKPOINT_INTERVAL )
+    {
+        QStringList oldorderedguids;
+        foreach( const plentry_ptr& p, m_entries )
+            oldorderedguids << p->guid();
+
+        cmd->setOldOrderedGuids( oldorderedguids );
+        m_deltasSinceCheckpoint++;
+    }
+    else if ( newrev != oldrev )
+    {
+        m_deltasSinceCheckpoint = 0;
+    }
+
     Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
 }
 
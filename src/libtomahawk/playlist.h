@@ -149,7 +149,7 @@ public:
     static void remove( const playlist_ptr& playlist );
     void rename( const QString& title );
 
-    virtual void loadRevision( const QString& rev = "" );
+    Q_INVOKABLE virtual void loadRevision( const QString& rev = "" );
 
     source_ptr author() const;
     QString currentrevision() const   { return m_currentrevision; }
@@ -280,6 +280,8 @@ private:
     bool m_locallyChanged;
     bool m_deleted;
     bool m_busy;
+    // revisions we sent to peers as a delta since the last full list
+    int m_deltasSinceCheckpoint;
 
     Tomahawk::playlistinterface_ptr m_playlistInterface;
 };
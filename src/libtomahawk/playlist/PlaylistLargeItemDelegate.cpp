@@ -35,6 +35,7 @@
 #include "trackheader.h"
 
 #include "utils/tomahawkutilsgui.h"
+#include "utils/thumbnailstore.h"
 #include "utils/logger.h"
 
 using namespace Tomahawk;
@@ -53,6 +54,10 @@ PlaylistLargeItemDelegate::PlaylistLargeItemDelegate( TrackView* parent, TrackPr
 
     m_bottomOption = QTextOption( Qt::AlignBottom );
     m_bottomOption.setWrapMode( QTextOption::NoWrap );
+
+    // the cover rect of a row as high as sizeHint() makes it, see paint()
+    const int rowHeight = 3 * ( parent->fontMetrics().height() + 8 );
+    ThumbnailStore::instance()->addSize( QSize( rowHeight - 12, rowHeight - 12 ) );
 }
 
 
@@ -27,6 +27,7 @@
 #include "result.h"
 
 #include "utils/tomahawkutils.h"
+#include "utils/thumbnailstore.h"
 #include "utils/logger.h"
 
 #include "playlist/albumitem.h"
@@ -40,6 +41,8 @@ AlbumItemDelegate::AlbumItemDelegate( QAbstractItemView* parent, AlbumProxyModel
     , m_view( parent )
     , m_model( proxy )
 {
+    // the cover rect of AlbumModel's 116x150 items, see paint()
+    Tomahawk::ThumbnailStore::instance()->addSize( QSize( 104, 104 ) );
 }
 
 
@@ -99,6 +102,8 @@ AlbumItemDelegate::paint( QPainter* painter, const QStyleOptionViewItem& option,
     else if ( !item->artist().isNull() )
     {
         cover = item->artist()->cover( r.size() );
+        if ( cover.isNull() )
+            cover = TomahawkUtils::defaultPixmap( TomahawkUtils::DefaultArtistImage, TomahawkUtils::CoverInCase, r.size() );
     }
 
     if ( option.state & QStyle::State_Selected )
@@ -20,6 +20,7 @@
 #include "albumproxymodel.h"
 
 #include <QListView>
+#include <QtConcurrentRun>
 
 #include "albumproxymodelplaylistinterface.h"
 #include "artist.h"
@@ -31,6 +32,15 @@
 AlbumProxyModel::AlbumProxyModel( QObject* parent )
     : QSortFilterProxyModel( parent )
     , m_model( 0 )
+    , m_keysRevision( 0 )
+    , m_sortWatcher( 0 )
+    , m_sortGeneration( new QAtomicInt( 0 ) )
+    , m_pendingSortColumn( 0 )
+    , m_pendingSortOrder( Qt::AscendingOrder )
+    , m_pendingSortRevision( 0 )
+    , m_matchesWatcher( 0 )
+    , m_matchesGeneration( new QAtomicInt( 0 ) )
+    , m_pendingMatchesRevision( 0 )
 {
     setFilterCaseSensitivity( Qt::CaseInsensitive );
     setSortCaseSensitivity( Qt::CaseInsensitive );
@@ -57,6 +67,17 @@ AlbumProxyModel::setSourceAlbumModel( AlbumModel* sourceModel )
     if ( m_model && m_model->metaObject()->indexOfSignal( "trackCountChanged(uint)" ) > -1 )
         connect( m_model, SIGNAL( trackCountChanged( unsigned int ) ), SIGNAL( sourceTrackCountChanged( unsigned int ) ) );
 
+    if ( m_model )
+    {
+        // before QSortFilterProxyModel gets to see the changes, so it doesn't use outdated positions
+        connect( m_model, SIGNAL( rowsInserted( QModelIndex, int, int ) ), SLOT( invalidateKeys() ) );
+        connect( m_model, SIGNAL( rowsRemoved( QModelIndex, int, int ) ), SLOT( invalidateKeys() ) );
+        connect( m_model, SIGNAL( dataChanged( QModelIndex, QModelIndex ) ), SLOT( invalidateKeys() ) );
+        connect( m_model, SIGNAL( layoutChanged() ), SLOT( invalidateKeys() ) );
+        connect( m_model, SIGNAL( modelReset() ), SLOT( invalidateKeys() ) );
+    }
+
+    invalidateKeys();
     QSortFilterProxyModel::setSourceModel( sourceModel );
 }
 
@@ -67,24 +88,42 @@ AlbumProxyModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceParen
     if ( filterRegExp().isEmpty() )
         return true;
 
+    const QString pattern = filterRegExp().pattern();
+
+    // matched on the worker thread already
+    if ( !sourceParent.isValid() && pattern == m_matchedPattern && sourceRow < m_matched.size() )
+        return m_matched.testBit( sourceRow );
+
     AlbumItem* pi = sourceModel()->itemFromIndex( sourceModel()->index( sourceRow, 0, sourceParent ) );
     if ( !pi )
         return false;
 
-    const Tomahawk::album_ptr& q = pi->album();
+    if ( pattern != m_filterPattern )
+    {
+        m_filterPattern = pattern;
+        m_filterTokens = SortKeys::filterTokens( pattern );
+    }
 
-    QStringList sl = filterRegExp().pattern().split( " ", QString::SkipEmptyParts );
+    QString name, artist;
+    const Tomahawk::album_ptr& q = pi->album();
+    if ( !q.isNull() )
+    {
+        name = StringPool::searchKey( q->name() );
+        if ( !q->artist().isNull() )
+            artist = StringPool::searchKey( q->artist()->name() );
+    }
+    else if ( !pi->artist().isNull() )
+        name = StringPool::searchKey( pi->artist()->name() );
+    else
+        return false;
 
-    bool found = true;
-    foreach( const QString& s, sl )
+    foreach( const QString& s, m_filterTokens )
     {
-        if ( !q->name().contains( s, Qt::CaseInsensitive ) && !q->artist()->name().contains( s, Qt::CaseInsensitive ) )
-        {
-            found = false;
-        }
+        if ( !name.contains( s ) && !artist.contains( s ) )
+            return false;
     }
 
-    return found;
+    return true;
 }
 
 
@@ -99,6 +138,13 @@ AlbumProxyModel::lessThan( const QModelIndex& left, const QModelIndex& right ) c
     if ( !p2 )
         return false;
 
+    // sorted on the worker thread already, as long as no row changed since
+    if ( !left.parent().isValid() && !right.parent().isValid() &&
+         left.row() < m_sortPositions.count() && right.row() < m_sortPositions.count() )
+    {
+        return m_sortPositions.at( left.row() ) < m_sortPositions.at( right.row() );
+    }
+
     if ( p1->album().isNull() || p1->album()->artist().isNull() )
         return true;
 
@@ -141,6 +187,175 @@ AlbumProxyModel::removeIndexes( const QList<QModelIndex>& indexes )
 }
 
 
+void
+AlbumProxyModel::sort( int column, Qt::SortOrder order )
+{
+    cancelSort();
+
+    if ( !m_model || m_model->rowCount( QModelIndex() ) < SORTKEYS_ASYNC_ROWS )
+    {
+        QSortFilterProxyModel::sort( column, order );
+        return;
+    }
+
+    const int job = m_sortGeneration->fetchAndAddOrdered( 1 ) + 1;
+    m_pendingSortColumn = column;
+    m_pendingSortOrder = order;
+    m_pendingSortRevision = m_keysRevision;
+
+    m_sortWatcher = new QFutureWatcher< QVector< int > >( this );
+    connect( m_sortWatcher, SIGNAL( finished() ), SLOT( onSortFinished() ) );
+    m_sortWatcher->setFuture( QtConcurrent::run( &SortKeys::sortPositions, sortKeys(), m_sortGeneration, job ) );
+}
+
+
+void
+AlbumProxyModel::onSortFinished()
+{
+    QFutureWatcher< QVector< int > >* watcher = m_sortWatcher;
+    m_sortWatcher = 0;
+    watcher->deleteLater();
+
+    // if the rows changed meanwhile lessThan() compares them itself
+    const QVector< int > positions = watcher->result();
+    if ( !positions.isEmpty() && m_pendingSortRevision == m_keysRevision )
+        m_sortPositions = positions;
+
+    // a single re-sort that only compares the positions, one layout change for the views
+    QSortFilterProxyModel::sort( m_pendingSortColumn, m_pendingSortOrder );
+}
+
+
+void
+AlbumProxyModel::newFilterFromPlaylistInterface( const QString& pattern )
+{
+    cancelMatches();
+
+    if ( pattern.isEmpty() || !m_model || m_model->rowCount( QModelIndex() ) < SORTKEYS_ASYNC_ROWS )
+    {
+        applyFilter( pattern );
+        return;
+    }
+
+    const int job = m_matchesGeneration->fetchAndAddOrdered( 1 ) + 1;
+    m_pendingFilter = pattern;
+    m_pendingMatchesRevision = m_keysRevision;
+
+    m_matchesWatcher = new QFutureWatcher< QBitArray >( this );
+    connect( m_matchesWatcher, SIGNAL( finished() ), SLOT( onMatchesFinished() ) );
+    m_matchesWatcher->setFuture( QtConcurrent::run( &SortKeys::filterMatches, sortKeys(), SortKeys::filterTokens( pattern ), m_matchesGeneration, job ) );
+}
+
+
+void
+AlbumProxyModel::onMatchesFinished()
+{
+    QFutureWatcher< QBitArray >* watcher = m_matchesWatcher;
+    m_matchesWatcher = 0;
+    watcher->deleteLater();
+
+    // if the rows changed meanwhile filterAcceptsRow() matches them itself
+    const QBitArray matched = watcher->result();
+    if ( !matched.isNull() && m_pendingMatchesRevision == m_keysRevision )
+    {
+        m_matched = matched;
+        m_matchedPattern = m_pendingFilter;
+    }
+
+    applyFilter( m_pendingFilter );
+}
+
+
+void
+AlbumProxyModel::applyFilter( const QString& pattern )
+{
+    setFilterRegExp( pattern );
+    emit filterChanged( pattern );
+}
+
+
+SortKeys
+AlbumProxyModel::sortKeys() const
+{
+    // albums sort by artist name, then by their own name
+    SortKeys keys;
+
+    const int rows = m_model->rowCount( QModelIndex() );
+    keys.rows.resize( rows );
+    for ( int i = 0; i < rows; i++ )
+    {
+        AlbumItem* item = m_model->itemFromIndex( m_model->index( i, 0, QModelIndex() ) );
+        if ( !item )
+            continue;
+
+        SortKeys::Row& row = keys.rows[i];
+        if ( item->album().isNull() || item->album()->artist().isNull() )
+        {
+            if ( !item->artist().isNull() )
+                row.name = keys.strings.intern( item->artist()->name() );
+
+            continue;
+        }
+
+        // rows without an album or artist come first
+        row.discnumber = 1;
+        row.sortname = keys.strings.intern( item->album()->artist()->name() );
+        row.secondarySortname = keys.strings.intern( item->album()->name() );
+        row.name = row.secondarySortname;
+        row.artistName = row.sortname;
+    }
+
+    return keys;
+}
+
+
+void
+AlbumProxyModel::invalidateKeys()
+{
+    m_keysRevision++;
+    m_sortPositions.clear();
+    m_matched = QBitArray();
+    m_matchedPattern.clear();
+}
+
+
+void
+AlbumProxyModel::cancelSort()
+{
+    m_sortGeneration->ref();
+
+    if ( !m_sortWatcher )
+        return;
+
+    // the job notices the new generation and stops early, its watcher goes away once it did
+    disconnect( m_sortWatcher, SIGNAL( finished() ), this, SLOT( onSortFinished() ) );
+    if ( m_sortWatcher->isFinished() )
+        m_sortWatcher->deleteLater();
+    else
+        connect( m_sortWatcher, SIGNAL( finished() ), m_sortWatcher, SLOT( deleteLater() ) );
+
+    m_sortWatcher = 0;
+}
+
+
+void
+AlbumProxyModel::cancelMatches()
+{
+    m_matchesGeneration->ref();
+
+    if ( !m_matchesWatcher )
+        return;
+
+    disconnect( m_matchesWatcher, SIGNAL( finished() ), this, SLOT( onMatchesFinished() ) );
+    if ( m_matchesWatcher->isFinished() )
+        m_matchesWatcher->deleteLater();
+    else
+        connect( m_matchesWatcher, SIGNAL( finished() ), m_matchesWatcher, SLOT( deleteLater() ) );
+
+    m_matchesWatcher = 0;
+}
+
+
 Tomahawk::playlistinterface_ptr
 AlbumProxyModel::playlistInterface()
 {
@@ -20,10 +20,12 @@
 #ifndef ALBUMPROXYMODEL_H
 #define ALBUMPROXYMODEL_H
 
+#include <QtCore/QFutureWatcher>
 #include <QSortFilterProxyModel>
 
 #include "playlistinterface.h"
 #include "playlist/albummodel.h"
+#include "playlist/sortkeys.h"
 
 #include "dllmacro.h"
 
@@ -33,7 +35,8 @@ Q_OBJECT
 
 public:
     explicit AlbumProxyModel( QObject* parent = 0 );
-    virtual ~AlbumProxyModel() {}
+    // stops running jobs early, their results aren't needed anymore
+    virtual ~AlbumProxyModel() { m_sortGeneration->ref(); m_matchesGeneration->ref(); }
 
     virtual AlbumModel* sourceModel() const { return m_model; }
     virtual void setSourceAlbumModel( AlbumModel* sourceModel );
@@ -45,6 +48,11 @@ public:
     virtual void removeIndexes( const QList<QModelIndex>& indexes );
 
     virtual void emitFilterChanged( const QString &pattern ) { emit filterChanged( pattern ); }
+    // large models get matched on a worker thread, filterChanged() is emitted once the filter got applied
+    virtual void newFilterFromPlaylistInterface( const QString& pattern );
+
+    // large models get sorted on a worker thread, the new order is applied in one go when it's done
+    virtual void sort( int column, Qt::SortOrder order = Qt::AscendingOrder );
 
     virtual Tomahawk::playlistinterface_ptr playlistInterface();
 
@@ -55,9 +63,44 @@ protected:
     bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const;
     bool lessThan( const QModelIndex& left, const QModelIndex& right ) const;
 
+private slots:
+    void invalidateKeys();
+
+    void onSortFinished();
+    void onMatchesFinished();
+
 private:
+    SortKeys sortKeys() const;
+    void applyFilter( const QString& pattern );
+    void cancelSort();
+    void cancelMatches();
+
     AlbumModel* m_model;
 
+    // normalised filter words, split once per filter instead of once per row
+    mutable QString m_filterPattern;
+    mutable QStringList m_filterTokens;
+
+    // bumped whenever rows change, results of jobs started before are outdated
+    unsigned int m_keysRevision;
+
+    // jobs check their generation and give up once a newer job bumped it
+    QFutureWatcher< QVector< int > >* m_sortWatcher;
+    QSharedPointer< QAtomicInt > m_sortGeneration;
+    int m_pendingSortColumn;
+    Qt::SortOrder m_pendingSortOrder;
+    unsigned int m_pendingSortRevision;
+    // position of every source row in the order computed by the last sort job
+    QVector< int > m_sortPositions;
+
+    QFutureWatcher< QBitArray >* m_matchesWatcher;
+    QSharedPointer< QAtomicInt > m_matchesGeneration;
+    QString m_pendingFilter;
+    unsigned int m_pendingMatchesRevision;
+    // whether each source row matches m_matchedPattern, null unless a job computed it
+    QBitArray m_matched;
+    QString m_matchedPattern;
+
     Tomahawk::playlistinterface_ptr m_playlistInterface;
 };
 
@@ -87,8 +87,7 @@ AlbumProxyModelPlaylistInterface::setFilter( const QString& pattern )
     if ( m_proxyModel.isNull() )
         return;
 
-    m_proxyModel.data()->setFilterRegExp( pattern );
-    m_proxyModel.data()->emitFilterChanged( pattern );
+    m_proxyModel.data()->newFilterFromPlaylistInterface( pattern );
 }
 
 
@@ -27,7 +27,9 @@ using namespace Tomahawk;
 
 CollectionFlatModel::CollectionFlatModel( QObject* parent )
     : TrackModel( parent )
+    , m_generation( 0 )
 {
+    setQueryCacheSize( COLLECTIONFLATMODEL_CACHED_PAGES * COLLECTIONFLATMODEL_PAGE_SIZE );
 }
 
 
@@ -60,11 +62,14 @@ CollectionFlatModel::addCollection( const collection_ptr& collection, bool sendN
     if ( sendNotifications )
         emit loadingStarted();
 
-    DatabaseCommand_AllTracks* cmd = new DatabaseCommand_AllTracks( collection );
-    connect( cmd, SIGNAL( tracks( QList<Tomahawk::query_ptr>, QVariant ) ),
-                    SLOT( onTracksAdded( QList<Tomahawk::query_ptr> ) ), Qt::QueuedConnection );
-
-    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+    // only the first page is loaded right away, views fetch the rest on demand
+    CollectionPage page;
+    page.collection = collection;
+    page.started = false;
+    page.fetching = false;
+    page.complete = false;
+    m_pages << page;
+    fetchPage( m_pages.last() );
 
     m_loadingCollections << collection.data();
 
@@ -113,6 +118,168 @@ CollectionFlatModel::onTracksAdded( const QList<Tomahawk::query_ptr>& tracks )
 }
 
 
+void
+CollectionFlatModel::fetchPage( CollectionPage& page )
+{
+    if ( page.fetching || page.complete )
+        return;
+
+    page.fetching = true;
+
+    DatabaseCommand_AllTracks* cmd = new DatabaseCommand_AllTracks( page.collection );
+    if ( page.started )
+        cmd->setStartAfter( page.last );
+    cmd->setLimit( COLLECTIONFLATMODEL_PAGE_SIZE );
+    cmd->setSortOrder( DatabaseCommand_AllTracks::Artist );
+    cmd->setFilter( m_filter );
+    // rows only get a Query once they are shown or played
+    cmd->setEmitRecords( true );
+
+    QVariantMap data;
+    data[ "source" ] = page.collection->source()->id();
+    data[ "generation" ] = m_generation;
+    cmd->setData( data );
+
+    connect( cmd, SIGNAL( records( QList<TrackStore::Record>, QVariant ) ),
+                    SLOT( onPageLoaded( QList<TrackStore::Record>, QVariant ) ), Qt::QueuedConnection );
+
+    Database::instance()->enqueue( QSharedPointer<DatabaseCommand>( cmd ) );
+}
+
+
+void
+CollectionFlatModel::onPageLoaded( const QList<TrackStore::Record>& tracks, const QVariant& data )
+{
+    // the model got cleared or filtered differently while this page was loading
+    const QVariantMap map = data.toMap();
+    if ( map.value( "generation" ).toUInt() != m_generation )
+        return;
+
+    bool found = false, fetching = false;
+    for ( int i = 0; i < m_pages.count(); i++ )
+    {
+        CollectionPage& page = m_pages[i];
+        if ( page.fetching && page.collection->source()->id() == map.value( "source" ).toInt() )
+        {
+            qDebug() << Q_FUNC_INFO << page.collection->source()->userName() << tracks.count();
+
+            found = true;
+            page.fetching = false;
+            if ( !tracks.isEmpty() )
+            {
+                page.last = tracks.last();
+                page.started = true;
+            }
+            page.complete = ( tracks.count() < COLLECTIONFLATMODEL_PAGE_SIZE );
+
+            m_loadingCollections.removeAll( page.collection.data() );
+        }
+
+        fetching = fetching || page.fetching;
+    }
+
+    if ( !found )
+        return;
+
+    appendRecords( tracks );
+
+    if ( !fetching && m_loadingCollections.isEmpty() )
+        emit loadingFinished();
+}
+
+
+bool
+CollectionFlatModel::canFetchMore( const QModelIndex& parent ) const
+{
+    if ( parent.isValid() )
+        return false;
+
+    foreach ( const CollectionPage& page, m_pages )
+    {
+        if ( page.fetching )
+            return false;
+    }
+
+    foreach ( const CollectionPage& page, m_pages )
+    {
+        if ( !page.complete )
+            return true;
+    }
+
+    return false;
+}
+
+
+void
+CollectionFlatModel::fetchMore( const QModelIndex& parent )
+{
+    if ( !canFetchMore( parent ) )
+        return;
+
+    for ( int i = 0; i < m_pages.count(); i++ )
+    {
+        if ( !m_pages.at( i ).complete )
+        {
+            fetchPage( m_pages[i] );
+            break;
+        }
+    }
+}
+
+
+void
+CollectionFlatModel::setFilter( const QString& pattern )
+{
+    if ( pattern == m_filter )
+        return;
+
+    m_filter = pattern;
+    if ( m_pages.isEmpty() )
+        return;
+
+    // start over with only the matching tracks, the database filters them a page at a time
+    QList< CollectionPage > pages = m_pages;
+    m_generation++;
+    m_pages.clear();
+    TrackModel::clear();
+
+    emit loadingStarted();
+
+    foreach ( CollectionPage page, pages )
+    {
+        page.started = false;
+        page.fetching = false;
+        page.complete = false;
+        m_pages << page;
+        fetchPage( m_pages.last() );
+
+        m_loadingCollections << page.collection.data();
+    }
+}
+
+
+void
+CollectionFlatModel::setCurrentItem( const QModelIndex& index )
+{
+    TrackModel::setCurrentItem( index );
+
+    // keep loading ahead of the playing track, so playback doesn't stop at the end of the loaded pages
+    if ( index.isValid() && index.row() >= rowCount( QModelIndex() ) - COLLECTIONFLATMODEL_PAGE_SIZE / 2 )
+        fetchMore( QModelIndex() );
+}
+
+
+void
+CollectionFlatModel::clear()
+{
+    m_pages.clear();
+    m_loadingCollections.clear();
+    m_generation++;
+
+    TrackModel::clear();
+}
+
+
 void
 CollectionFlatModel::onTracksRemoved( const QList<Tomahawk::query_ptr>& tracks )
 {
@@ -121,7 +288,8 @@ CollectionFlatModel::onTracksRemoved( const QList<Tomahawk::query_ptr>& tracks )
     {
         QModelIndex idx = index( i, 0, QModelIndex() );
         TrackModelItem* item = itemFromIndex( idx );
-        if ( !item )
+        // rows without a Query can't be one of the removed ones
+        if ( !item || !item->hasQuery() )
             continue;
 
         int j = 0;
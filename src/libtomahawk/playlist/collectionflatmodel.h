@@ -34,6 +34,11 @@
 
 #include "dllmacro.h"
 
+// number of tracks fetched from the database at once when loading a collection
+#define COLLECTIONFLATMODEL_PAGE_SIZE (500)
+// how many pages worth of rows keep their Query, the others create it again when needed
+#define COLLECTIONFLATMODEL_CACHED_PAGES (4)
+
 class QMetaData;
 
 class DLLEXPORT CollectionFlatModel : public TrackModel
@@ -50,6 +55,14 @@ public:
     void addCollection( const Tomahawk::collection_ptr& collection, bool sendNotifications = true );
     void addFilteredCollection( const Tomahawk::collection_ptr& collection, unsigned int amount, DatabaseCommand_AllTracks::SortOrder order );
 
+    virtual bool canFetchMore( const QModelIndex& parent ) const;
+    virtual void fetchMore( const QModelIndex& parent );
+    virtual void setFilter( const QString& pattern );
+
+public slots:
+    virtual void setCurrentItem( const QModelIndex& index );
+    virtual void clear();
+
 signals:
     void repeatModeChanged( Tomahawk::PlaylistInterface::RepeatMode mode );
     void shuffleModeChanged( bool enabled );
@@ -62,7 +75,27 @@ private slots:
     void onTracksAdded( const QList<Tomahawk::query_ptr>& tracks );
     void onTracksRemoved( const QList<Tomahawk::query_ptr>& tracks );
 
+    void onPageLoaded( const QList<TrackStore::Record>& tracks, const QVariant& data );
+
 private:
+    struct CollectionPage
+    {
+        Tomahawk::collection_ptr collection;
+        // the last track loaded so far, the next page starts after it
+        TrackStore::Record last;
+        bool started;
+        bool fetching;
+        bool complete;
+    };
+
+    void fetchPage( CollectionPage& page );
+
+    // collections loaded page by page, in the order they were added
+    QList< CollectionPage > m_pages;
+    // bumped on clear() and filter changes, pages of an older generation are dropped when they arrive
+    unsigned int m_generation;
+    QString m_filter;
+
     QMap< Tomahawk::collection_ptr, QPair< int, int > > m_collectionRows;
     QList<Tomahawk::query_ptr> m_tracksToAdd;
     // just to keep track of what we are waiting to be loaded
@@ -19,6 +19,8 @@
 
 #include "customplaylistview.h"
 
+#include "trackmodelitem.h"
+
 #include "database/databasecommand_genericselect.h"
 #include "database/database.h"
 #include "utils/tomahawkutils.h"
@@ -105,12 +107,41 @@ CustomPlaylistView::generateTracks()
 void
 CustomPlaylistView::tracksGenerated( QList< query_ptr > tracks )
 {
-    bool changed = false;
-    QList< query_ptr > newTracks = TomahawkUtils::mergePlaylistChanges( m_model->queries(), tracks, changed);
+    // compares names, only the rows that are kept need their Query
+    const QList< TrackModel::RowData > rows = m_model->rowData();
+    QList< int > keptRows;
+    foreach ( const query_ptr& query, tracks )
+    {
+        int keptRow = -1;
+        for ( int row = 0; row < rows.count(); row++ )
+        {
+            if ( rows.at( row ).track == query->track() &&
+                 rows.at( row ).artist == query->artist() &&
+                 rows.at( row ).album == query->album() )
+            {
+                keptRow = row;
+                break;
+            }
+        }
+
+        keptRows << keptRow;
+    }
 
-    if ( !changed )
+    // No work to be done if all are the same
+    if ( rows.count() == tracks.count() && !keptRows.contains( -1 ) )
         return;
 
+    QList< query_ptr > newTracks = tracks;
+    for ( int i = 0; i < keptRows.count(); i++ )
+    {
+        if ( keptRows.at( i ) < 0 )
+            continue;
+
+        TrackModelItem* item = m_model->itemFromIndex( m_model->index( keptRows.at( i ), 0, QModelIndex() ) );
+        if ( item && !item->query().isNull() )
+            newTracks[ i ] = item->query();
+    }
+
     m_model->clear();
     m_model->append( newTracks );
 }
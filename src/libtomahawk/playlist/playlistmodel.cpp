@@ -212,6 +212,7 @@ PlaylistModel::insert( const QList< Tomahawk::plentry_ptr >& entries, int row )
     {
         plitem = new TrackModelItem( entry, rootItem(), row + i );
         plitem->index = createIndex( row + i, 0, plitem );
+        addToStore( plitem );
         i++;
 
         if ( entry->query()->id() == currentItemUuid() )
@@ -0,0 +1,131 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "sortkeys.h"
+
+#include <QtCore/QRegExp>
+
+#include <algorithm>
+
+
+namespace
+{
+    struct RowLessThan
+    {
+        RowLessThan( const SortKeys& keys ) : keys( keys ) {}
+
+        bool operator()( int r1, int r2 ) const
+        {
+            const SortKeys::Row& row1 = keys.rows.at( r1 );
+            const SortKeys::Row& row2 = keys.rows.at( r2 );
+
+            if ( row1.discnumber != row2.discnumber )
+                return row1.discnumber < row2.discnumber;
+            if ( row1.albumpos != row2.albumpos )
+                return row1.albumpos < row2.albumpos;
+
+            const int sortname1 = keys.strings.rank( row1.sortname );
+            const int sortname2 = keys.strings.rank( row2.sortname );
+            if ( sortname1 != sortname2 )
+                return sortname1 < sortname2;
+
+            const int secondary1 = keys.strings.rank( row1.secondarySortname );
+            const int secondary2 = keys.strings.rank( row2.secondarySortname );
+            if ( secondary1 != secondary2 )
+                return secondary1 < secondary2;
+
+            return r1 < r2;
+        }
+
+        const SortKeys& keys;
+    };
+}
+
+
+QVector< int >
+SortKeys::sortPositions( const SortKeys& keys, QSharedPointer< QAtomicInt > generation, int job )
+{
+    // ranks are computed lazily, get that done before the sorting starts
+    keys.strings.rank( 0 );
+
+    if ( *generation != job )
+        return QVector< int >();
+
+    QVector< int > rows( keys.rows.count() );
+    for ( int i = 0; i < rows.count(); i++ )
+        rows[i] = i;
+
+    std::sort( rows.begin(), rows.end(), RowLessThan( keys ) );
+
+    if ( *generation != job )
+        return QVector< int >();
+
+    QVector< int > positions( rows.count() );
+    for ( int i = 0; i < rows.count(); i++ )
+        positions[ rows.at( i ) ] = i;
+
+    return positions;
+}
+
+
+QBitArray
+SortKeys::filterMatches( const SortKeys& keys, const QStringList& tokens, QSharedPointer< QAtomicInt > generation, int job )
+{
+    QBitArray matched( keys.rows.count() );
+
+    for ( int row = 0; row < keys.rows.count(); row++ )
+    {
+        if ( !( row % 4096 ) && *generation != job )
+            return QBitArray();
+
+        if ( keys.matches( row, tokens ) )
+            matched.setBit( row );
+    }
+
+    return matched;
+}
+
+
+bool
+SortKeys::matches( int row, const QStringList& tokens ) const
+{
+    const Row& r = rows.at( row );
+    const QString& name = strings.key( r.name );
+    const QString& artistName = strings.key( r.artistName );
+    const QString& albumName = strings.key( r.albumName );
+
+    foreach ( const QString& token, tokens )
+    {
+        if ( !name.contains( token ) &&
+             !artistName.contains( token ) &&
+             !albumName.contains( token ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+QStringList
+SortKeys::filterTokens( const QString& pattern )
+{
+    return StringPool::searchKey( pattern ).split( QRegExp( "\\s" ), QString::SkipEmptyParts );
+}
@@ -0,0 +1,74 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SORTKEYS_H
+#define SORTKEYS_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QBitArray>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "trackstore.h"
+
+#include "dllmacro.h"
+
+// proxies with at least this many top level rows get sorted and filtered on a worker thread
+#define SORTKEYS_ASYNC_ROWS (5000)
+
+/*
+    Snapshot of what a TreeProxyModel or AlbumProxyModel sorts and filters its
+    top level rows on. Strings are ids in a copy of a StringPool, so the jobs
+    below can rank and match them on a worker thread while the model changes.
+*/
+class DLLEXPORT SortKeys
+{
+public:
+    struct Row
+    {
+        Row() : discnumber( 0 ), albumpos( 0 ), sortname( 0 ), secondarySortname( 0 ), name( 0 ), artistName( 0 ), albumName( 0 ) {}
+
+        // compared first, as numbers
+        unsigned int discnumber;
+        unsigned int albumpos;
+        // then by their locale aware rank
+        int sortname;
+        int secondarySortname;
+        // the filter tokens are looked for in these
+        int name;
+        int artistName;
+        int albumName;
+    };
+
+    StringPool strings;
+    QVector< Row > rows;
+
+    // position of every row in ascending order, equal rows keep their order. Empty if the job got superseded
+    static QVector< int > sortPositions( const SortKeys& keys, QSharedPointer< QAtomicInt > generation, int job );
+    // rows whose names contain each of tokens (normalised with StringPool::searchKey()). Null if the job got superseded
+    static QBitArray filterMatches( const SortKeys& keys, const QStringList& tokens, QSharedPointer< QAtomicInt > generation, int job );
+
+    // true if every token is part of one of row's names
+    bool matches( int row, const QStringList& tokens ) const;
+    // pattern split into words normalised like StringPool keys
+    static QStringList filterTokens( const QString& pattern );
+};
+
+#endif // SORTKEYS_H
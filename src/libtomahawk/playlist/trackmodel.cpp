@@ -22,8 +22,11 @@
 
 #include <QDateTime>
 #include <QMimeData>
+#include <QTimer>
 #include <QTreeView>
 
+#include <algorithm>
+
 #include "audio/audioengine.h"
 #include "utils/tomahawkutils.h"
 
@@ -35,9 +38,23 @@
 using namespace Tomahawk;
 
 
+namespace
+{
+    struct LastUseLessThan
+    {
+        bool operator()( TrackModelItem* left, TrackModelItem* right ) const
+        {
+            return left->lastUse() < right->lastUse();
+        }
+    };
+}
+
+
 TrackModel::TrackModel( QObject* parent )
     : QAbstractItemModel( parent )
     , m_rootItem( new TrackModelItem( 0, this ) )
+    , m_queryCacheSize( TRACKMODEL_QUERY_CACHE_SIZE )
+    , m_releasePending( false )
     , m_readOnly( true )
     , m_style( Detailed )
 {
@@ -152,6 +169,9 @@ TrackModel::data( const QModelIndex& index, int role ) const
         return QVariant();
 
     const query_ptr& query = entry->query();
+    if ( query.isNull() )
+        return QVariant();
+
     if ( !query->numResults() )
     {
         switch( index.column() )
@@ -342,6 +362,10 @@ TrackModel::mimeData( const QModelIndexList &indexes ) const
     QByteArray queryData;
     QDataStream queryStream( &queryData, QIODevice::WriteOnly );
 
+    // items created from TrackStore rows may give up their Query before the drop,
+    // so stream the addresses of our own references
+    m_dragQueries.clear();
+
     foreach ( const QModelIndex& i, indexes )
     {
         if ( i.column() > 0 )
@@ -349,10 +373,10 @@ TrackModel::mimeData( const QModelIndexList &indexes ) const
 
         QModelIndex idx = index( i.row(), 0, i.parent() );
         TrackModelItem* item = itemFromIndex( idx );
-        if ( item )
+        if ( item && !item->query().isNull() )
         {
-            const query_ptr& query = item->query();
-            queryStream << qlonglong( &query );
+            m_dragQueries << item->query();
+            queryStream << qlonglong( &m_dragQueries.last() );
         }
     }
 
@@ -374,6 +398,8 @@ TrackModel::clear()
         delete m_rootItem;
         m_rootItem = 0;
         m_rootItem = new TrackModelItem( 0, this );
+        m_store.clear();
+        m_queryItems.clear();
         emit endResetModel();
     }
 }
@@ -387,13 +413,124 @@ TrackModel::queries() const
     QList< query_ptr > tracks;
     foreach ( TrackModelItem* item, m_rootItem->children )
     {
-        tracks << item->query();
+        if ( !item->query().isNull() )
+            tracks << item->query();
     }
 
     return tracks;
 }
 
 
+QList< TrackModel::RowData >
+TrackModel::rowData() const
+{
+    Q_ASSERT( m_rootItem );
+
+    QList< RowData > rows;
+    foreach ( TrackModelItem* item, m_rootItem->children )
+    {
+        // the store keeps the names of a row's best result, those of a Query-less row are its file's
+        RowData row;
+        if ( !item->hasQuery() )
+        {
+            row.artist = m_store.strings().string( m_store.artist( item->storeRow ) );
+            row.album = m_store.strings().string( m_store.album( item->storeRow ) );
+            row.track = m_store.strings().string( m_store.track( item->storeRow ) );
+        }
+        else if ( !item->query().isNull() )
+        {
+            row.artist = item->query()->artist();
+            row.album = item->query()->album();
+            row.track = item->query()->track();
+        }
+
+        rows << row;
+    }
+
+    return rows;
+}
+
+
+void
+TrackModel::appendRecords( const QList< TrackStore::Record >& records )
+{
+    if ( !records.count() )
+    {
+        emit trackCountChanged( rowCount( QModelIndex() ) );
+        return;
+    }
+
+    const int row = rowCount( QModelIndex() );
+    emit beginInsertRows( QModelIndex(), row, row + records.count() - 1 );
+
+    int i = 0;
+    TrackModelItem* plitem;
+    foreach ( const TrackStore::Record& record, records )
+    {
+        plitem = new TrackModelItem( m_rootItem, m_store.add( record ), row + i );
+        plitem->index = createIndex( row + i, 0, plitem );
+        i++;
+
+        connect( plitem, SIGNAL( dataChanged() ), SLOT( onDataChanged() ) );
+    }
+
+    emit endInsertRows();
+    emit trackCountChanged( rowCount( QModelIndex() ) );
+}
+
+
+void
+TrackModel::onQueryCreated( TrackModelItem* item )
+{
+    m_queryItems << item;
+
+    // not right away, the item's Query is still being used by whoever asked for it
+    if ( m_queryItems.count() > m_queryCacheSize && !m_releasePending )
+    {
+        m_releasePending = true;
+        QTimer::singleShot( 0, this, SLOT( releaseQueries() ) );
+    }
+}
+
+
+void
+TrackModel::releaseQueries()
+{
+    m_releasePending = false;
+
+    QList< TrackModelItem* > items;
+    foreach ( const QPointer< TrackModelItem >& item, m_queryItems )
+    {
+        if ( !item.isNull() && item->hasQuery() )
+            items << item.data();
+    }
+
+    // release down to three quarters of the cache, so this doesn't run again for every single new Query
+    if ( items.count() > m_queryCacheSize )
+    {
+        std::sort( items.begin(), items.end(), LastUseLessThan() );
+
+        TrackModelItem* current = itemFromIndex( m_currentIndex );
+        const int release = items.count() - m_queryCacheSize * 3 / 4;
+        for ( int i = 0; i < release; i++ )
+        {
+            TrackModelItem* item = items.at( i );
+            if ( item == current || item->isPlaying() )
+                continue;
+
+            item->releaseQuery();
+        }
+    }
+
+    m_queryItems.clear();
+    foreach ( TrackModelItem* item, items )
+    {
+        if ( item->hasQuery() )
+            m_queryItems << item;
+    }
+}
+
+
 void
 TrackModel::append( const Tomahawk::query_ptr& query )
 {
@@ -443,6 +580,7 @@ TrackModel::insert( const QList< Tomahawk::query_ptr >& queries, int row )
     {
         plitem = new TrackModelItem( query, m_rootItem, row + i );
         plitem->index = createIndex( row + i, 0, plitem );
+        addToStore( plitem );
         i++;
 
         if ( query->id() == currentItemUuid() )
@@ -482,6 +620,7 @@ TrackModel::remove( const QModelIndex& index, bool moreToCome )
     if ( item )
     {
         emit beginRemoveRows( index.parent(), index.row(), index.row() );
+        m_store.remove( item->storeRow );
         delete item;
         emit endRemoveRows();
     }
@@ -522,6 +661,13 @@ TrackModel::remove( const QList<QPersistentModelIndex>& indexes )
 }
 
 
+void
+TrackModel::addToStore( TrackModelItem* item )
+{
+    item->storeRow = m_store.add( item->query() );
+}
+
+
 TrackModelItem*
 TrackModel::itemFromIndex( const QModelIndex& index ) const
 {
@@ -563,9 +709,14 @@ TrackModel::ensureResolved()
 {
     for( int i = 0; i < rowCount( QModelIndex() ); i++ )
     {
-        query_ptr query = itemFromIndex( index( i, 0, QModelIndex() ) )->query();
+        TrackModelItem* item = itemFromIndex( index( i, 0, QModelIndex() ) );
 
-        if ( !query->resolvingFinished() )
+        // rows created from the TrackStore are resolved to their file already
+        if ( !item->hasQuery() )
+            continue;
+
+        const query_ptr& query = item->query();
+        if ( !query.isNull() && !query->resolvingFinished() )
             Pipeline::instance()->resolve( query );
     }
 }
@@ -602,6 +753,9 @@ void
 TrackModel::onDataChanged()
 {
     TrackModelItem* p = (TrackModelItem*)sender();
+    if ( p && p->hasQuery() )
+        m_store.update( p->storeRow, p->query() );
+
     if ( p && p->index.isValid() )
         emit dataChanged( p->index, p->index.sibling( p->index.row(), columnCount() - 1 ) );
 }
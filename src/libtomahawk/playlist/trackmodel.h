@@ -22,13 +22,18 @@
 #define TRACKMODEL_H
 
 #include <QAbstractItemModel>
+#include <QPointer>
 
 #include "playlistinterface.h"
 #include "trackmodelitem.h"
+#include "trackstore.h"
 #include "typedefs.h"
 
 #include "dllmacro.h"
 
+// number of items created from TrackStore rows that keep their Query around, see TrackModel::setQueryCacheSize()
+#define TRACKMODEL_QUERY_CACHE_SIZE (2000)
+
 class QMetaData;
 
 class DLLEXPORT TrackModel : public QAbstractItemModel
@@ -94,13 +99,32 @@ public:
     virtual bool shuffled() const { return false; }
 
     virtual void ensureResolved();
+    /// Lazily populated models reload with only the rows matching pattern, instead of loading everything to filter it
+    virtual void setFilter( const QString& pattern ) { Q_UNUSED( pattern ); }
 
     TrackModelItem* itemFromIndex( const QModelIndex& index ) const;
-    /// Returns a flat list of all tracks in this model
+    /// Returns a flat list of all tracks in this model, creating the Queries of rows that don't have one
     QList< Tomahawk::query_ptr > queries() const;
 
+    struct RowData
+    {
+        QString artist;
+        QString album;
+        QString track;
+    };
+    /// Names of all top level rows, read from the TrackStore, so no Query gets created for them
+    QList< RowData > rowData() const;
+
+    /// Appends rows kept in the TrackStore only, their Query is created on first use
+    void appendRecords( const QList< TrackStore::Record >& records );
+    /// How many of those rows keep their Query, the least recently used ones give it up again
+    void setQueryCacheSize( int size ) { m_queryCacheSize = size; }
+
     void updateDetailedInfo( const QModelIndex& index );
 
+    /// Interned, columnar copy of the sort and filter fields of all items
+    const TrackStore& store() const { return m_store; }
+
 signals:
     void repeatModeChanged( Tomahawk::PlaylistInterface::RepeatMode mode );
     void shuffleModeChanged( bool enabled );
@@ -133,17 +157,31 @@ public slots:
 
 protected:
     TrackModelItem* rootItem() const { return m_rootItem; }
+    void addToStore( TrackModelItem* item );
 
 private slots:
     void onDataChanged();
+    void releaseQueries();
 
     void onPlaybackStarted( const Tomahawk::result_ptr& result );
     void onPlaybackStopped();
 
 private:
+    friend class TrackModelItem;
+
     Qt::Alignment columnAlignment( int column ) const;
+    void onQueryCreated( TrackModelItem* item );
 
     TrackModelItem* m_rootItem;
+    TrackStore m_store;
+
+    // items created from TrackStore rows which currently have a Query
+    QList< QPointer< TrackModelItem > > m_queryItems;
+    int m_queryCacheSize;
+    bool m_releasePending;
+    // queries of the last drag, mimeData() refers to them by address
+    mutable QList< Tomahawk::query_ptr > m_dragQueries;
+
     QPersistentModelIndex m_currentIndex;
     Tomahawk::QID m_currentUuid;
 
@@ -21,11 +21,14 @@
 
 #include "playlist.h"
 #include "query.h"
+#include "trackmodel.h"
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
 using namespace Tomahawk;
 
+static unsigned int s_lastUse = 0;
+
 
 TrackModelItem::~TrackModelItem()
 {
@@ -48,7 +51,10 @@ TrackModelItem::TrackModelItem( TrackModelItem* parent, QAbstractItemModel* mode
     this->model = model;
     childCount = 0;
     toberemoved = false;
+    storeRow = -1;
     m_isPlaying = false;
+    m_fromStore = false;
+    m_lastUse = 0;
 
     if ( parent )
     {
@@ -72,6 +78,16 @@ TrackModelItem::TrackModelItem( const Tomahawk::plentry_ptr& entry, TrackModelIt
 }
 
 
+TrackModelItem::TrackModelItem( TrackModelItem* parent, int storeRow, int row )
+    : QObject( parent )
+{
+    setupItem( query_ptr(), parent, row );
+
+    this->storeRow = storeRow;
+    m_fromStore = true;
+}
+
+
 const Tomahawk::plentry_ptr&
 TrackModelItem::entry() const
 {
@@ -80,12 +96,46 @@ TrackModelItem::entry() const
 
 
 const Tomahawk::query_ptr&
-TrackModelItem::query() const
+TrackModelItem::query()
 {
     if ( !m_entry.isNull() )
         return m_entry->query();
-    else
-        return m_query;
+
+    if ( m_fromStore )
+    {
+        m_lastUse = ++s_lastUse;
+        if ( m_query.isNull() )
+            createQuery();
+    }
+
+    return m_query;
+}
+
+
+void
+TrackModelItem::createQuery()
+{
+    TrackModel* trackModel = qobject_cast< TrackModel* >( model );
+    if ( !trackModel || storeRow < 0 )
+        return;
+
+    m_query = trackModel->store().query( storeRow );
+    if ( m_query.isNull() )
+        return;
+
+    connectQuery();
+    trackModel->onQueryCreated( this );
+}
+
+
+void
+TrackModelItem::releaseQuery()
+{
+    if ( !m_fromStore || m_query.isNull() )
+        return;
+
+    disconnect( m_query.data(), 0, this, 0 );
+    m_query.clear();
 }
 
 
@@ -110,11 +160,22 @@ TrackModelItem::setupItem( const Tomahawk::query_ptr& query, TrackModelItem* par
 
     m_isPlaying = false;
     toberemoved = false;
+    storeRow = -1;
+    m_fromStore = false;
+    m_lastUse = 0;
     m_query = query;
 
-    connect( query.data(), SIGNAL( resultsAdded( QList<Tomahawk::result_ptr> ) ), SIGNAL( dataChanged() ) );
-    connect( query.data(), SIGNAL( resultsRemoved( Tomahawk::result_ptr ) ), SIGNAL( dataChanged() ) );
-    connect( query.data(), SIGNAL( resultsChanged() ), SIGNAL( dataChanged() ) );
-    connect( query.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ) );
-    connect( query.data(), SIGNAL( socialActionsLoaded() ), SIGNAL( dataChanged() ) );
+    if ( !query.isNull() )
+        connectQuery();
+}
+
+
+void
+TrackModelItem::connectQuery()
+{
+    connect( m_query.data(), SIGNAL( resultsAdded( QList<Tomahawk::result_ptr> ) ), SIGNAL( dataChanged() ) );
+    connect( m_query.data(), SIGNAL( resultsRemoved( Tomahawk::result_ptr ) ), SIGNAL( dataChanged() ) );
+    connect( m_query.data(), SIGNAL( resultsChanged() ), SIGNAL( dataChanged() ) );
+    connect( m_query.data(), SIGNAL( updated() ), SIGNAL( dataChanged() ) );
+    connect( m_query.data(), SIGNAL( socialActionsLoaded() ), SIGNAL( dataChanged() ) );
 }
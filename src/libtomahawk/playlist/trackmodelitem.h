@@ -38,9 +38,19 @@ public:
     explicit TrackModelItem( TrackModelItem* parent = 0, QAbstractItemModel* model = 0 );
     explicit TrackModelItem( const Tomahawk::query_ptr& query, TrackModelItem* parent = 0, int row = -1 );
     explicit TrackModelItem( const Tomahawk::plentry_ptr& entry, TrackModelItem* parent = 0, int row = -1 );
+    // an item without a Query, it gets created from the model's TrackStore row when first asked for
+    explicit TrackModelItem( TrackModelItem* parent, int storeRow, int row );
 
     const Tomahawk::plentry_ptr& entry() const;
-    const Tomahawk::query_ptr& query() const;
+    // not const, an item created from a TrackStore row creates its Query here
+    const Tomahawk::query_ptr& query();
+
+    // false while an item created from a TrackStore row has no Query
+    bool hasQuery() const { return !m_fromStore || !m_query.isNull(); }
+    // lets an item created from a TrackStore row drop its Query again, see TrackModel::setQueryCacheSize()
+    void releaseQuery();
+    // increases every time query() of an item created from a TrackStore row is called
+    unsigned int lastUse() const { return m_lastUse; }
 
     bool isPlaying() { return m_isPlaying; }
     void setIsPlaying( bool b ) { m_isPlaying = b; emit dataChanged(); }
@@ -51,16 +61,23 @@ public:
     QPersistentModelIndex index;
     QAbstractItemModel* model;
     bool toberemoved;
+    // row of this item in its model's TrackStore
+    int storeRow;
 
 signals:
     void dataChanged();
 
 private:
     void setupItem( const Tomahawk::query_ptr& query, TrackModelItem* parent, int row = -1 );
+    void connectQuery();
+    void createQuery();
 
     Tomahawk::plentry_ptr m_entry;
     Tomahawk::query_ptr m_query;
     bool m_isPlaying;
+
+    bool m_fromStore;
+    unsigned int m_lastUse;
 };
 
 #endif // PLITEM_H
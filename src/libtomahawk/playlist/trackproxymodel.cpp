@@ -20,11 +20,16 @@
 #include "trackproxymodel.h"
 
 #include <QTreeView>
+#include <QtConcurrentRun>
+
+#include <algorithm>
 
 #include "trackproxymodelplaylistinterface.h"
 #include "artist.h"
 #include "album.h"
 #include "query.h"
+#include "source.h"
+#include "sourcelist.h"
 #include "utils/logger.h"
 
 
@@ -32,6 +37,13 @@ TrackProxyModel::TrackProxyModel( QObject* parent )
     : QSortFilterProxyModel( parent )
     , m_model( 0 )
     , m_showOfflineResults( true )
+    , m_matchesRevision( 0 )
+    , m_sortWatcher( 0 )
+    , m_sortGeneration( new QAtomicInt( 0 ) )
+    , m_sortPositionsColumn( -1 )
+    , m_sortPositionsRevision( 0 )
+    , m_filterWatcher( 0 )
+    , m_filterGeneration( new QAtomicInt( 0 ) )
 {
     setFilterCaseSensitivity( Qt::CaseInsensitive );
     setSortCaseSensitivity( Qt::CaseInsensitive );
@@ -55,6 +67,18 @@ TrackProxyModel::setSourceTrackModel( TrackModel* sourceModel )
 {
     m_model = sourceModel;
 
+    m_filterPattern.clear();
+    m_filterTokens.clear();
+    m_matched.clear();
+    m_tested.clear();
+    m_narrowMatched.clear();
+    m_narrowTested.clear();
+
+    cancelSort();
+    cancelFilter();
+    m_sortPositions.clear();
+    m_sortPositionsColumn = -1;
+
     if ( m_model && m_model->metaObject()->indexOfSignal( "trackCountChanged(uint)" ) > -1 )
         connect( m_model, SIGNAL( trackCountChanged( unsigned int ) ), playlistInterface().data(), SIGNAL( sourceTrackCountChanged( unsigned int ) ) );
 
@@ -69,48 +93,128 @@ TrackProxyModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceParen
     if ( !pi )
         return false;
 
-    const Tomahawk::query_ptr& q = pi->query();
-    if ( q.isNull() ) // uh oh? filter out invalid queries i guess
-        return false;
+    const TrackStore& store = sourceModel()->store();
+    const int row = pi->storeRow;
 
-    Tomahawk::result_ptr r;
-    if ( q->numResults() )
-        r = q->results().first();
+    if ( !pi->hasQuery() )
+    {
+        // don't create the Query just to filter, the store knows which source the file belongs to
+        if ( !m_showOfflineResults && store.sourceId( row ) > 0 )
+        {
+            const Tomahawk::source_ptr source = SourceList::instance()->get( store.sourceId( row ) );
+            if ( source.isNull() || !source->isOnline() )
+                return false;
+        }
+    }
+    else
+    {
+        const Tomahawk::query_ptr& q = pi->query();
+        if ( q.isNull() ) // uh oh? filter out invalid queries i guess
+            return false;
 
-    if ( !m_showOfflineResults && !r.isNull() && !r->isOnline() )
-        return false;
+        if ( !m_showOfflineResults && q->numResults() && !q->results().first()->isOnline() )
+            return false;
+    }
 
     if ( filterRegExp().isEmpty() )
         return true;
 
-    QStringList sl = filterRegExp().pattern().split( " ", QString::SkipEmptyParts );
-    foreach( QString s, sl )
+    const QString pattern = filterRegExp().pattern();
+    if ( pattern != m_filterPattern )
+        updateFilterTokens( pattern );
+
+    // already checked against these tokens, e.g. on the worker thread
+    if ( store.revision() == m_matchesRevision && row < m_tested.size() && m_tested.testBit( row ) )
+        return m_matched.testBit( row );
+
+    // rows changed since the previous filter ran, its matches can't be trusted anymore
+    if ( store.revision() != m_matchesRevision && !m_narrowTested.isEmpty() )
     {
-        s = s.toLower();
-        if ( !r.isNull() )
-        {
-            if ( !r->artist()->name().toLower().contains( s ) &&
-                 !r->album()->name().toLower().contains( s ) &&
-                 !r->track().toLower().contains( s ) )
-            {
-                return false;
-            }
-        }
-        else
+        m_narrowMatched.clear();
+        m_narrowTested.clear();
+    }
+
+    bool match;
+    if ( row < m_narrowTested.size() && m_narrowTested.testBit( row ) && !m_narrowMatched.testBit( row ) )
+        match = false;
+    else
+        match = store.matches( row, m_filterTokens );
+
+    if ( row < m_tested.size() )
+    {
+        m_tested.setBit( row );
+        m_matched.setBit( row, match );
+    }
+
+    return match;
+}
+
+
+static bool
+narrows( const QStringList& from, const QStringList& to )
+{
+    // anything matching all of to also matches all of from, if each token of from is part of one of to
+    foreach ( const QString& f, from )
+    {
+        bool found = false;
+        foreach ( const QString& t, to )
         {
-            if ( !q->artist().toLower().contains( s ) &&
-                 !q->album().toLower().contains( s ) &&
-                 !q->track().toLower().contains( s ) )
+            if ( t.contains( f ) )
             {
-                return false;
+                found = true;
+                break;
             }
         }
+
+        if ( !found )
+            return false;
     }
 
     return true;
 }
 
 
+QStringList
+TrackProxyModel::filterTokens( const QString& pattern )
+{
+    return StringPool::searchKey( pattern ).split( QRegExp( "\\s" ), QString::SkipEmptyParts );
+}
+
+
+bool
+TrackProxyModel::canNarrow( const QStringList& tokens ) const
+{
+    return !m_filterTokens.isEmpty() && sourceModel()->store().revision() == m_matchesRevision && narrows( m_filterTokens, tokens );
+}
+
+
+void
+TrackProxyModel::updateFilterTokens( const QString& pattern ) const
+{
+    const QStringList tokens = filterTokens( pattern );
+    const TrackStore& store = sourceModel()->store();
+
+    // typing more characters only narrows the filter, so the rows the
+    // previous tokens rejected don't need to be looked at again
+    if ( canNarrow( tokens ) )
+    {
+        m_narrowMatched = m_matched;
+        m_narrowTested = m_tested;
+    }
+    else
+    {
+        m_narrowMatched.clear();
+        m_narrowTested.clear();
+    }
+
+    m_filterPattern = pattern;
+    m_filterTokens = tokens;
+    m_matched = QBitArray( store.count() );
+    m_tested = QBitArray( store.count() );
+    m_matchesRevision = store.revision();
+}
+
+
 void
 TrackProxyModel::remove( const QModelIndex& index )
 {
@@ -157,6 +261,114 @@ TrackProxyModel::remove( const QList< QPersistentModelIndex >& indexes )
 }
 
 
+static bool
+isStoreColumn( int column )
+{
+    switch ( column )
+    {
+        case TrackModel::Artist:
+        case TrackModel::Album:
+        case TrackModel::Track:
+        case TrackModel::Duration:
+        case TrackModel::Bitrate:
+        case TrackModel::Age:
+        case TrackModel::Filesize:
+        case TrackModel::AlbumPos:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+static bool
+rowLessThan( const TrackStore& store, int column, int r1, int r2 )
+{
+    // compare the interned columns: strings by their locale aware rank, numbers as they are
+    const StringPool& strings = store.strings();
+
+    const unsigned int albumpos1 = store.albumpos( r1 ), albumpos2 = store.albumpos( r2 );
+    const unsigned int discnumber1 = store.discnumber( r1 ), discnumber2 = store.discnumber( r2 );
+    qint64 id1 = store.trackId( r1 );
+    qint64 id2 = store.trackId( r2 );
+
+    // This makes it a stable sorter and prevents items from randomly jumping about.
+    if ( id1 == id2 )
+    {
+        id1 = r1;
+        id2 = r2;
+    }
+
+    if ( column == TrackModel::Artist ) // sort by artist
+    {
+        const int artist1 = strings.rank( store.artistSortname( r1 ) );
+        const int artist2 = strings.rank( store.artistSortname( r2 ) );
+        if ( artist1 != artist2 )
+            return artist1 < artist2;
+
+        column = TrackModel::Album;
+    }
+
+    if ( column == TrackModel::Album ) // sort by album
+    {
+        const int album1 = strings.rank( store.album( r1 ) );
+        const int album2 = strings.rank( store.album( r2 ) );
+        if ( album1 != album2 )
+            return album1 < album2;
+
+        column = TrackModel::AlbumPos;
+    }
+
+    if ( column == TrackModel::AlbumPos ) // sort by album pos
+    {
+        if ( discnumber1 != discnumber2 )
+            return discnumber1 < discnumber2;
+        if ( albumpos1 != albumpos2 )
+            return albumpos1 < albumpos2;
+    }
+    else if ( column == TrackModel::Track ) // sort by track title
+    {
+        const int track1 = strings.rank( store.track( r1 ) );
+        const int track2 = strings.rank( store.track( r2 ) );
+        if ( track1 != track2 )
+            return track1 < track2;
+    }
+    else if ( column == TrackModel::Duration ) // sort by duration
+    {
+        if ( store.duration( r1 ) != store.duration( r2 ) )
+            return store.duration( r1 ) < store.duration( r2 );
+    }
+    else if ( column == TrackModel::Bitrate ) // sort by bitrate
+    {
+        if ( store.bitrate( r1 ) != store.bitrate( r2 ) )
+            return store.bitrate( r1 ) < store.bitrate( r2 );
+    }
+    else if ( column == TrackModel::Age ) // sort by mtime
+    {
+        if ( store.modificationTime( r1 ) != store.modificationTime( r2 ) )
+            return store.modificationTime( r1 ) < store.modificationTime( r2 );
+    }
+    else if ( column == TrackModel::Filesize ) // sort by file size
+    {
+        if ( store.size( r1 ) != store.size( r2 ) )
+            return store.size( r1 ) < store.size( r2 );
+    }
+
+    return id1 < id2;
+}
+
+
+struct RowLessThan
+{
+    RowLessThan( const TrackStore& store, int column ) : store( store ), column( column ) {}
+    bool operator()( int r1, int r2 ) const { return rowLessThan( store, column, r1, r2 ); }
+
+    const TrackStore& store;
+    int column;
+};
+
+
 bool
 TrackProxyModel::lessThan( const QModelIndex& left, const QModelIndex& right ) const
 {
@@ -168,135 +380,231 @@ TrackProxyModel::lessThan( const QModelIndex& left, const QModelIndex& right ) c
     if ( !p2 )
         return false;
 
-    const Tomahawk::query_ptr& q1 = p1->query();
-    const Tomahawk::query_ptr& q2 = p2->query();
-
-    QString artist1 = q1->artistSortname();
-    QString artist2 = q2->artistSortname();
-    QString album1 = q1->album();
-    QString album2 = q2->album();
-    QString track1 = q1->track();
-    QString track2 = q2->track();
-    unsigned int albumpos1 = 0, albumpos2 = 0;
-    unsigned int discnumber1 = 0, discnumber2 = 0;
-    unsigned int bitrate1 = 0, bitrate2 = 0;
-    unsigned int mtime1 = 0, mtime2 = 0;
-    unsigned int size1 = 0, size2 = 0;
-    qint64 id1 = 0, id2 = 0;
-
-    if ( q1->numResults() )
-    {
-        const Tomahawk::result_ptr& r = q1->results().at( 0 );
-        artist1 = r->artist()->sortname();
-        album1 = r->album()->name();
-        track1 = r->track();
-        albumpos1 = r->albumpos();
-        discnumber1 = qMax( 1, (int)r->discnumber() );
-        bitrate1 = r->bitrate();
-        mtime1 = r->modificationTime();
-        id1 = r->trackId();
-        size1 = r->size();
-    }
-    if ( q2->numResults() )
+    const TrackStore& store = sourceModel()->store();
+    const int r1 = p1->storeRow;
+    const int r2 = p2->storeRow;
+
+    // sorted on the worker thread already, as long as no row changed since
+    if ( left.column() == m_sortPositionsColumn && store.revision() == m_sortPositionsRevision &&
+         r1 < m_sortPositions.count() && r2 < m_sortPositions.count() )
     {
-        const Tomahawk::result_ptr& r = q2->results().at( 0 );
-        artist2 = r->artist()->sortname();
-        album2 = r->album()->name();
-        track2 = r->track();
-        albumpos2 = r->albumpos();
-        discnumber2 = qMax( 1, (int)r->discnumber() );
-        bitrate2 = r->bitrate();
-        mtime2 = r->modificationTime();
-        id2 = r->trackId();
-        size2 = r->size();
+        return m_sortPositions.at( r1 ) < m_sortPositions.at( r2 );
     }
 
-    // This makes it a stable sorter and prevents items from randomly jumping about.
+    if ( isStoreColumn( left.column() ) )
+        return rowLessThan( store, left.column(), r1, r2 );
+
+    qint64 id1 = store.trackId( r1 );
+    qint64 id2 = store.trackId( r2 );
     if ( id1 == id2 )
     {
-        id1 = (qint64)&q1;
-        id2 = (qint64)&q2;
+        id1 = (qint64)p1;
+        id2 = (qint64)p2;
     }
 
-    if ( left.column() == TrackModel::Artist ) // sort by artist
-    {
-        if ( artist1 == artist2 )
-        {
-            if ( album1 == album2 )
-            {
-                if ( discnumber1 == discnumber2 )
-                {
-                    if ( albumpos1 == albumpos2 )
-                        return id1 < id2;
+    const QString& lefts = sourceModel()->data( left ).toString();
+    const QString& rights = sourceModel()->data( right ).toString();
+    if ( lefts == rights )
+        return id1 < id2;
 
-                    return albumpos1 < albumpos2;
-                }
+    return QString::localeAwareCompare( lefts, rights ) < 0;
+}
 
-                return discnumber1 < discnumber2;
-            }
 
-            return QString::localeAwareCompare( album1, album2 ) < 0;
-        }
+QVector< int >
+TrackProxyModel::sortPositions( const TrackStore& store, int column, QSharedPointer< QAtomicInt > generation, int job )
+{
+    // ranks are computed lazily, get that done before the sorting starts
+    store.strings().rank( 0 );
 
-        return QString::localeAwareCompare( artist1, artist2 ) < 0;
-    }
-    else if ( left.column() == TrackModel::Album ) // sort by album
-    {
-        if ( album1 == album2 )
-        {
-            if ( discnumber1 == discnumber2 )
-            {
-                if ( albumpos1 == albumpos2 )
-                    return id1 < id2;
+    if ( *generation != job )
+        return QVector< int >();
 
-                return albumpos1 < albumpos2;
-            }
+    QVector< int > rows( store.count() );
+    for ( int i = 0; i < rows.count(); i++ )
+        rows[i] = i;
 
-            return discnumber1 < discnumber2;
-        }
+    std::sort( rows.begin(), rows.end(), RowLessThan( store, column ) );
 
-        return QString::localeAwareCompare( album1, album2 ) < 0;
-    }
-    else if ( left.column() == TrackModel::Bitrate ) // sort by bitrate
-    {
-        if ( bitrate1 == bitrate2 )
-            return id1 < id2;
+    if ( *generation != job )
+        return QVector< int >();
 
-        return bitrate1 < bitrate2;
-    }
-    else if ( left.column() == TrackModel::Age ) // sort by mtime
+    QVector< int > positions( rows.count() );
+    for ( int i = 0; i < rows.count(); i++ )
+        positions[ rows.at( i ) ] = i;
+
+    return positions;
+}
+
+
+QBitArray
+TrackProxyModel::filterMatches( const FilterJob& filter, QSharedPointer< QAtomicInt > generation, int job )
+{
+    const TrackStore& store = filter.store;
+    QBitArray matched( store.count() );
+
+    for ( int row = 0; row < store.count(); row++ )
     {
-        if ( mtime1 == mtime2 )
-            return id1 < id2;
+        if ( !( row % 4096 ) && *generation != job )
+            return QBitArray();
+
+        if ( row < filter.tested.size() && filter.tested.testBit( row ) && !filter.matched.testBit( row ) )
+            continue;
 
-        return mtime1 < mtime2;
+        if ( store.matches( row, filter.tokens ) )
+            matched.setBit( row );
     }
-    else if ( left.column() == TrackModel::Filesize ) // sort by file size
+
+    return matched;
+}
+
+
+void
+TrackProxyModel::sort( int column, Qt::SortOrder order )
+{
+    cancelSort();
+
+    if ( !m_model || !isStoreColumn( column ) || m_model->store().count() < TRACKPROXYMODEL_ASYNC_ROWS )
     {
-        if ( size1 == size2 )
-            return id1 < id2;
+        QSortFilterProxyModel::sort( column, order );
+        return;
+    }
+
+    const int job = m_sortGeneration->fetchAndAddOrdered( 1 ) + 1;
+    m_pendingSortColumn = column;
+    m_pendingSortOrder = order;
+    m_pendingSortRevision = m_model->store().revision();
 
-        return size1 < size2;
+    m_sortWatcher = new QFutureWatcher< QVector< int > >( this );
+    connect( m_sortWatcher, SIGNAL( finished() ), SLOT( onSortFinished() ) );
+    m_sortWatcher->setFuture( QtConcurrent::run( &TrackProxyModel::sortPositions, m_model->store(), column, m_sortGeneration, job ) );
+}
+
+
+void
+TrackProxyModel::onSortFinished()
+{
+    QFutureWatcher< QVector< int > >* watcher = m_sortWatcher;
+    m_sortWatcher = 0;
+    watcher->deleteLater();
+
+    const QVector< int > positions = watcher->result();
+    if ( positions.isEmpty() )
+        return;
+
+    m_sortPositions = positions;
+    m_sortPositionsColumn = m_pendingSortColumn;
+    m_sortPositionsRevision = m_pendingSortRevision;
+
+    // a single re-sort that only compares the positions, one layout change for the views
+    QSortFilterProxyModel::sort( m_pendingSortColumn, m_pendingSortOrder );
+}
+
+
+void
+TrackProxyModel::newFilterFromPlaylistInterface( const QString& pattern )
+{
+    emit filteringStarted();
+    cancelFilter();
+
+    if ( pattern.isEmpty() || !m_model || m_model->store().count() < TRACKPROXYMODEL_ASYNC_ROWS )
+    {
+        applyFilter( pattern );
+        return;
     }
-    else if ( left.column() == TrackModel::AlbumPos ) // sort by album pos
+
+    FilterJob filter;
+    filter.store = m_model->store();
+    filter.tokens = filterTokens( pattern );
+    if ( canNarrow( filter.tokens ) )
     {
-        if ( discnumber1 != discnumber2 )
-        {
-            return discnumber1 < discnumber2;
-        }
-        else
-        {
-            if ( albumpos1 != albumpos2 )
-                return albumpos1 < albumpos2;
-        }
+        filter.matched = m_matched;
+        filter.tested = m_tested;
     }
 
-    const QString& lefts = sourceModel()->data( left ).toString();
-    const QString& rights = sourceModel()->data( right ).toString();
-    if ( lefts == rights )
-        return id1 < id2;
+    const int job = m_filterGeneration->fetchAndAddOrdered( 1 ) + 1;
+    m_pendingFilter = pattern;
+    m_pendingFilterTokens = filter.tokens;
+    m_pendingFilterRevision = filter.store.revision();
 
-    return QString::localeAwareCompare( lefts, rights ) < 0;
+    m_filterWatcher = new QFutureWatcher< QBitArray >( this );
+    connect( m_filterWatcher, SIGNAL( finished() ), SLOT( onFilterFinished() ) );
+    m_filterWatcher->setFuture( QtConcurrent::run( &TrackProxyModel::filterMatches, filter, m_filterGeneration, job ) );
+}
+
+
+void
+TrackProxyModel::onFilterFinished()
+{
+    QFutureWatcher< QBitArray >* watcher = m_filterWatcher;
+    m_filterWatcher = 0;
+    watcher->deleteLater();
+
+    const QBitArray matched = watcher->result();
+    if ( matched.isNull() )
+        return;
+
+    // filterAcceptsRow() picks these up instead of matching again
+    m_filterPattern = m_pendingFilter;
+    m_filterTokens = m_pendingFilterTokens;
+    m_matched = matched;
+    m_tested = QBitArray( matched.size(), true );
+    m_matchesRevision = m_pendingFilterRevision;
+    m_narrowMatched.clear();
+    m_narrowTested.clear();
+
+    applyFilter( m_pendingFilter );
+}
+
+
+void
+TrackProxyModel::applyFilter( const QString& pattern )
+{
+    setFilterRegExp( pattern );
+    emit filterChanged( pattern );
+
+    Tomahawk::TrackProxyModelPlaylistInterface* pi = qobject_cast< Tomahawk::TrackProxyModelPlaylistInterface* >( playlistInterface().data() );
+    if ( pi )
+        pi->sendTrackCount();
+
+    emit filteringFinished();
+}
+
+
+void
+TrackProxyModel::cancelSort()
+{
+    m_sortGeneration->ref();
+
+    if ( !m_sortWatcher )
+        return;
+
+    // the job notices the new generation and stops early, its watcher goes away once it did
+    disconnect( m_sortWatcher, SIGNAL( finished() ), this, SLOT( onSortFinished() ) );
+    if ( m_sortWatcher->isFinished() )
+        m_sortWatcher->deleteLater();
+    else
+        connect( m_sortWatcher, SIGNAL( finished() ), m_sortWatcher, SLOT( deleteLater() ) );
+
+    m_sortWatcher = 0;
+}
+
+
+void
+TrackProxyModel::cancelFilter()
+{
+    m_filterGeneration->ref();
+
+    if ( !m_filterWatcher )
+        return;
+
+    disconnect( m_filterWatcher, SIGNAL( finished() ), this, SLOT( onFilterFinished() ) );
+    if ( m_filterWatcher->isFinished() )
+        m_filterWatcher->deleteLater();
+    else
+        connect( m_filterWatcher, SIGNAL( finished() ), m_filterWatcher, SLOT( deleteLater() ) );
+
+    m_filterWatcher = 0;
 }
 
 
@@ -20,6 +20,10 @@
 #ifndef TRACKPROXYMODEL_H
 #define TRACKPROXYMODEL_H
 
+#include <QtCore/QAtomicInt>
+#include <QtCore/QBitArray>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QSharedPointer>
 #include <QtGui/QSortFilterProxyModel>
 
 #include "playlistinterface.h"
@@ -27,13 +31,17 @@
 
 #include "dllmacro.h"
 
+// stores with at least this many rows get sorted and filtered on a worker thread
+#define TRACKPROXYMODEL_ASYNC_ROWS 10000
+
 class DLLEXPORT TrackProxyModel : public QSortFilterProxyModel
 {
 Q_OBJECT
 
 public:
     explicit TrackProxyModel ( QObject* parent = 0 );
-    virtual ~TrackProxyModel() {}
+    // stops running jobs early, their results aren't needed anymore
+    virtual ~TrackProxyModel() { m_sortGeneration->ref(); m_filterGeneration->ref(); }
 
     virtual TrackModel* sourceModel() const { return m_model; }
     virtual void setSourceTrackModel( TrackModel* sourceModel );
@@ -50,6 +58,11 @@ public:
     virtual void setShowOfflineResults( bool b ) { m_showOfflineResults = b; }
 
     virtual void emitFilterChanged( const QString &pattern ) { emit filterChanged( pattern ); }
+    // large models get matched on a worker thread, filterChanged() is emitted once the filter got applied
+    virtual void newFilterFromPlaylistInterface( const QString& pattern );
+
+    // large models get sorted on a worker thread, the new order is applied in one go when it's done
+    virtual void sort( int column, Qt::SortOrder order = Qt::AscendingOrder );
 
     virtual TrackModelItem* itemFromIndex( const QModelIndex& index ) const { return sourceModel()->itemFromIndex( index ); }
 
@@ -57,6 +70,8 @@ public:
 
 signals:
     void filterChanged( const QString& filter );
+    void filteringStarted();
+    void filteringFinished();
 
 protected:
     virtual bool filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent ) const;
@@ -65,6 +80,61 @@ protected:
     TrackModel* m_model;
     bool m_showOfflineResults;
     Tomahawk::playlistinterface_ptr m_playlistInterface;
+
+private slots:
+    void onSortFinished();
+    void onFilterFinished();
+
+private:
+    // everything the filter job needs, copied so the model can change while it runs
+    struct FilterJob
+    {
+        TrackStore store;
+        QStringList tokens;
+        QBitArray matched;
+        QBitArray tested;
+    };
+
+    static QVector< int > sortPositions( const TrackStore& store, int column, QSharedPointer< QAtomicInt > generation, int job );
+    static QBitArray filterMatches( const FilterJob& filter, QSharedPointer< QAtomicInt > generation, int job );
+
+    void applyFilter( const QString& pattern );
+    void cancelSort();
+    void cancelFilter();
+
+    static QStringList filterTokens( const QString& pattern );
+    bool canNarrow( const QStringList& tokens ) const;
+    void updateFilterTokens( const QString& pattern ) const;
+
+    // normalised filter words, split once per filter instead of once per row
+    mutable QString m_filterPattern;
+    mutable QStringList m_filterTokens;
+
+    // per store row: whether the current tokens got checked, and whether they matched.
+    // the narrow* copies are from the previous tokens, if the current ones only narrow them
+    mutable QBitArray m_matched;
+    mutable QBitArray m_tested;
+    mutable QBitArray m_narrowMatched;
+    mutable QBitArray m_narrowTested;
+    mutable unsigned int m_matchesRevision;
+
+    // jobs check their generation and give up once a newer job bumped it
+    QFutureWatcher< QVector< int > >* m_sortWatcher;
+    QSharedPointer< QAtomicInt > m_sortGeneration;
+    int m_pendingSortColumn;
+    Qt::SortOrder m_pendingSortOrder;
+    unsigned int m_pendingSortRevision;
+
+    // position of every store row in the order computed by the last sort job
+    QVector< int > m_sortPositions;
+    int m_sortPositionsColumn;
+    unsigned int m_sortPositionsRevision;
+
+    QFutureWatcher< QBitArray >* m_filterWatcher;
+    QSharedPointer< QAtomicInt > m_filterGeneration;
+    QString m_pendingFilter;
+    QStringList m_pendingFilterTokens;
+    unsigned int m_pendingFilterRevision;
 };
 
 #endif // TRACKPROXYMODEL_H
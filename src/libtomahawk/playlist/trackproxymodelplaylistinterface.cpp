@@ -69,10 +69,11 @@ TrackProxyModelPlaylistInterface::setFilter( const QString& pattern )
     if ( m_proxyModel.isNull() )
         return;
 
-    m_proxyModel.data()->setFilterRegExp( pattern );
-    m_proxyModel.data()->emitFilterChanged( pattern );
+    // lazily loaded models only fetch the matching rows, the proxy filters whatever got loaded
+    if ( m_proxyModel.data()->sourceModel() )
+        m_proxyModel.data()->sourceModel()->setFilter( pattern );
 
-    emit trackCountChanged( trackCount() );
+    m_proxyModel.data()->newFilterFromPlaylistInterface( pattern );
 }
 
 
@@ -51,6 +51,7 @@ public:
 
     virtual QString filter() const;
     virtual void setFilter( const QString& pattern );
+    virtual void sendTrackCount() { emit trackCountChanged( trackCount() ); }
 
     virtual PlaylistInterface::RepeatMode repeatMode() const { return m_repeatMode; }
     virtual bool shuffled() const { return m_shuffled; }
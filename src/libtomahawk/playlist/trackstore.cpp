@@ -0,0 +1,547 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trackstore.h"
+
+#include <algorithm>
+
+#include "artist.h"
+#include "album.h"
+#include "query.h"
+#include "result.h"
+#include "source.h"
+#include "sourcelist.h"
+#include "database/databaseimpl.h"
+
+using namespace Tomahawk;
+
+
+namespace
+{
+    struct LocaleLessThan
+    {
+        LocaleLessThan( const QVector< QString >& strings ) : m_strings( strings ) {}
+
+        bool operator()( int left, int right ) const
+        {
+            return QString::localeAwareCompare( m_strings.at( left ), m_strings.at( right ) ) < 0;
+        }
+
+        const QVector< QString >& m_strings;
+    };
+}
+
+
+StringPool::StringPool()
+{
+    // id 0 is always the empty string
+    intern( QString() );
+}
+
+
+QString
+StringPool::searchKey( const QString& str )
+{
+    return DatabaseImpl::sortname( str, false, true );
+}
+
+
+int
+StringPool::intern( const QString& str )
+{
+    QHash< QString, int >::const_iterator it = m_ids.constFind( str );
+    if ( it != m_ids.constEnd() )
+    {
+        m_refs[ it.value() ]++;
+        return it.value();
+    }
+
+    int id;
+    if ( !m_free.isEmpty() )
+    {
+        id = m_free.last();
+        m_free.pop_back();
+
+        m_strings[id] = str;
+        m_keys[id] = searchKey( str );
+        m_refs[id] = 1;
+    }
+    else
+    {
+        id = m_strings.count();
+        m_strings << str;
+        m_keys << searchKey( str );
+        m_refs << 1;
+        m_ranks << 0;
+    }
+
+    m_ids.insert( str, id );
+    m_unordered << id;
+
+    return id;
+}
+
+
+void
+StringPool::release( int id )
+{
+    // the empty string is never released, it's what unused columns point to
+    if ( id <= 0 || id >= m_refs.count() || m_refs.at( id ) <= 0 )
+        return;
+
+    if ( --m_refs[id] > 0 )
+        return;
+
+    // the id only becomes free after it was taken out of m_order, see updateRanks()
+    m_ids.remove( m_strings.at( id ) );
+    m_released << id;
+}
+
+
+int
+StringPool::rank( int id ) const
+{
+    if ( !m_unordered.isEmpty() || !m_released.isEmpty() )
+        updateRanks();
+
+    return m_ranks.at( id );
+}
+
+
+void
+StringPool::updateRanks() const
+{
+    if ( !m_released.isEmpty() )
+    {
+        // a kept id equals the kept one before it, if it did equal every released id in between
+        QVector< int > order;
+        QVector< bool > same;
+        order.reserve( m_order.count() );
+        same.reserve( m_order.count() );
+
+        bool run = true;
+        for ( int i = 0; i < m_order.count(); i++ )
+        {
+            const int id = m_order.at( i );
+            if ( m_refs.at( id ) <= 0 )
+            {
+                run = run && m_sameAsPrevious.at( i );
+                continue;
+            }
+
+            same << ( !order.isEmpty() && run && m_sameAsPrevious.at( i ) );
+            order << id;
+            run = true;
+        }
+
+        m_order = order;
+        m_sameAsPrevious = same;
+
+        foreach ( int id, m_released )
+        {
+            m_strings[id].clear();
+            m_keys[id].clear();
+            m_free << id;
+        }
+        m_released.clear();
+    }
+
+    if ( !m_unordered.isEmpty() )
+    {
+        // sort the new ids only, then binary search their place among the ordered ones
+        QVector< int > added;
+        added.reserve( m_unordered.count() );
+        foreach ( int id, m_unordered )
+        {
+            if ( m_refs.at( id ) > 0 )
+                added << id;
+        }
+        m_unordered.clear();
+
+        const LocaleLessThan lessThan( m_strings );
+        std::sort( added.begin(), added.end(), lessThan );
+
+        QVector< int > order;
+        QVector< bool > same;
+        order.reserve( m_order.count() + added.count() );
+        same.reserve( m_order.count() + added.count() );
+
+        int next = 0;
+        for ( int i = 0; i <= added.count(); i++ )
+        {
+            const int end = i < added.count() ?
+                            std::lower_bound( m_order.constBegin() + next, m_order.constEnd(), added.at( i ), lessThan ) - m_order.constBegin() :
+                            m_order.count();
+
+            // ordered ids keep their flag, unless a new id got placed right before them
+            for ( ; next < end; next++ )
+            {
+                const int id = m_order.at( next );
+                if ( order.isEmpty() )
+                    same << false;
+                else if ( next > 0 && order.last() == m_order.at( next - 1 ) )
+                    same << m_sameAsPrevious.at( next );
+                else
+                    same << ( QString::localeAwareCompare( m_strings.at( order.last() ), m_strings.at( id ) ) == 0 );
+
+                order << id;
+            }
+
+            if ( i < added.count() )
+            {
+                const int id = added.at( i );
+                same << ( !order.isEmpty() && QString::localeAwareCompare( m_strings.at( order.last() ), m_strings.at( id ) ) == 0 );
+                order << id;
+            }
+        }
+
+        m_order = order;
+        m_sameAsPrevious = same;
+    }
+
+    int rank = 0;
+    for ( int i = 0; i < m_order.count(); i++ )
+    {
+        if ( i > 0 && !m_sameAsPrevious.at( i ) )
+            rank++;
+
+        m_ranks[ m_order.at( i ) ] = rank;
+    }
+}
+
+
+void
+StringPool::clear()
+{
+    m_strings.clear();
+    m_keys.clear();
+    m_refs.clear();
+    m_ids.clear();
+    m_released.clear();
+    m_free.clear();
+    m_order.clear();
+    m_sameAsPrevious.clear();
+    m_unordered.clear();
+    m_ranks.clear();
+
+    intern( QString() );
+}
+
+
+TrackStore::TrackStore()
+    : m_revision( 0 )
+{
+}
+
+
+int
+TrackStore::allocateRow()
+{
+    if ( !m_freeRows.isEmpty() )
+    {
+        const int row = m_freeRows.last();
+        m_freeRows.pop_back();
+        return row;
+    }
+
+    const int row = m_artist.count();
+    const int rows = row + 1;
+
+    m_artist.resize( rows );
+    m_artistSortname.resize( rows );
+    m_album.resize( rows );
+    m_track.resize( rows );
+    m_trackId.resize( rows );
+    m_albumpos.resize( rows );
+    m_discnumber.resize( rows );
+    m_duration.resize( rows );
+    m_bitrate.resize( rows );
+    m_mtime.resize( rows );
+    m_size.resize( rows );
+
+    m_fileId.resize( rows );
+    m_sourceId.resize( rows );
+    m_url.resize( rows );
+    m_mimetype.resize( rows );
+    m_composer.resize( rows );
+    m_artistId.resize( rows );
+    m_albumId.resize( rows );
+    m_composerId.resize( rows );
+    m_fileDiscnumber.resize( rows );
+    m_year.resize( rows );
+
+    return row;
+}
+
+
+bool
+TrackStore::setString( QVector< int >& column, int row, const QString& str )
+{
+    // intern first, so a string that doesn't change never drops to zero references
+    const int id = m_strings.intern( str );
+    m_strings.release( column.at( row ) );
+
+    const bool changed = ( column.at( row ) != id );
+    column[row] = id;
+
+    return changed;
+}
+
+
+template< typename T > bool
+TrackStore::setNumber( QVector< T >& column, int row, T value )
+{
+    if ( column.at( row ) == value )
+        return false;
+
+    column[row] = value;
+    return true;
+}
+
+
+int
+TrackStore::add( const query_ptr& query )
+{
+    const int row = allocateRow();
+    update( row, query );
+    m_revision++;
+
+    return row;
+}
+
+
+int
+TrackStore::add( const Record& record )
+{
+    const int row = allocateRow();
+    m_revision++;
+
+    setString( m_artist, row, record.artist );
+    setString( m_artistSortname, row, record.artistSortname );
+    setString( m_album, row, record.album );
+    setString( m_track, row, record.track );
+    setString( m_composer, row, record.composer );
+    setString( m_mimetype, row, record.mimetype );
+
+    m_trackId[row] = record.trackId;
+    m_albumpos[row] = qMin( record.albumpos, (unsigned int)0xffff );
+    m_discnumber[row] = qBound( 1, (int)record.discnumber, 0xff );
+    m_duration[row] = record.duration;
+    m_bitrate[row] = record.bitrate;
+    m_mtime[row] = record.mtime;
+    m_size[row] = record.size;
+
+    m_fileId[row] = record.fileId;
+    m_sourceId[row] = record.sourceId;
+    m_url[row] = record.url;
+    m_artistId[row] = record.artistId;
+    m_albumId[row] = record.albumId;
+    m_composerId[row] = record.composerId;
+    m_fileDiscnumber[row] = qMin( record.discnumber, (unsigned int)0xff );
+    m_year[row] = qBound( 0, record.year, 0xffff );
+
+    return row;
+}
+
+
+void
+TrackStore::update( int row, const query_ptr& query )
+{
+    if ( row < 0 || row >= m_artist.count() || query.isNull() )
+        return;
+
+    result_ptr r;
+    if ( query->numResults() )
+        r = query->results().first();
+
+    // queries keep getting updated, e.g. with social actions; only a change of
+    // the values stored here invalidates sorts and matches computed before
+    bool changed = false;
+    if ( !r.isNull() )
+    {
+        changed |= setString( m_artist, row, r->artist()->name() );
+        changed |= setString( m_artistSortname, row, r->artist()->sortname() );
+        changed |= setString( m_album, row, r->album()->name() );
+        changed |= setString( m_track, row, r->track() );
+
+        changed |= setNumber( m_trackId, row, r->trackId() );
+        changed |= setNumber( m_albumpos, row, (quint16)qMin( r->albumpos(), (unsigned int)0xffff ) );
+        changed |= setNumber( m_discnumber, row, (quint8)qBound( 1, (int)r->discnumber(), 0xff ) );
+        changed |= setNumber( m_duration, row, r->duration() );
+        changed |= setNumber( m_bitrate, row, r->bitrate() );
+        changed |= setNumber( m_mtime, row, r->modificationTime() );
+        changed |= setNumber( m_size, row, r->size() );
+    }
+    else
+    {
+        changed |= setString( m_artist, row, query->artist() );
+        changed |= setString( m_artistSortname, row, query->artistSortname() );
+        changed |= setString( m_album, row, query->album() );
+        changed |= setString( m_track, row, query->track() );
+
+        changed |= setNumber( m_trackId, row, 0u );
+        changed |= setNumber( m_albumpos, row, (quint16)0 );
+        changed |= setNumber( m_discnumber, row, (quint8)0 );
+        changed |= setNumber( m_duration, row, (unsigned int)qMax( 0, query->duration() ) );
+        changed |= setNumber( m_bitrate, row, 0u );
+        changed |= setNumber( m_mtime, row, 0u );
+        changed |= setNumber( m_size, row, 0u );
+    }
+
+    if ( changed )
+        m_revision++;
+}
+
+
+void
+TrackStore::remove( int row )
+{
+    if ( row < 0 || row >= m_artist.count() )
+        return;
+
+    // point the row at the empty string, so the names it used can be released
+    setString( m_artist, row, QString() );
+    setString( m_artistSortname, row, QString() );
+    setString( m_album, row, QString() );
+    setString( m_track, row, QString() );
+    setString( m_composer, row, QString() );
+    setString( m_mimetype, row, QString() );
+
+    m_fileId[row] = 0;
+    m_url[row].clear();
+
+    m_freeRows << row;
+    m_revision++;
+}
+
+
+void
+TrackStore::clear()
+{
+    m_strings.clear();
+
+    m_artist.clear();
+    m_artistSortname.clear();
+    m_album.clear();
+    m_track.clear();
+    m_trackId.clear();
+    m_albumpos.clear();
+    m_discnumber.clear();
+    m_duration.clear();
+    m_bitrate.clear();
+    m_mtime.clear();
+    m_size.clear();
+
+    m_fileId.clear();
+    m_sourceId.clear();
+    m_url.clear();
+    m_mimetype.clear();
+    m_composer.clear();
+    m_artistId.clear();
+    m_albumId.clear();
+    m_composerId.clear();
+    m_fileDiscnumber.clear();
+    m_year.clear();
+
+    m_freeRows.clear();
+    m_revision++;
+}
+
+
+query_ptr
+TrackStore::query( int row ) const
+{
+    if ( row < 0 || row >= m_artist.count() || !hasRecord( row ) )
+        return query_ptr();
+
+    source_ptr s;
+    QString url = m_url.at( row );
+
+    if ( m_sourceId.at( row ) == 0 )
+    {
+        s = SourceList::instance()->getLocal();
+    }
+    else
+    {
+        s = SourceList::instance()->get( m_sourceId.at( row ) );
+        if ( s.isNull() )
+            return query_ptr();
+
+        url = QString( "servent://%1\t%2" ).arg( s->userName() ).arg( url );
+    }
+
+    const QString& artist = m_strings.string( m_artist.at( row ) );
+    const QString& album = m_strings.string( m_album.at( row ) );
+    const QString& track = m_strings.string( m_track.at( row ) );
+
+    result_ptr result = Result::get( url );
+    query_ptr qry = Query::get( artist, track, album );
+    artist_ptr artistptr = Artist::get( m_artistId.at( row ), artist );
+    artist_ptr composerptr = Artist::get( m_composerId.at( row ), m_strings.string( m_composer.at( row ) ) );
+    album_ptr albumptr = Album::get( m_albumId.at( row ), album, artistptr );
+
+    result->setTrackId( m_trackId.at( row ) );
+    result->setArtist( artistptr );
+    result->setAlbum( albumptr );
+    result->setTrack( track );
+    result->setComposer( composerptr );
+    result->setSize( m_size.at( row ) );
+    result->setDuration( m_duration.at( row ) );
+    result->setBitrate( m_bitrate.at( row ) );
+    result->setModificationTime( m_mtime.at( row ) );
+    result->setMimetype( m_strings.string( m_mimetype.at( row ) ) );
+    result->setDiscNumber( m_fileDiscnumber.at( row ) );
+    result->setAlbumPos( m_albumpos.at( row ) );
+    result->setScore( 1.0 );
+    result->setCollection( s->collection() );
+
+    if ( m_year.at( row ) )
+    {
+        QVariantMap attributes = result->attributes();
+        attributes[ "releaseyear" ] = QString::number( m_year.at( row ) );
+        result->setAttributes( attributes );
+    }
+
+    QList< result_ptr > results;
+    results << result;
+    qry->addResults( results );
+    qry->setResolveFinished( true );
+
+    return qry;
+}
+
+
+bool
+TrackStore::matches( int row, const QStringList& tokens ) const
+{
+    const QString& artist = m_strings.key( m_artist.at( row ) );
+    const QString& album = m_strings.key( m_album.at( row ) );
+    const QString& track = m_strings.key( m_track.at( row ) );
+
+    foreach ( const QString& token, tokens )
+    {
+        if ( !artist.contains( token ) &&
+             !album.contains( token ) &&
+             !track.contains( token ) )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
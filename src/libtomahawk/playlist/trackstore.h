@@ -0,0 +1,214 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKSTORE_H
+#define TRACKSTORE_H
+
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "typedefs.h"
+
+#include "dllmacro.h"
+
+/*
+    Interns strings, so every distinct artist, album or track name is stored
+    once and can be referred to by a small integer id. Besides the string
+    itself it keeps a normalised search key for filtering, and hands out
+    locale aware sort ranks, which turn string comparisons into integer ones.
+
+    Ids are reference counted: every intern() has to be paired with a
+    release(), and ids nobody refers to anymore get reused.
+*/
+class DLLEXPORT StringPool
+{
+public:
+    StringPool();
+
+    int intern( const QString& str );
+    void release( int id );
+
+    const QString& string( int id ) const { return m_strings.at( id ); }
+    // lowercased, without diacritics and with whitespace collapsed, see searchKey()
+    const QString& key( int id ) const { return m_keys.at( id ); }
+
+    // position of the string in locale aware order, equal strings share a rank
+    int rank( int id ) const;
+
+    // ids ever allocated, including released ones
+    int count() const { return m_strings.count(); }
+    void clear();
+
+    // normalises str the same way names are normalised for key()
+    static QString searchKey( const QString& str );
+
+private:
+    void updateRanks() const;
+
+    QVector< QString > m_strings;
+    QVector< QString > m_keys;
+    QVector< int > m_refs;
+    QHash< QString, int > m_ids;
+
+    // ids whose last reference got released, reusable once they left m_order
+    mutable QVector< int > m_released;
+    mutable QVector< int > m_free;
+
+    // live ids in locale aware order, and whether each one equals its predecessor
+    mutable QVector< int > m_order;
+    mutable QVector< bool > m_sameAsPrevious;
+    // ids interned since m_order was last updated
+    mutable QVector< int > m_unordered;
+    mutable QVector< int > m_ranks;
+};
+
+
+/*
+    Columnar copy of the fields TrackProxyModel sorts and filters on, one row
+    per TrackModelItem. Strings live in a StringPool, numbers in packed
+    vectors, so sorting and filtering never have to lock a Query or walk
+    its results.
+
+    Rows added from a Record additionally keep everything needed to create
+    their Query on demand, see query(), so models of large collections don't
+    have to keep a Query and Result alive for every file.
+*/
+class DLLEXPORT TrackStore
+{
+public:
+    // a file of a collection, as read by DatabaseCommand_AllTracks
+    struct Record
+    {
+        Record() : fileId( 0 ), sourceId( 0 ), artistId( 0 ), albumId( 0 ), composerId( 0 ), trackId( 0 ),
+                   albumpos( 0 ), discnumber( 0 ), duration( 0 ), bitrate( 0 ), mtime( 0 ), size( 0 ), year( 0 ) {}
+
+        unsigned int fileId;
+        // 0 for the local collection
+        unsigned int sourceId;
+        QString url;
+        QString mimetype;
+
+        QString artist;
+        QString artistSortname;
+        QString album;
+        // empty without an album, only used to page through a collection
+        QString albumSortname;
+        QString track;
+        QString composer;
+
+        unsigned int artistId;
+        unsigned int albumId;
+        unsigned int composerId;
+        unsigned int trackId;
+
+        unsigned int albumpos;
+        unsigned int discnumber;
+        unsigned int duration;
+        unsigned int bitrate;
+        unsigned int mtime;
+        unsigned int size;
+        int year;
+    };
+
+    TrackStore();
+
+    // returns the row the query's fields were stored in
+    int add( const Tomahawk::query_ptr& query );
+    int add( const Record& record );
+    // refreshes the sort and filter columns of row from query
+    void update( int row, const Tomahawk::query_ptr& query );
+    void remove( int row );
+    void clear();
+
+    // rows ever allocated, including free ones
+    int count() const { return m_artist.count(); }
+    // bumped whenever a row gets added, removed, the store cleared, or update() changes a row's values
+    unsigned int revision() const { return m_revision; }
+
+    // true if row was added from a Record, so query() can recreate it
+    bool hasRecord( int row ) const { return m_fileId.at( row ) > 0; }
+    // creates a resolved Query for a row added from a Record, with the same Result DatabaseCommand_AllTracks would give it
+    Tomahawk::query_ptr query( int row ) const;
+    // only valid for rows added from a Record, 0 for the local collection
+    unsigned int sourceId( int row ) const { return m_sourceId.at( row ); }
+
+    int artist( int row ) const { return m_artist.at( row ); }
+    int artistSortname( int row ) const { return m_artistSortname.at( row ); }
+    int album( int row ) const { return m_album.at( row ); }
+    int track( int row ) const { return m_track.at( row ); }
+
+    unsigned int trackId( int row ) const { return m_trackId.at( row ); }
+    unsigned int albumpos( int row ) const { return m_albumpos.at( row ); }
+    unsigned int discnumber( int row ) const { return m_discnumber.at( row ); }
+    unsigned int duration( int row ) const { return m_duration.at( row ); }
+    unsigned int bitrate( int row ) const { return m_bitrate.at( row ); }
+    unsigned int modificationTime( int row ) const { return m_mtime.at( row ); }
+    unsigned int size( int row ) const { return m_size.at( row ); }
+
+    // true if every token (normalised with StringPool::searchKey()) is part of the artist, album or track name
+    bool matches( int row, const QStringList& tokens ) const;
+
+    const StringPool& strings() const { return m_strings; }
+
+private:
+    int allocateRow();
+    // returns true if the row pointed at a different string before
+    bool setString( QVector< int >& column, int row, const QString& str );
+    template< typename T > bool setNumber( QVector< T >& column, int row, T value );
+
+    StringPool m_strings;
+
+    QVector< int > m_artist;
+    QVector< int > m_artistSortname;
+    QVector< int > m_album;
+    QVector< int > m_track;
+
+    QVector< unsigned int > m_trackId;
+    QVector< quint16 > m_albumpos;
+    QVector< quint8 > m_discnumber;
+    QVector< unsigned int > m_duration;
+    QVector< unsigned int > m_bitrate;
+    QVector< unsigned int > m_mtime;
+    QVector< unsigned int > m_size;
+
+    // only filled for rows added from a Record
+    QVector< unsigned int > m_fileId;
+    QVector< unsigned int > m_sourceId;
+    QVector< QString > m_url;
+    QVector< int > m_mimetype;
+    QVector< int > m_composer;
+    QVector< unsigned int > m_artistId;
+    QVector< unsigned int > m_albumId;
+    QVector< unsigned int > m_composerId;
+    // m_discnumber is at least 1 for sorting, this is the file's own
+    QVector< quint8 > m_fileDiscnumber;
+    QVector< quint16 > m_year;
+
+    // rows of removed items, reused by add()
+    QVector< int > m_freeRows;
+
+    unsigned int m_revision;
+};
+
+Q_DECLARE_METATYPE( TrackStore::Record )
+Q_DECLARE_METATYPE( QList< TrackStore::Record > )
+
+#endif // TRACKSTORE_H
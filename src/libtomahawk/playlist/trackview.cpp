@@ -34,6 +34,7 @@
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 #include "dropjob.h"
+#include "pipeline.h"
 #include "artist.h"
 #include "album.h"
 
@@ -167,9 +168,6 @@ TrackView::setTrackModel( TrackModel* model )
 void
 TrackView::onViewChanged()
 {
-    if ( m_model->style() != TrackModel::Short && m_model->style() != TrackModel::Large ) // eventual FIXME?
-        return;
-
     if ( m_timer.isActive() )
         m_timer.stop();
 
@@ -198,10 +196,24 @@ TrackView::onScrollTimeout()
     if ( !max )
         return;
 
+    // eventual FIXME?
+    const bool detailed = ( m_model->style() == TrackModel::Short || m_model->style() == TrackModel::Large );
+
+    QList< query_ptr > visible;
     for ( int i = left.row(); i <= max; i++ )
     {
-        m_model->updateDetailedInfo( m_proxyModel->mapToSource( m_proxyModel->index( i, 0 ) ) );
+        const QModelIndex index = m_proxyModel->mapToSource( m_proxyModel->index( i, 0 ) );
+
+        TrackModelItem* item = m_model->itemFromIndex( index );
+        if ( item && !item->query().isNull() )
+            visible << item->query();
+
+        if ( detailed )
+            m_model->updateDetailedInfo( index );
     }
+
+    // these get resolved first when the pipeline needs to resolve everything again
+    Pipeline::instance()->setVisibleQueries( visible );
 }
 
 
@@ -27,6 +27,7 @@
 #include "result.h"
 
 #include "utils/tomahawkutilsgui.h"
+#include "utils/thumbnailstore.h"
 #include "utils/logger.h"
 
 #include "treemodelitem.h"
@@ -39,6 +40,9 @@ TreeItemDelegate::TreeItemDelegate( ArtistView* parent, TreeProxyModel* proxy )
     , m_view( parent )
     , m_model( proxy )
 {
+    // the cover rects of TreeModel's album and artist rows, see paint()
+    Tomahawk::ThumbnailStore::instance()->addSize( QSize( 24, 24 ) );
+    Tomahawk::ThumbnailStore::instance()->addSize( QSize( 36, 36 ) );
 }
 
 
@@ -28,6 +28,7 @@
 #include "database/databasecommand_allalbums.h"
 #include "database/databasecommand_alltracks.h"
 #include "database/database.h"
+#include "database/databaseimpl.h"
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
@@ -45,10 +46,6 @@ TreeModel::TreeModel( QObject* parent )
 
     connect( AudioEngine::instance(), SIGNAL( started( Tomahawk::result_ptr ) ), SLOT( onPlaybackStarted( Tomahawk::result_ptr ) ), Qt::DirectConnection );
     connect( AudioEngine::instance(), SIGNAL( stopped() ), SLOT( onPlaybackStopped() ), Qt::DirectConnection );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-               SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
 }
 
 
@@ -625,7 +622,7 @@ TreeModel::addAlbums( const artist_ptr& artist, const QModelIndex& parent, bool
         requestData.input = QVariant::fromValue< Tomahawk::InfoSystem::InfoStringHash >( artistInfo );
         requestData.customData["refetch"] = QVariant( autoRefetch );
         requestData.type = Tomahawk::InfoSystem::InfoArtistReleases;
-        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
     }
     else
         Q_ASSERT( false );
@@ -667,7 +664,7 @@ TreeModel::addTracks( const album_ptr& album, const QModelIndex& parent, bool au
         requestData.type = Tomahawk::InfoSystem::InfoAlbumSongs;
         requestData.timeoutMillis = 0;
         requestData.allSources = true;
-        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+        Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
     }
     else
         Q_ASSERT( false );
@@ -994,6 +991,10 @@ void
 TreeModel::onDataChanged()
 {
     TreeModelItem* p = (TreeModelItem*)sender();
+
+    // names or album positions may have changed along with the results
+    releaseKeys( p );
+
     emit dataChanged( p->index, p->index.sibling( p->index.row(), columnCount( QModelIndex() ) - 1 ) );
 }
 
@@ -1020,3 +1021,76 @@ TreeModel::indexFromArtist( const Tomahawk::artist_ptr& artist ) const
 
     return QModelIndex();
 }
+
+
+const TreeModelItem::Keys&
+TreeModel::keys( TreeModelItem* item ) const
+{
+    TreeModelItem::Keys& keys = item->keys;
+    if ( keys.valid )
+        return keys;
+
+    keys.sortname = m_strings.intern( sortText( item ) );
+    keys.name = m_strings.intern( item->name() );
+    keys.artistName = m_strings.intern( item->artistName() );
+    keys.albumName = m_strings.intern( item->albumName() );
+
+    // the query's album position wins, the result's is only used when the query has none
+    keys.albumpos = 0;
+    keys.discnumber = 0;
+    if ( !item->query().isNull() )
+    {
+        keys.albumpos = item->query()->albumpos();
+        keys.discnumber = item->query()->discnumber();
+    }
+    if ( !item->result().isNull() )
+    {
+        if ( keys.albumpos == 0 )
+            keys.albumpos = item->result()->albumpos();
+        if ( keys.discnumber == 0 )
+            keys.discnumber = item->result()->discnumber();
+    }
+    keys.discnumber = qMax( 1, (int)keys.discnumber );
+
+    keys.valid = true;
+    return keys;
+}
+
+
+void
+TreeModel::releaseKeys( TreeModelItem* item ) const
+{
+    TreeModelItem::Keys& keys = item->keys;
+    if ( !keys.valid )
+        return;
+
+    m_strings.release( keys.sortname );
+    m_strings.release( keys.name );
+    m_strings.release( keys.artistName );
+    m_strings.release( keys.albumName );
+    keys.valid = false;
+}
+
+
+QString
+TreeModel::sortText( TreeModelItem* item )
+{
+    if ( !item->artist().isNull() )
+    {
+        return item->artist()->sortname();
+    }
+    else if ( !item->album().isNull() )
+    {
+        return DatabaseImpl::sortname( item->album()->name() );
+    }
+    else if ( !item->result().isNull() )
+    {
+        return DatabaseImpl::sortname( item->result()->track() );
+    }
+    else if ( !item->query().isNull() )
+    {
+        return item->query()->track();
+    }
+
+    return QString();
+}
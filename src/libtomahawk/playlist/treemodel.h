@@ -31,6 +31,7 @@
 #include "database/databasecommand_allartists.h"
 
 #include "treemodelitem.h"
+#include "trackstore.h"
 #include "infosystem/infosystem.h"
 
 #include "dllmacro.h"
@@ -124,6 +125,11 @@ public:
         }
     }
 
+    /// Sort and filter keys of item, interned in strings() on first use
+    const TreeModelItem::Keys& keys( TreeModelItem* item ) const;
+    void releaseKeys( TreeModelItem* item ) const;
+    const StringPool& strings() const { return m_strings; }
+
 public slots:
     virtual void setCurrentItem( const QModelIndex& index );
 
@@ -162,8 +168,11 @@ private slots:
     void onCollectionChanged();
 
 private:
+    static QString sortText( TreeModelItem* item );
+
     QPersistentModelIndex m_currentIndex;
     TreeModelItem* m_rootItem;
+    mutable StringPool m_strings;
     QString m_infoId;
 
     QString m_title;
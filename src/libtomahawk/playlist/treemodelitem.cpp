@@ -18,6 +18,7 @@
 
 #include "treemodelitem.h"
 
+#include "treemodel.h"
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 #include "artist.h"
@@ -39,6 +40,10 @@ TreeModelItem::~TreeModelItem()
     {
         parent->children.removeAt( index.row() );
     }
+
+    TreeModel* treeModel = qobject_cast< TreeModel* >( model );
+    if ( treeModel )
+        treeModel->releaseKeys( this );
 }
 
 
@@ -140,6 +145,9 @@ TreeModelItem::TreeModelItem( const Tomahawk::result_ptr& result, TreeModelItem*
     }
 
     toberemoved = false;
+
+    // the best of several duplicate results depends on whether they are online
+    connect( result.data(), SIGNAL( statusChanged() ), SIGNAL( dataChanged() ) );
 }
 
 
@@ -183,7 +191,10 @@ void
 TreeModelItem::onResultsChanged()
 {
     if ( m_query->numResults() )
+    {
         m_result = m_query->results().first();
+        connect( m_result.data(), SIGNAL( statusChanged() ), SIGNAL( dataChanged() ), Qt::UniqueConnection );
+    }
     else
         m_result = result_ptr();
 
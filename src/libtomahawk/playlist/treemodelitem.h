@@ -52,6 +52,21 @@ public:
     QString artistName() const;
     QString albumName() const;
 
+    // what TreeProxyModel sorts and filters on, interned in the model's StringPool by TreeModel::keys()
+    struct Keys
+    {
+        Keys() : valid( false ), sortname( 0 ), name( 0 ), artistName( 0 ), albumName( 0 ), albumpos( 0 ), discnumber( 0 ) {}
+
+        bool valid;
+        int sortname;
+        int name;
+        int artistName;
+        int albumName;
+        unsigned int albumpos;
+        unsigned int discnumber;
+    };
+    Keys keys;
+
     TreeModelItem* parent;
     QList<TreeModelItem*> children;
     QHash<QString, TreeModelItem*> hash;
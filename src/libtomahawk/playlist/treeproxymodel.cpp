@@ -19,13 +19,14 @@
 
 #include "treeproxymodel.h"
 
+#include <QtCore/QtConcurrentRun>
+#include <QtCore/QTimer>
 #include <QtGui/QListView>
 
 #include "treeproxymodelplaylistinterface.h"
 #include "source.h"
 #include "query.h"
 #include "database/database.h"
-#include "database/databaseimpl.h"
 #include "database/databasecommand_allalbums.h"
 #include "utils/logger.h"
 
@@ -34,6 +35,17 @@ TreeProxyModel::TreeProxyModel( QObject* parent )
     : QSortFilterProxyModel( parent )
     , m_artistsFilterCmd( 0 )
     , m_model( 0 )
+    , m_keysRevision( 0 )
+    , m_sortWatcher( 0 )
+    , m_sortGeneration( new QAtomicInt( 0 ) )
+    , m_pendingSortColumn( 0 )
+    , m_pendingSortOrder( Qt::AscendingOrder )
+    , m_pendingSortRevision( 0 )
+    , m_matchesWatcher( 0 )
+    , m_matchesGeneration( new QAtomicInt( 0 ) )
+    , m_pendingMatchesRevision( 0 )
+    , m_filterQueried( true )
+    , m_duplicatesChanged( false )
 {
     setFilterCaseSensitivity( Qt::CaseInsensitive );
     setSortCaseSensitivity( Qt::CaseInsensitive );
@@ -74,8 +86,17 @@ TreeProxyModel::setSourceTreeModel( TreeModel* sourceModel )
 
         connect( m_model, SIGNAL( rowsInserted( QModelIndex, int, int ) ), SLOT( onRowsInserted( QModelIndex, int, int ) ) );
         connect( m_model, SIGNAL( modelReset() ), SLOT( onModelReset() ) );
+
+        // before QSortFilterProxyModel gets to see the changes, so it doesn't use outdated positions
+        connect( m_model, SIGNAL( rowsInserted( QModelIndex, int, int ) ), SLOT( onSourceRowsChanged( QModelIndex ) ) );
+        connect( m_model, SIGNAL( rowsRemoved( QModelIndex, int, int ) ), SLOT( onSourceRowsChanged( QModelIndex ) ) );
+        connect( m_model, SIGNAL( dataChanged( QModelIndex, QModelIndex ) ), SLOT( onSourceDataChanged( QModelIndex ) ) );
+        connect( m_model, SIGNAL( layoutChanged() ), SLOT( invalidateKeys() ) );
+        connect( m_model, SIGNAL( modelReset() ), SLOT( invalidateKeys() ) );
     }
 
+    invalidateKeys();
+
     QSortFilterProxyModel::setSourceModel( sourceModel );
 }
 
@@ -106,7 +127,7 @@ TreeProxyModel::onRowsInserted( const QModelIndex& parent, int /* start */, int
 void
 TreeProxyModel::onModelReset()
 {
-    m_cache.clear();
+    m_duplicates.clear();
     m_artistsFilter.clear();
     m_albumsFilter.clear();
 }
@@ -120,6 +141,23 @@ TreeProxyModel::newFilterFromPlaylistInterface( const QString &pattern )
     m_filter = pattern;
     m_albumsFilter.clear();
 
+    m_filterTokens = SortKeys::filterTokens( pattern );
+
+    // the names of the top level rows get matched on a worker thread, while the database looks for artists and albums
+    cancelMatches();
+    m_matched = QBitArray();
+    m_filterQueried = false;
+
+    if ( !m_filterTokens.isEmpty() && m_model && m_model->rowCount( QModelIndex() ) >= SORTKEYS_ASYNC_ROWS )
+    {
+        const int job = m_matchesGeneration->fetchAndAddOrdered( 1 ) + 1;
+        m_pendingMatchesRevision = m_keysRevision;
+
+        m_matchesWatcher = new QFutureWatcher< QBitArray >( this );
+        connect( m_matchesWatcher, SIGNAL( finished() ), SLOT( onMatchesFinished() ) );
+        m_matchesWatcher->setFuture( QtConcurrent::run( &SortKeys::filterMatches, sortKeys(), m_filterTokens, m_matchesGeneration, job ) );
+    }
+
     if ( m_artistsFilterCmd )
     {
         disconnect( m_artistsFilterCmd, SIGNAL( artists( QList<Tomahawk::artist_ptr> ) ),
@@ -190,7 +228,36 @@ void
 TreeProxyModel::filterFinished()
 {
     m_artistsFilterCmd = 0;
+    m_filterQueried = true;
+
+    // applied once the worker thread is done matching as well
+    if ( m_matchesWatcher )
+        return;
+
+    applyFilter();
+}
 
+
+void
+TreeProxyModel::onMatchesFinished()
+{
+    QFutureWatcher< QBitArray >* watcher = m_matchesWatcher;
+    m_matchesWatcher = 0;
+    watcher->deleteLater();
+
+    // if the rows changed meanwhile filterAcceptsRow() matches them itself
+    const QBitArray matched = watcher->result();
+    if ( !matched.isNull() && m_pendingMatchesRevision == m_keysRevision )
+        m_matched = matched;
+
+    if ( m_filterQueried )
+        applyFilter();
+}
+
+
+void
+TreeProxyModel::applyFilter()
+{
     if ( qobject_cast< Tomahawk::TreeProxyModelPlaylistInterface* >( m_playlistInterface.data() )->vanillaFilter() != m_filter )
     {
         emit filterChanged( m_filter );
@@ -211,38 +278,19 @@ TreeProxyModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent
     TreeModelItem* item = sourceModel()->itemFromIndex( sourceModel()->index( sourceRow, 0, sourceParent ) );
     Q_ASSERT( item );
 
+    QString key;
     if ( m_model->mode() == Tomahawk::DatabaseMode && !item->result().isNull() )
     {
-        QList< Tomahawk::result_ptr > rl = m_cache.values( sourceParent );
-        foreach ( const Tomahawk::result_ptr& cachedResult, rl )
-        {
-            if ( cachedResult.isNull() )
-                continue;
+        const Tomahawk::result_ptr& result = item->result();
+        key = duplicateKey( result );
 
-            if ( cachedResult->track() == item->result()->track() &&
-               ( cachedResult->albumpos() == item->result()->albumpos() || cachedResult->albumpos() == 0 ) )
-            {
-                return ( cachedResult.data() == item->result().data() );
-            }
-        }
+        Duplicates& dupes = duplicates( sourceParent );
+        const int i = dupes.accepted.indexOf( key, result->albumpos() );
+        if ( i >= 0 )
+            return ( dupes.acceptedResults.at( i ).data() == result.data() );
 
-        for ( int i = 0; i < sourceModel()->rowCount( sourceParent ); i++ )
-        {
-            if ( i == sourceRow )
-                continue;
-
-            TreeModelItem* ti = sourceModel()->itemFromIndex( sourceModel()->index( i, 0, sourceParent ) );
-
-            if ( ti->name() == item->name() &&
-               ( ti->result()->albumpos() == item->result()->albumpos() || ti->result()->albumpos() == 0 || item->result()->albumpos() == 0 ) )
-            {
-                if ( !item->result()->isOnline() && ti->result()->isOnline() )
-                    return false;
-
-                if ( !item->result()->collection()->source()->isLocal() && ti->result()->collection()->source()->isLocal() )
-                    return false;
-            }
-        }
+        if ( dupes.best.indexOf( key, result->albumpos() ) != sourceRow )
+            return false;
     }
 
     bool accepted = false;
@@ -253,25 +301,96 @@ TreeProxyModel::filterAcceptsRow( int sourceRow, const QModelIndex& sourceParent
     else if ( !item->album().isNull() )
         accepted = m_albumsFilter.contains( item->album()->id() );
 
-    if ( !accepted )
+    if ( !accepted && !sourceParent.isValid() && sourceRow < m_matched.size() )
+    {
+        if ( !m_matched.testBit( sourceRow ) )
+            return false;
+    }
+    else if ( !accepted )
     {
-        QStringList sl = m_filter.split( " ", QString::SkipEmptyParts );
-        foreach( const QString& s, sl )
+        const TreeModelItem::Keys& keys = m_model->keys( item );
+        const StringPool& strings = m_model->strings();
+
+        foreach( const QString& token, m_filterTokens )
         {
-            if ( !item->name().contains( s, Qt::CaseInsensitive ) &&
-                 !item->albumName().contains( s, Qt::CaseInsensitive ) &&
-                 !item->artistName().contains( s, Qt::CaseInsensitive ) )
+            if ( !strings.key( keys.name ).contains( token ) &&
+                 !strings.key( keys.albumName ).contains( token ) &&
+                 !strings.key( keys.artistName ).contains( token ) )
             {
                 return false;
             }
         }
     }
 
-    m_cache.insertMulti( sourceParent, item->result() );
+    if ( !key.isEmpty() )
+    {
+        Duplicates& dupes = duplicates( sourceParent );
+        dupes.accepted.insert( key, item->result()->albumpos(), dupes.acceptedResults.count() );
+        dupes.acceptedResults << item->result();
+    }
+
     return true;
 }
 
 
+TreeProxyModel::Duplicates&
+TreeProxyModel::duplicates( const QModelIndex& sourceParent ) const
+{
+    Duplicates& dupes = m_duplicates[ sourceParent ];
+
+    const int rows = sourceModel()->rowCount( sourceParent );
+    if ( dupes.rows == rows )
+        return dupes;
+
+    dupes.rows = rows;
+    dupes.best.clear();
+
+    QList< Tomahawk::result_ptr > best;
+    for ( int i = 0; i < rows; i++ )
+    {
+        TreeModelItem* ti = sourceModel()->itemFromIndex( sourceModel()->index( i, 0, sourceParent ) );
+        if ( !ti || ti->result().isNull() )
+        {
+            best << Tomahawk::result_ptr();
+            continue;
+        }
+
+        const QString key = duplicateKey( ti->result() );
+        const int b = dupes.best.indexOf( key, ti->result()->albumpos() );
+        if ( b < 0 )
+            dupes.best.insert( key, ti->result()->albumpos(), i );
+        else if ( isBetterDuplicate( ti->result(), best.at( b ) ) )
+            dupes.best.replace( key, ti->result()->albumpos(), i );
+
+        best << ti->result();
+    }
+
+    return dupes;
+}
+
+
+QString
+TreeProxyModel::duplicateKey( const Tomahawk::result_ptr& result )
+{
+    return Tomahawk::Deduplicator::key( result->artist().isNull() ? QString() : result->artist()->name(),
+                                        result->album().isNull() ? QString() : result->album()->name(),
+                                        result->track() );
+}
+
+
+bool
+TreeProxyModel::isBetterDuplicate( const Tomahawk::result_ptr& result, const Tomahawk::result_ptr& other )
+{
+    // online results win, then those from the local collection
+    if ( result->isOnline() != other->isOnline() )
+        return result->isOnline();
+
+    const bool local = !result->collection().isNull() && result->collection()->source()->isLocal();
+    const bool otherLocal = !other->collection().isNull() && other->collection()->source()->isLocal();
+    return local && !otherLocal;
+}
+
+
 bool
 TreeProxyModel::lessThan( const QModelIndex& left, const QModelIndex& right ) const
 {
@@ -283,58 +402,39 @@ TreeProxyModel::lessThan( const QModelIndex& left, const QModelIndex& right ) co
     if ( !p2 )
         return false;
 
+    // sorted on the worker thread already, as long as the top level rows didn't change since
+    if ( !left.parent().isValid() && !right.parent().isValid() &&
+         left.row() < m_sortPositions.count() && right.row() < m_sortPositions.count() )
+    {
+        return m_sortPositions.at( left.row() ) < m_sortPositions.at( right.row() );
+    }
+
 /*    if ( !p1->result().isNull() && p2->result().isNull() )
         return true;
     if ( p1->result().isNull() && !p2->result().isNull() )
         return false;*/
 
-    unsigned int albumpos1 = 0;
-    unsigned int albumpos2 = 0;
-    unsigned int discnumber1 = 0;
-    unsigned int discnumber2 = 0;
-    if ( !p1->query().isNull() )
-    {
-        albumpos1 = p1->query()->albumpos();
-        discnumber1 = p1->query()->discnumber();
-    }
-    if ( !p2->query().isNull() )
-    {
-        albumpos2 = p2->query()->albumpos();
-        discnumber2 = p2->query()->discnumber();
-    }
-    if ( !p1->result().isNull() )
-    {
-        if ( albumpos1 == 0 )
-            albumpos1 = p1->result()->albumpos();
-        if ( discnumber1 == 0 )
-            discnumber1 = p1->result()->discnumber();
-    }
-    if ( !p2->result().isNull() )
-    {
-        if ( albumpos2 == 0 )
-            albumpos2 = p2->result()->albumpos();
-        if ( discnumber2 == 0 )
-            discnumber2 = p2->result()->discnumber();
-    }
-    discnumber1 = qMax( 1, (int)discnumber1 );
-    discnumber2 = qMax( 1, (int)discnumber2 );
+    // interned once per item, so sorting compares integers instead of normalising names every time
+    const TreeModelItem::Keys& keys1 = m_model->keys( p1 );
+    const TreeModelItem::Keys& keys2 = m_model->keys( p2 );
 
-    if ( discnumber1 != discnumber2 )
+    if ( keys1.discnumber != keys2.discnumber )
     {
-        return discnumber1 < discnumber2;
+        return keys1.discnumber < keys2.discnumber;
     }
     else
     {
-        if ( albumpos1 != albumpos2 )
-            return albumpos1 < albumpos2;
+        if ( keys1.albumpos != keys2.albumpos )
+            return keys1.albumpos < keys2.albumpos;
     }
 
-    const QString& lefts = textForItem( p1 );
-    const QString& rights = textForItem( p2 );
-    if ( lefts == rights )
-        return (qint64)&p1 < (qint64)&p2;
+    const StringPool& strings = m_model->strings();
+    const int rank1 = strings.rank( keys1.sortname );
+    const int rank2 = strings.rank( keys2.sortname );
+    if ( rank1 == rank2 )
+        return (qint64)p1 < (qint64)p2;
 
-    return QString::localeAwareCompare( lefts, rights ) < 0;
+    return rank1 < rank2;
 }
 
 
@@ -365,30 +465,152 @@ TreeProxyModel::removeIndexes( const QList<QModelIndex>& indexes )
 }
 
 
-QString
-TreeProxyModel::textForItem( TreeModelItem* item ) const
+void
+TreeProxyModel::sort( int column, Qt::SortOrder order )
 {
-    if ( !item )
-        return QString();
+    cancelSort();
 
-    if ( !item->artist().isNull() )
-    {
-        return item->artist()->sortname();
-    }
-    else if ( !item->album().isNull() )
+    if ( !m_model || m_model->rowCount( QModelIndex() ) < SORTKEYS_ASYNC_ROWS )
     {
-        return DatabaseImpl::sortname( item->album()->name() );
+        QSortFilterProxyModel::sort( column, order );
+        return;
     }
-    else if ( !item->result().isNull() )
+
+    const int job = m_sortGeneration->fetchAndAddOrdered( 1 ) + 1;
+    m_pendingSortColumn = column;
+    m_pendingSortOrder = order;
+    m_pendingSortRevision = m_keysRevision;
+
+    m_sortWatcher = new QFutureWatcher< QVector< int > >( this );
+    connect( m_sortWatcher, SIGNAL( finished() ), SLOT( onSortFinished() ) );
+    m_sortWatcher->setFuture( QtConcurrent::run( &SortKeys::sortPositions, sortKeys(), m_sortGeneration, job ) );
+}
+
+
+void
+TreeProxyModel::onSortFinished()
+{
+    QFutureWatcher< QVector< int > >* watcher = m_sortWatcher;
+    m_sortWatcher = 0;
+    watcher->deleteLater();
+
+    // if the rows changed meanwhile lessThan() compares them itself
+    const QVector< int > positions = watcher->result();
+    if ( !positions.isEmpty() && m_pendingSortRevision == m_keysRevision )
+        m_sortPositions = positions;
+
+    // a single re-sort that only compares the positions, one layout change for the views
+    QSortFilterProxyModel::sort( m_pendingSortColumn, m_pendingSortOrder );
+}
+
+
+SortKeys
+TreeProxyModel::sortKeys() const
+{
+    SortKeys keys;
+
+    const int rows = m_model->rowCount( QModelIndex() );
+    keys.rows.resize( rows );
+    for ( int i = 0; i < rows; i++ )
     {
-        return DatabaseImpl::sortname( item->result()->track() );
+        TreeModelItem* item = m_model->itemFromIndex( m_model->index( i, 0, QModelIndex() ) );
+        if ( !item )
+            continue;
+
+        const TreeModelItem::Keys& k = m_model->keys( item );
+        SortKeys::Row& row = keys.rows[i];
+        row.discnumber = k.discnumber;
+        row.albumpos = k.albumpos;
+        row.sortname = k.sortname;
+        row.name = k.name;
+        row.artistName = k.artistName;
+        row.albumName = k.albumName;
     }
-    else if ( !item->query().isNull() )
+
+    // copied after interning, so it knows every id used above
+    keys.strings = m_model->strings();
+    return keys;
+}
+
+
+void
+TreeProxyModel::onSourceRowsChanged( const QModelIndex& parent )
+{
+    if ( !parent.isValid() )
+        invalidateKeys();
+}
+
+
+void
+TreeProxyModel::onSourceDataChanged( const QModelIndex& topLeft )
+{
+    const QModelIndex parent = topLeft.parent();
+    if ( !parent.isValid() )
     {
-        return item->query()->track();
+        invalidateKeys();
+        return;
     }
 
-    return QString();
+    // a result went online or offline or got replaced, which may change the best of its duplicates
+    if ( !m_duplicates.remove( parent ) || m_duplicatesChanged )
+        return;
+
+    m_duplicatesChanged = true;
+    QTimer::singleShot( 0, this, SLOT( onDuplicatesChanged() ) );
+}
+
+
+void
+TreeProxyModel::onDuplicatesChanged()
+{
+    m_duplicatesChanged = false;
+    invalidateFilter();
+}
+
+
+void
+TreeProxyModel::invalidateKeys()
+{
+    m_keysRevision++;
+    m_sortPositions.clear();
+    m_matched = QBitArray();
+}
+
+
+void
+TreeProxyModel::cancelSort()
+{
+    m_sortGeneration->ref();
+
+    if ( !m_sortWatcher )
+        return;
+
+    // the job notices the new generation and stops early, its watcher goes away once it did
+    disconnect( m_sortWatcher, SIGNAL( finished() ), this, SLOT( onSortFinished() ) );
+    if ( m_sortWatcher->isFinished() )
+        m_sortWatcher->deleteLater();
+    else
+        connect( m_sortWatcher, SIGNAL( finished() ), m_sortWatcher, SLOT( deleteLater() ) );
+
+    m_sortWatcher = 0;
+}
+
+
+void
+TreeProxyModel::cancelMatches()
+{
+    m_matchesGeneration->ref();
+
+    if ( !m_matchesWatcher )
+        return;
+
+    disconnect( m_matchesWatcher, SIGNAL( finished() ), this, SLOT( onMatchesFinished() ) );
+    if ( m_matchesWatcher->isFinished() )
+        m_matchesWatcher->deleteLater();
+    else
+        connect( m_matchesWatcher, SIGNAL( finished() ), m_matchesWatcher, SLOT( deleteLater() ) );
+
+    m_matchesWatcher = 0;
 }
 
 
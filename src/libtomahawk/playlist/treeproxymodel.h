@@ -20,10 +20,13 @@
 #ifndef TREEPROXYMODEL_H
 #define TREEPROXYMODEL_H
 
+#include <QtCore/QFutureWatcher>
 #include <QSortFilterProxyModel>
 
 #include "playlistinterface.h"
 #include "treemodel.h"
+#include "sortkeys.h"
+#include "utils/deduplicator.h"
 
 #include "dllmacro.h"
 
@@ -40,7 +43,8 @@ Q_OBJECT
 
 public:
     explicit TreeProxyModel( QObject* parent = 0 );
-    virtual ~TreeProxyModel() {}
+    // stops running jobs early, their results aren't needed anymore
+    virtual ~TreeProxyModel() { m_sortGeneration->ref(); m_matchesGeneration->ref(); }
 
     virtual TreeModel* sourceModel() const { return m_model; }
     virtual void setSourceTreeModel( TreeModel* sourceModel );
@@ -51,6 +55,9 @@ public:
 
     virtual void newFilterFromPlaylistInterface( const QString &pattern );
 
+    // large models get their top level rows sorted on a worker thread, the new order is applied in one go
+    virtual void sort( int column, Qt::SortOrder order = Qt::AscendingOrder );
+
     virtual void removeIndex( const QModelIndex& index );
     virtual void removeIndexes( const QList<QModelIndex>& indexes );
 
@@ -77,20 +84,72 @@ private slots:
 
     void onModelReset();
 
+    void onSourceRowsChanged( const QModelIndex& parent );
+    void onSourceDataChanged( const QModelIndex& topLeft );
+    void onDuplicatesChanged();
+    void invalidateKeys();
+
+    void onSortFinished();
+    void onMatchesFinished();
+
 private:
     void filterFinished();
-    QString textForItem( TreeModelItem* item ) const;
+    void applyFilter();
+
+    SortKeys sortKeys() const;
+    void cancelSort();
+    void cancelMatches();
 
-    mutable QMap< QPersistentModelIndex, Tomahawk::result_ptr > m_cache;
+    struct Duplicates
+    {
+        Duplicates() : rows( -1 ) {}
+
+        // best row for every track below a parent, rebuilt when the row count or one of the results changes
+        int rows;
+        Tomahawk::Deduplicator best;
+        // results accepted so far, they stay even when better ones show up later
+        Tomahawk::Deduplicator accepted;
+        QList< Tomahawk::result_ptr > acceptedResults;
+    };
+
+    Duplicates& duplicates( const QModelIndex& sourceParent ) const;
+    static QString duplicateKey( const Tomahawk::result_ptr& result );
+    static bool isBetterDuplicate( const Tomahawk::result_ptr& result, const Tomahawk::result_ptr& other );
+
+    mutable QMap< QPersistentModelIndex, Duplicates > m_duplicates;
+    // a result changed below some parent, its siblings get filtered again once control returns
+    bool m_duplicatesChanged;
 
     QList<Tomahawk::artist_ptr> m_artistsFilter;
     QList<int> m_albumsFilter;
     DatabaseCommand_AllArtists* m_artistsFilterCmd;
 
      QString m_filter;
+    // m_filter split into words and normalised like StringPool keys
+    QStringList m_filterTokens;
 
     TreeModel* m_model;
 
+    // bumped whenever top level rows change, results of jobs started before are outdated
+    unsigned int m_keysRevision;
+
+    // jobs check their generation and give up once a newer job bumped it
+    QFutureWatcher< QVector< int > >* m_sortWatcher;
+    QSharedPointer< QAtomicInt > m_sortGeneration;
+    int m_pendingSortColumn;
+    Qt::SortOrder m_pendingSortOrder;
+    unsigned int m_pendingSortRevision;
+    // position of every top level source row in the order computed by the last sort job
+    QVector< int > m_sortPositions;
+
+    QFutureWatcher< QBitArray >* m_matchesWatcher;
+    QSharedPointer< QAtomicInt > m_matchesGeneration;
+    unsigned int m_pendingMatchesRevision;
+    // whether each top level source row matches m_filterTokens, null unless a job computed it
+    QBitArray m_matched;
+    // the database part of the filter is done, it gets applied once the matches are in as well
+    bool m_filterQueried;
+
     Tomahawk::playlistinterface_ptr m_playlistInterface;
 };
 
@@ -45,9 +45,12 @@ Query::get( const QString& artist, const QString& track, const QString& album, c
     if ( qid.isEmpty() )
         autoResolve = false;
 
-    query_ptr q = query_ptr( new Query( artist, track, album, qid, autoResolve ), &QObject::deleteLater );
+    query_ptr q = query_ptr( new Query( artist, track, album, qid ), &QObject::deleteLater );
     q->setWeakRef( q.toWeakRef() );
 
+    if ( Pipeline::instance() )
+        Pipeline::instance()->watch( q, autoResolve );
+
     if ( autoResolve )
         Pipeline::instance()->resolve( q );
 
@@ -63,13 +66,16 @@ Query::get( const QString& query, const QID& qid )
     q->setWeakRef( q.toWeakRef() );
 
     if ( !qid.isEmpty() )
+    {
+        Pipeline::instance()->watch( q, true );
         Pipeline::instance()->resolve( q );
+    }
 
     return q;
 }
 
 
-Query::Query( const QString& artist, const QString& track, const QString& album, const QID& qid, bool autoResolve )
+Query::Query( const QString& artist, const QString& track, const QString& album, const QID& qid )
     : m_qid( qid )
     , m_artist( artist )
     , m_album( album )
@@ -77,16 +83,6 @@ Query::Query( const QString& artist, const QString& track, const QString& album,
     , m_socialActionsLoaded( false )
 {
     init();
-
-    if ( autoResolve )
-    {
-        connect( Database::instance(), SIGNAL( indexReady() ), SLOT( refreshResults() ), Qt::QueuedConnection );
-    }
-
-    connect( Pipeline::instance(), SIGNAL( resolverAdded( Resolver* ) ),
-             SLOT( onResolverAdded() ), Qt::QueuedConnection );
-    connect( Pipeline::instance(), SIGNAL( resolverRemoved( Resolver* ) ),
-             SLOT( onResolverRemoved() ), Qt::QueuedConnection );
 }
 
 
@@ -95,16 +91,14 @@ Query::Query( const QString& query, const QID& qid )
     , m_fullTextQuery( query )
 {
     init();
-
-    if ( !qid.isEmpty() )
-    {
-        connect( Database::instance(), SIGNAL( indexReady() ), SLOT( refreshResults() ), Qt::QueuedConnection );
-    }
 }
 
 
 Query::~Query()
 {
+    if ( Pipeline::instance() )
+        Pipeline::instance()->unwatch( this );
+
     QMutexLocker lock( &m_mutex );
     m_ownRef.clear();
     m_results.clear();
@@ -255,26 +249,6 @@ Query::onResolvingFinished()
 }
 
 
-void
-Query::onResolverAdded()
-{
-    if ( !solved() )
-    {
-        refreshResults();
-    }
-}
-
-
-void
-Query::onResolverRemoved()
-{
-    if ( !solved() )
-    {
-        refreshResults();
-    }
-}
-
-
 QList< result_ptr >
 Query::results() const
 {
@@ -665,8 +639,13 @@ Query::cover( const QSize& size, bool forceLoad ) const
     m_albumPtr->cover( size, forceLoad );
     if ( m_albumPtr->infoLoaded() )
     {
-        if ( !m_albumPtr->cover( size ).isNull() )
-            return m_albumPtr->cover( size );
+        const QPixmap albumCover = m_albumPtr->cover( size );
+        if ( !albumCover.isNull() )
+            return albumCover;
+
+        // don't flash the artist's image while the album's own cover is still being decoded
+        if ( m_albumPtr->coverPending( size ) )
+            return QPixmap();
 
         return m_artistPtr->cover( size );
     }
@@ -77,6 +77,8 @@ public:
     bool isFullTextQuery() const { return !m_fullTextQuery.isEmpty(); }
     bool resolvingFinished() const { return m_resolveFinished; }
     float howSimilar( const Tomahawk::result_ptr& r );
+    // edit distance of two names, the core of howSimilar()
+    static int levenshtein( const QString& source, const QString& target );
 
     QPair< Tomahawk::source_ptr, unsigned int > playedBy() const;
     Tomahawk::Resolver* currentResolver() const;
@@ -151,10 +153,6 @@ public slots:
 
     void onResolvingFinished();
 
-    // resolve if not solved()
-    void onResolverAdded();
-    void onResolverRemoved();
-    
 private slots:
     void onResultStatusChanged();
     void refreshResults();
@@ -162,7 +160,7 @@ private slots:
 
 private:
     Query();
-    explicit Query( const QString& artist, const QString& track, const QString& album, const QID& qid, bool autoResolve );
+    explicit Query( const QString& artist, const QString& track, const QString& album, const QID& qid );
     explicit Query( const QString& query, const QID& qid );
 
     void init();
@@ -172,7 +170,6 @@ private:
     void checkResults();
 
     void updateSortNames();
-    static int levenshtein( const QString& source, const QString& target );
 
     void parseSocialActions();
 
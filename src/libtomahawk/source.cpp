@@ -196,6 +196,8 @@ Source::setOffline()
         return;
 
     m_online = false;
+    if ( m_id > 0 )
+        Database::instance()->setSourceOnline( m_id, false );
     emit offline();
 
     m_currentTrack.clear();
@@ -215,6 +217,8 @@ Source::setOnline()
         return;
 
     m_online = true;
+    if ( m_id > 0 )
+        Database::instance()->setSourceOnline( m_id, true );
     emit online();
 
     // ensure username is in the database
@@ -231,6 +235,9 @@ Source::dbLoaded( unsigned int id, const QString& fname )
     m_id = id;
     setFriendlyName( fname );
 
+    if ( m_online )
+        Database::instance()->setSourceOnline( m_id, true );
+
     emit syncedWithDatabase();
 }
 
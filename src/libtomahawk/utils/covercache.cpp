@@ -0,0 +1,187 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "covercache.h"
+
+#include <QtConcurrentRun>
+
+#include "utils/thumbnailstore.h"
+#include "utils/logger.h"
+
+using namespace Tomahawk;
+
+CoverCache* CoverCache::s_instance = 0;
+
+
+CoverCache*
+CoverCache::instance()
+{
+    if ( !s_instance )
+        s_instance = new CoverCache();
+
+    return s_instance;
+}
+
+
+CoverCache::CoverCache()
+    : QObject()
+{
+    m_cache.setMaxCost( COVERCACHE_DEFAULT_BUDGET );
+}
+
+
+QString
+CoverCache::cacheKey( const QString& key, int generation, const QSize& size )
+{
+    // all empty sizes mean the unscaled image
+    const QSize s = size.isEmpty() ? QSize() : size;
+    return QString( "%1#%2@%3x%4" ).arg( key ).arg( generation ).arg( s.width() ).arg( s.height() );
+}
+
+
+QImage
+CoverCache::decode( const QByteArray& data, const QSize& size )
+{
+    QImage image;
+    if ( !image.loadFromData( data ) )
+        return QImage();
+
+    if ( size.isEmpty() )
+        return image;
+
+    return image.scaled( size, Qt::KeepAspectRatio, Qt::SmoothTransformation );
+}
+
+
+void
+CoverCache::insert( const QString& cacheKey, const QPixmap& pixmap )
+{
+    // cost in KB, so a budget of a few hundred megabytes still fits into an int
+    const int cost = qMax( 1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024 );
+    m_cache.insert( cacheKey, new QPixmap( pixmap ), cost );
+}
+
+
+QPixmap
+CoverCache::pixmap( const QString& key, int generation, const QByteArray& data, const QSize& size, QObject* receiver, bool persistent )
+{
+    const QString ck = cacheKey( key, generation, size );
+    if ( QPixmap* cached = m_cache.object( ck ) )
+        return *cached;
+
+    // the ThumbnailStore only keeps thumbnails, never the unscaled image
+    persistent = persistent && !size.isEmpty();
+
+    const quint32 checksum = data.isEmpty() ? 0 : qHash( data );
+    if ( persistent && ( data.isEmpty() || ThumbnailStore::instance()->checksum( key ) == checksum ) )
+    {
+        const QImage thumbnail = ThumbnailStore::instance()->image( key, size );
+        if ( !thumbnail.isNull() )
+        {
+            const QPixmap pixmap = QPixmap::fromImage( thumbnail );
+            insert( ck, pixmap );
+            return pixmap;
+        }
+    }
+
+    if ( data.isEmpty() )
+        return QPixmap();
+
+    QFutureWatcher< QImage >* watcher = m_pending.value( ck );
+    if ( !watcher )
+    {
+        watcher = new QFutureWatcher< QImage >( this );
+        connect( watcher, SIGNAL( finished() ), SLOT( onDecoded() ) );
+
+        Job job;
+        job.key = key;
+        job.cacheKey = ck;
+        job.size = size;
+        job.persistent = persistent;
+        job.checksum = checksum;
+        m_jobs.insert( watcher, job );
+        m_pending.insert( ck, watcher );
+
+        watcher->setFuture( QtConcurrent::run( &CoverCache::decode, data, size ) );
+    }
+
+    Job& job = m_jobs[ watcher ];
+    if ( receiver && !job.receivers.contains( receiver ) )
+        job.receivers << QPointer< QObject >( receiver );
+
+    return QPixmap();
+}
+
+
+bool
+CoverCache::isPending( const QString& key, int generation, const QSize& size ) const
+{
+    return m_pending.contains( cacheKey( key, generation, size ) );
+}
+
+
+void
+CoverCache::coverChanged( const QString& key, const QByteArray& data )
+{
+    ThumbnailStore* store = ThumbnailStore::instance();
+    if ( store->contains( key ) && store->checksum( key ) == qHash( data ) )
+        return;
+
+    store->remove( key );
+
+    const QString prefix = key + "#";
+    foreach ( const QString& ck, m_cache.keys() )
+    {
+        if ( ck.startsWith( prefix ) )
+            m_cache.remove( ck );
+    }
+}
+
+
+void
+CoverCache::onDecoded()
+{
+    QFutureWatcher< QImage >* watcher = static_cast< QFutureWatcher< QImage >* >( sender() );
+    const Job job = m_jobs.take( watcher );
+    m_pending.remove( job.cacheKey );
+
+    const QImage image = watcher->result();
+    watcher->deleteLater();
+
+    // a failed decode is cached as a null pixmap, so repainting doesn't retry it over and over
+    if ( image.isNull() )
+    {
+        tDebug() << Q_FUNC_INFO << "Could not decode cover" << job.cacheKey;
+        insert( job.cacheKey, QPixmap() );
+    }
+    else
+    {
+        // QPixmaps can only be created in the GUI thread
+        insert( job.cacheKey, QPixmap::fromImage( image ) );
+
+        if ( job.persistent )
+            ThumbnailStore::instance()->store( job.key, job.size, job.checksum, image );
+    }
+
+    // receivers also get told about failures, so nobody keeps waiting for this cover
+    foreach ( const QPointer< QObject >& receiver, job.receivers )
+    {
+        if ( !receiver.isNull() )
+            QMetaObject::invokeMethod( receiver.data(), "coverReady" );
+    }
+}
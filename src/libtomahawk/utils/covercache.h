@@ -0,0 +1,105 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COVERCACHE_H
+#define COVERCACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QPixmap>
+#include <QPointer>
+#include <QFutureWatcher>
+
+#include "dllmacro.h"
+
+// default budget for all decoded and scaled covers together, in KB
+#define COVERCACHE_DEFAULT_BUDGET (48 * 1024)
+
+namespace Tomahawk
+{
+
+/*
+    One LRU cache for the decoded and scaled cover art of all albums and
+    artists, limited by the bytes the pixmaps use. Decoding and scaling
+    happen on the global thread pool, so painting never waits for them.
+    Must only be used from the GUI thread.
+*/
+class DLLEXPORT CoverCache : public QObject
+{
+Q_OBJECT
+
+public:
+    static CoverCache* instance();
+
+    /*
+        Returns the image in data scaled to size, if it is cached. Otherwise
+        decoding is scheduled and a null pixmap is returned, so the caller can
+        paint a placeholder. Once decoding is done, whether it succeeded or
+        not, receiver's coverReady() slot gets invoked. An empty size asks for
+        the unscaled image, which is decoded the same way.
+
+        generation must change whenever data does, so an image decoded from an
+        older buffer never gets served for a newer one.
+
+        Persistent keys (e.g. "album/42") also get their scaled images saved
+        to the ThumbnailStore. Those are served from there even before data
+        has been loaded, so a cold start doesn't need to decode anything.
+    */
+    QPixmap pixmap( const QString& key, int generation, const QByteArray& data, const QSize& size, QObject* receiver, bool persistent = false );
+
+    // true while the image for key, generation and size is being decoded
+    bool isPending( const QString& key, int generation, const QSize& size ) const;
+
+    // call when the source image for key got (re)loaded, drops thumbnails made from a different image
+    void coverChanged( const QString& key, const QByteArray& data );
+
+    int budget() const { return m_cache.maxCost(); }
+    void setBudget( int kilobytes ) { m_cache.setMaxCost( kilobytes ); }
+
+private slots:
+    void onDecoded();
+
+private:
+    explicit CoverCache();
+
+    void insert( const QString& cacheKey, const QPixmap& pixmap );
+    static QString cacheKey( const QString& key, int generation, const QSize& size );
+    static QImage decode( const QByteArray& data, const QSize& size );
+
+    QCache< QString, QPixmap > m_cache;
+
+    struct Job
+    {
+        QString key;
+        QString cacheKey;
+        QSize size;
+        bool persistent;
+        quint32 checksum;
+        QList< QPointer< QObject > > receivers;
+    };
+    QHash< QString, QFutureWatcher< QImage >* > m_pending;
+    QHash< QFutureWatcher< QImage >*, Job > m_jobs;
+
+    static CoverCache* s_instance;
+};
+
+}
+
+#endif // COVERCACHE_H
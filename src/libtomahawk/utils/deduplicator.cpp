@@ -0,0 +1,86 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deduplicator.h"
+
+#include "database/databaseimpl.h"
+
+using namespace Tomahawk;
+
+
+static inline bool
+samePosition( unsigned int left, unsigned int right )
+{
+    return left == right || left == 0 || right == 0;
+}
+
+
+Deduplicator::Deduplicator()
+{
+}
+
+
+QString
+Deduplicator::key( const QString& artist, const QString& album, const QString& track )
+{
+    return DatabaseImpl::sortname( artist ) + QChar( '\t' ) +
+           DatabaseImpl::sortname( album ) + QChar( '\t' ) +
+           DatabaseImpl::sortname( track );
+}
+
+
+int
+Deduplicator::indexOf( const QString& key, unsigned int albumpos ) const
+{
+    QHash< QString, QList< QPair< unsigned int, int > > >::const_iterator it = m_entries.constFind( key );
+    if ( it == m_entries.constEnd() )
+        return -1;
+
+    for ( int i = 0; i < it.value().count(); i++ )
+    {
+        if ( samePosition( it.value().at( i ).first, albumpos ) )
+            return it.value().at( i ).second;
+    }
+
+    return -1;
+}
+
+
+void
+Deduplicator::insert( const QString& key, unsigned int albumpos, int index )
+{
+    m_entries[ key ] << qMakePair( albumpos, index );
+}
+
+
+void
+Deduplicator::replace( const QString& key, unsigned int albumpos, int index )
+{
+    QHash< QString, QList< QPair< unsigned int, int > > >::iterator it = m_entries.find( key );
+    if ( it == m_entries.end() )
+        return;
+
+    for ( int i = 0; i < it.value().count(); i++ )
+    {
+        if ( samePosition( it.value().at( i ).first, albumpos ) )
+        {
+            it.value()[ i ] = qMakePair( albumpos, index );
+            return;
+        }
+    }
+}
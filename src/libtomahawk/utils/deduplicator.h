@@ -0,0 +1,64 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEDUPLICATOR_H
+#define DEDUPLICATOR_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+#include "dllmacro.h"
+
+namespace Tomahawk
+{
+
+/*
+    Finds duplicate tracks in linear time by hashing their normalised
+    artist, album and track names. Within one key an albumpos of 0
+    (unknown) matches any position, so the few tracks sharing a key are
+    told apart by their albumpos.
+
+    Callers store an index into their own list for every kept track and
+    decide themselves which of two duplicates wins.
+*/
+class DLLEXPORT Deduplicator
+{
+public:
+    Deduplicator();
+
+    static QString key( const QString& artist, const QString& album, const QString& track );
+
+    // index stored for a duplicate of this track, -1 if there is none yet
+    int indexOf( const QString& key, unsigned int albumpos ) const;
+
+    void insert( const QString& key, unsigned int albumpos, int index );
+    // points the duplicate found by indexOf() to another index
+    void replace( const QString& key, unsigned int albumpos, int index );
+
+    void clear() { m_entries.clear(); }
+    int count() const { return m_entries.count(); }
+
+private:
+    QHash< QString, QList< QPair< unsigned int, int > > > m_entries;
+};
+
+}
+
+#endif // DEDUPLICATOR_H
@@ -21,7 +21,6 @@
 
 
 #include <QApplication>
-#include <QDomDocument>
 #include <QMessageBox>
 
 #include <qjson/parser.h>
@@ -31,12 +30,21 @@
 
 #include "sourcelist.h"
 #include "playlist.h"
+#include "pipeline.h"
+
+// how many parsed tracks get handed to the pipeline at once
+#define JSPFLOADER_RESOLVE_BATCH 100
 
 using namespace Tomahawk;
 
 JSPFLoader::JSPFLoader( bool autoCreate, QObject *parent )
     : QObject( parent )
     , m_autoCreate( autoCreate )
+    , m_depth( 0 )
+    , m_inString( false )
+    , m_escaped( false )
+    , m_inTracks( false )
+    , m_skippedTracks( false )
 {}
 
 JSPFLoader::~JSPFLoader()
@@ -57,6 +65,9 @@ JSPFLoader::load( const QUrl& url )
     Q_ASSERT( TomahawkUtils::nam() != 0 );
     QNetworkReply* reply = TomahawkUtils::nam()->get( request );
 
+    connect( reply, SIGNAL( readyRead() ),
+             SLOT( networkReadyRead() ) );
+
     // isn't there a race condition here? something could happen before we connect()
     // no---the event loop is needed to make the request, i think (leo)
     connect( reply, SIGNAL( finished() ),
@@ -72,7 +83,9 @@ JSPFLoader::load( QFile& file )
 {
     if( file.open( QFile::ReadOnly ) )
     {
-        m_body = file.readAll();
+        while ( !file.atEnd() )
+            parse( file.read( 64 * 1024 ) );
+
         gotBody();
     }
     else
@@ -91,11 +104,19 @@ JSPFLoader::reportError()
 }
 
 
+void
+JSPFLoader::networkReadyRead()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    parse( reply->readAll() );
+}
+
+
 void
 JSPFLoader::networkLoadFinished()
 {
     QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
-    m_body = reply->readAll();
+    parse( reply->readAll() );
     gotBody();
 }
 
@@ -108,12 +129,154 @@ JSPFLoader::networkError( QNetworkReply::NetworkError e )
 }
 
 
+void
+JSPFLoader::parse( const QByteArray& data )
+{
+    // JSON's structural characters are all ASCII, so scanning the UTF-8 bytes is fine
+    for ( int i = 0; i < data.length(); i++ )
+    {
+        const char c = data.at( i );
+
+        if ( m_inString )
+        {
+            if ( m_escaped )
+                m_escaped = false;
+            else if ( c == '\\' )
+                m_escaped = true;
+            else if ( c == '"' )
+                m_inString = false;
+
+            // keys of the playlist object, kept raw, escapes included
+            if ( m_inString && m_depth == 2 )
+                m_lastString += c;
+        }
+        else if ( c == '"' )
+        {
+            m_inString = true;
+            m_lastString.clear();
+        }
+        else if ( c == ':' && m_depth == 2 )
+        {
+            m_key = unescapedKey( m_lastString );
+        }
+        else if ( c == '{' || c == '[' )
+        {
+            m_depth++;
+            if ( c == '[' && m_depth == 3 && m_key == "track" )
+            {
+                m_inTracks = true;
+                m_skeleton += c;
+                continue;
+            }
+        }
+        else if ( c == '}' || c == ']' )
+        {
+            m_depth--;
+            if ( m_inTracks && m_depth == 2 )
+                m_inTracks = false;
+        }
+
+        if ( !m_inTracks )
+        {
+            m_skeleton += c;
+            continue;
+        }
+
+        // inside the track array, only the objects themselves matter
+        if ( m_depth > 3 || ( c == '}' && m_depth == 3 ) )
+            m_trackBody += c;
+
+        if ( c == '}' && m_depth == 3 )
+        {
+            QJson::Parser p;
+            bool retOk;
+            const QVariantMap tM = p.parse( m_trackBody, &retOk ).toMap();
+            m_trackBody.clear();
+
+            if ( retOk )
+                addTrack( tM );
+            else
+                tLog() << "Failed to parse jspf track:" << p.errorString();
+        }
+    }
+
+    if ( m_unresolved.count() >= JSPFLOADER_RESOLVE_BATCH )
+        resolvePending();
+}
+
+
+void
+JSPFLoader::addTrack( const QVariantMap& tM )
+{
+    QString artist, album, track, duration, annotation, url;
+
+    artist = tM.value( "creator" ).toString();
+    album = tM.value( "album" ).toString();
+    track = tM.value( "title" ).toString();
+    duration = tM.value( "duration" ).toString();
+    annotation = tM.value( "annotation" ).toString();
+    if ( tM.value( "location" ).toList().size() > 0 )
+        url = tM.value( "location" ).toList().first().toString();
+
+    if( artist.isEmpty() || track.isEmpty() )
+    {
+        // told once the document is complete, a message box here would re-enter parse()
+        m_skippedTracks = true;
+        return;
+    }
+
+    // resolved in batches by resolvePending(), but still resolved again once the index is ready
+    query_ptr q = Tomahawk::Query::get( artist, track, album, uuid(), false );
+    Pipeline::instance()->watch( q, true );
+    q->setDuration( duration.toInt() / 1000 );
+    if( !url.isEmpty() )
+        q->setResultHint( url );
+
+    m_entries << q;
+    m_unresolved << q;
+}
+
+
+QByteArray
+JSPFLoader::unescapedKey( const QByteArray& raw )
+{
+    if ( !raw.contains( '\\' ) )
+        return raw;
+
+    QJson::Parser p;
+    bool retOk;
+    const QVariantList l = p.parse( "[\"" + raw + "\"]", &retOk ).toList();
+
+    return retOk ? l.value( 0 ).toString().toUtf8() : raw;
+}
+
+
+void
+JSPFLoader::resolvePending()
+{
+    if ( m_unresolved.isEmpty() )
+        return;
+
+    // only the first batch jumps the queue, so the playlist still resolves top to bottom
+    Pipeline::instance()->resolve( m_unresolved, m_entries.count() == m_unresolved.count() );
+    m_unresolved.clear();
+}
+
+
 void
 JSPFLoader::gotBody()
 {
+    resolvePending();
+
+    if ( m_skippedTracks )
+    {
+        QMessageBox::warning( 0, tr( "Failed to save tracks" ), tr( "Some tracks in the playlist do not contain an artist and a title. They will be ignored." ), QMessageBox::Ok );
+        m_skippedTracks = false;
+    }
+
     QJson::Parser p;
     bool retOk;
-    QVariantMap wrapper = p.parse( m_body, &retOk ).toMap();
+    QVariantMap wrapper = p.parse( m_skeleton, &retOk ).toMap();
 
     if ( !retOk )
     {
@@ -138,43 +301,6 @@ JSPFLoader::gotBody()
     if ( !m_overrideTitle.isEmpty() )
         m_title = m_overrideTitle;
 
-    if ( pl.contains( "track" ) )
-    {
-        QVariantList tracks = pl.value( "track" ).toList();
-
-        bool shownError = false;
-        foreach ( const QVariant& currentTrack, tracks )
-        {
-            QVariantMap tM = currentTrack.toMap();
-            QString artist, album, track, duration, annotation, url;
-
-            artist = tM.value( "creator" ).toString();
-            album = tM.value( "album" ).toString();
-            track = tM.value( "title" ).toString();
-            duration = tM.value( "duration" ).toString();
-            annotation = tM.value( "annotation" ).toString();
-            if ( tM.value( "location" ).toList().size() > 0 )
-                url = tM.value( "location" ).toList().first().toString();
-
-            if( artist.isEmpty() || track.isEmpty() )
-            {
-                if( !shownError )
-                {
-                    QMessageBox::warning( 0, tr( "Failed to save tracks" ), tr( "Some tracks in the playlist do not contain an artist and a title. They will be ignored." ), QMessageBox::Ok );
-                    shownError = true;
-                }
-                continue;
-            }
-
-            query_ptr q = Tomahawk::Query::get( artist, track, album, uuid() );
-            q->setDuration( duration.toInt() / 1000 );
-            if( !url.isEmpty() )
-                q->setResultHint( url );
-
-            m_entries << q;
-        }
-    }
-
     if ( origTitle.isEmpty() && m_entries.isEmpty() )
     {
         if ( m_autoCreate )
@@ -54,19 +54,41 @@ public slots:
     void load( QFile& file );
 
 private slots:
+    void networkReadyRead();
     void networkLoadFinished();
     void networkError( QNetworkReply::NetworkError e );
 
 private:
     void reportError();
+    void parse( const QByteArray& data );
+    void addTrack( const QVariantMap& tM );
+    static QByteArray unescapedKey( const QByteArray& raw );
+    void resolvePending();
     void gotBody();
 
     bool m_autoCreate;
     QList< Tomahawk::query_ptr > m_entries;
     QString m_title, m_info, m_creator, m_overrideTitle;
 
-    QByteArray m_body;
     Tomahawk::playlist_ptr m_playlist;
+
+    /*
+        The track objects are cut out of the document and parsed one by one
+        while it is still downloading. Everything else ends up in m_skeleton,
+        with an empty track array, which gets parsed at the end.
+    */
+    QByteArray m_skeleton;
+    QByteArray m_trackBody;
+    int m_depth;
+    bool m_inString;
+    bool m_escaped;
+    bool m_inTracks;
+    QByteArray m_lastString;
+    QByteArray m_key;
+    // tracks without an artist or title were left out, warned about at the end
+    bool m_skippedTracks;
+    // parsed but not yet handed to the pipeline
+    QList< Tomahawk::query_ptr > m_unresolved;
 };
 
 }
@@ -24,6 +24,7 @@
 #include "sourcelist.h"
 
 #include "playlist.h"
+#include "pipeline.h"
 #include "dropjob.h"
 
 #include <QFileInfo>
@@ -33,6 +34,9 @@
 #include <taglib/fileref.h>
 #include <taglib/tag.h>
 
+// how many parsed tracks get handed to the pipeline at once
+#define M3ULOADER_RESOLVE_BATCH 100
+
 using namespace Tomahawk;
 
 
@@ -90,12 +94,33 @@ M3uLoader::getTags( const QFileInfo& info )
     else
     {
         qDebug() << Q_FUNC_INFO << artist << track << album;
-        Tomahawk::query_ptr q = Tomahawk::Query::get( artist, track, album, uuid(), !m_createNewPlaylist );
+        // resolved in batches by resolvePending(), but still resolved again once the index is ready
+        Tomahawk::query_ptr q = Tomahawk::Query::get( artist, track, album, uuid(), false );
+        Pipeline::instance()->watch( q, true );
         m_tracks << q;
+
+        if ( !m_createNewPlaylist )
+        {
+            m_unresolved << q;
+            if ( m_unresolved.count() >= M3ULOADER_RESOLVE_BATCH )
+                resolvePending();
+        }
     }
 }
 
 
+void
+M3uLoader::resolvePending()
+{
+    if ( m_unresolved.isEmpty() )
+        return;
+
+    // only the first batch jumps the queue, so the playlist still resolves top to bottom
+    Pipeline::instance()->resolve( m_unresolved, m_tracks.count() == m_unresolved.count() );
+    m_unresolved.clear();
+}
+
+
 void
 M3uLoader::parseM3u( const QString& fileLink )
 {
@@ -129,6 +154,8 @@ M3uLoader::parseM3u( const QString& fileLink )
          }
     }
 
+    resolvePending();
+
     if ( m_tracks.isEmpty() )
     {
         tDebug() << Q_FUNC_INFO << "Could not parse M3U!";
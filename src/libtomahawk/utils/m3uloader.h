@@ -54,7 +54,11 @@ signals:
 private:
     void parseM3u( const QString& track );
     void getTags( const QFileInfo& info );
+    void resolvePending();
+
     QList< query_ptr > m_tracks;
+    // parsed but not yet handed to the pipeline
+    QList< query_ptr > m_unresolved;
     QString m_title, m_info, m_creator;
     bool m_single;
     bool m_trackMode;
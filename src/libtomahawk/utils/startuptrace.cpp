@@ -0,0 +1,158 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startuptrace.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QVariant>
+
+#include <qjson/serializer.h>
+
+#include "utils/logger.h"
+
+namespace StartupTrace
+{
+
+struct Phase
+{
+    QString name;
+    quint64 thread;
+    qint64 begin;
+    qint64 end;
+};
+
+static QMutex s_mutex;
+static QElapsedTimer s_timer;
+static QList< Phase > s_phases;
+static QHash< QString, int > s_open;
+static bool s_finished = false;
+
+
+// in microseconds like the trace format wants them, but only at millisecond
+// resolution: nsecsElapsed() needs Qt 4.8
+static qint64
+now()
+{
+    if ( !s_timer.isValid() )
+        s_timer.start();
+
+    return s_timer.elapsed() * 1000;
+}
+
+
+void
+start()
+{
+    QMutexLocker lock( &s_mutex );
+    if ( !s_timer.isValid() )
+        s_timer.start();
+}
+
+
+void
+begin( const QString& phase )
+{
+    QMutexLocker lock( &s_mutex );
+    if ( s_finished || s_open.contains( phase ) )
+        return;
+
+    Phase p;
+    p.name = phase;
+    p.thread = (quint64)QThread::currentThreadId();
+    p.begin = now();
+    p.end = -1;
+
+    s_open.insert( phase, s_phases.count() );
+    s_phases << p;
+}
+
+
+void
+end( const QString& phase )
+{
+    QMutexLocker lock( &s_mutex );
+    if ( s_finished || !s_open.contains( phase ) )
+        return;
+
+    s_phases[ s_open.value( phase ) ].end = now();
+}
+
+
+bool
+isFinished()
+{
+    QMutexLocker lock( &s_mutex );
+    return s_finished;
+}
+
+
+void
+finish( const QString& filename )
+{
+    QMutexLocker lock( &s_mutex );
+    if ( s_finished )
+        return;
+    s_finished = true;
+
+    const qint64 total = now();
+
+    // thread ids are not small numbers, number them in order of appearance
+    QHash< quint64, int > threads;
+    QVariantList events;
+    foreach ( const Phase& p, s_phases )
+    {
+        if ( !threads.contains( p.thread ) )
+            threads.insert( p.thread, threads.count() );
+
+        // phases that never ended last until now
+        const qint64 end = p.end < 0 ? total : p.end;
+
+        QVariantMap e;
+        e["name"] = p.name;
+        e["ph"] = "X";
+        e["ts"] = p.begin;
+        e["dur"] = end - p.begin;
+        e["pid"] = QCoreApplication::applicationPid();
+        e["tid"] = threads.value( p.thread );
+        events << e;
+
+        tDebug( LOGVERBOSE ) << "Startup phase" << p.name << "took" << ( end - p.begin ) / 1000 << "ms, thread" << threads.value( p.thread );
+    }
+
+    QVariantMap trace;
+    trace["traceEvents"] = events;
+    trace["displayTimeUnit"] = "ms";
+
+    QJson::Serializer serializer;
+    QFile f( filename );
+    if ( !f.open( QIODevice::WriteOnly | QIODevice::Truncate ) || f.write( serializer.serialize( trace ) ) < 0 )
+    {
+        tLog() << "Could not write start-up trace:" << filename << f.errorString();
+        return;
+    }
+
+    tLog() << "Start-up took" << total / 1000 << "ms, trace written to" << filename;
+}
+
+}
@@ -0,0 +1,55 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOMAHAWK_STARTUPTRACE_H
+#define TOMAHAWK_STARTUPTRACE_H
+
+#include <QString>
+
+#include "dllmacro.h"
+
+/*
+    Timeline of the start-up phases, from any thread. finish() writes it in
+    the Chrome trace event format, which chrome://tracing and Perfetto load.
+    Phase names must be unique, a phase that is begun twice is ignored.
+*/
+namespace StartupTrace
+{
+    // the time everything is relative to, call first thing in main()
+    DLLEXPORT void start();
+
+    DLLEXPORT void begin( const QString& phase );
+    DLLEXPORT void end( const QString& phase );
+
+    // writes the phases recorded so far, only the first call does anything
+    DLLEXPORT void finish( const QString& filename );
+    DLLEXPORT bool isFinished();
+
+    // begins a phase and ends it when going out of scope
+    class DLLEXPORT Scope
+    {
+    public:
+        explicit Scope( const QString& phase ) : m_phase( phase ) { begin( m_phase ); }
+        ~Scope() { end( m_phase ); }
+
+    private:
+        QString m_phase;
+    };
+}
+
+#endif // TOMAHAWK_STARTUPTRACE_H
@@ -0,0 +1,504 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnailstore.h"
+
+#include <QRunnable>
+#include <QtEndian>
+
+#include "utils/tomahawkutils.h"
+#include "utils/logger.h"
+
+// file header, bump the trailing version when changing the record layout
+#define THUMBNAILSTORE_MAGIC "TOMAHAWKTHUMBS01"
+#define THUMBNAILSTORE_MAGIC_SIZE 16
+// reqW, reqH, imgW, imgH (quint16), checksum (quint32), keylen, reserved (quint16), datalen (quint32)
+#define THUMBNAILSTORE_RECORD_HEADER_SIZE 20
+// don't bother compacting files smaller than this
+#define THUMBNAILSTORE_COMPACT_THRESHOLD (4 * 1024 * 1024)
+// the file gets mapped in windows of two segments starting at a segment boundary,
+// so every record that isn't bigger than a segment fits into the one it starts in
+#define THUMBNAILSTORE_SEGMENT_SIZE (8 * 1024 * 1024)
+#define THUMBNAILSTORE_MAX_SEGMENTS (8)
+
+using namespace Tomahawk;
+
+ThumbnailStore* ThumbnailStore::s_instance = 0;
+
+
+namespace Tomahawk
+{
+
+class ThumbnailStoreWriter : public QRunnable
+{
+public:
+    ThumbnailStoreWriter( ThumbnailStore* store, const QString& key, const QSize& size, quint32 checksum, const QImage& image )
+        : m_store( store )
+        , m_key( key )
+        , m_size( size )
+        , m_checksum( checksum )
+        , m_image( image )
+    {}
+
+    virtual void run()
+    {
+        m_store->write( m_key, m_size, m_checksum, m_image );
+    }
+
+private:
+    ThumbnailStore* m_store;
+    QString m_key;
+    QSize m_size;
+    quint32 m_checksum;
+    QImage m_image;
+};
+
+}
+
+
+static inline int
+paddedKeyLength( int length )
+{
+    // keeps the pixel data of every record 32bit aligned
+    return ( length + 3 ) & ~3;
+}
+
+
+static QByteArray
+recordHeader( const QByteArray& utf8Key, const QSize& size, const QSize& imageSize, quint32 checksum, quint32 length )
+{
+    QByteArray record( THUMBNAILSTORE_RECORD_HEADER_SIZE + paddedKeyLength( utf8Key.length() ), '\0' );
+    uchar* h = (uchar*)record.data();
+    qToLittleEndian< quint16 >( size.width(), h );
+    qToLittleEndian< quint16 >( size.height(), h + 2 );
+    qToLittleEndian< quint16 >( imageSize.width(), h + 4 );
+    qToLittleEndian< quint16 >( imageSize.height(), h + 6 );
+    qToLittleEndian< quint32 >( checksum, h + 8 );
+    qToLittleEndian< quint16 >( utf8Key.length(), h + 12 );
+    qToLittleEndian< quint32 >( length, h + 16 );
+    memcpy( record.data() + THUMBNAILSTORE_RECORD_HEADER_SIZE, utf8Key.constData(), utf8Key.length() );
+
+    return record;
+}
+
+
+static bool
+validRecord( int keyLength, const QSize& size, const QSize& imageSize, quint32 length )
+{
+    if ( !keyLength )
+        return false;
+
+    // tombstones carry nothing but the key
+    if ( size.isEmpty() )
+        return length == 0;
+
+    // scaled into the requested size keeping the aspect ratio, exactly the pixels of that
+    return !imageSize.isEmpty() && imageSize.width() <= size.width() && imageSize.height() <= size.height() &&
+           (qint64)length == (qint64)imageSize.width() * imageSize.height() * 4 && length <= THUMBNAILSTORE_SEGMENT_SIZE;
+}
+
+
+ThumbnailStore*
+ThumbnailStore::instance()
+{
+    if ( !s_instance )
+        s_instance = new ThumbnailStore( TomahawkUtils::appDataDir().absoluteFilePath( "thumbnails.pack" ) );
+
+    return s_instance;
+}
+
+
+ThumbnailStore::ThumbnailStore( const QString& path )
+    : m_path( path )
+    , m_liveBytes( 0 )
+{
+    m_writer.setMaxThreadCount( 1 );
+
+    if ( !open() )
+    {
+        tLog() << "Could not open thumbnail store:" << m_path << m_file.errorString();
+        return;
+    }
+
+    scan();
+
+    if ( m_file.size() > THUMBNAILSTORE_COMPACT_THRESHOLD && m_file.size() > 2 * m_liveBytes )
+        compact();
+}
+
+
+ThumbnailStore::~ThumbnailStore()
+{
+    m_writer.waitForDone();
+    unmapSegments();
+}
+
+
+bool
+ThumbnailStore::open()
+{
+    m_file.setFileName( m_path );
+    if ( !m_file.open( QIODevice::ReadWrite ) )
+        return false;
+
+    QByteArray magic = m_file.read( THUMBNAILSTORE_MAGIC_SIZE );
+    if ( magic != QByteArray( THUMBNAILSTORE_MAGIC ) )
+    {
+        if ( m_file.size() )
+            tLog() << "Discarding thumbnail store with unknown format:" << m_path;
+
+        m_file.resize( 0 );
+        m_file.seek( 0 );
+        m_file.write( THUMBNAILSTORE_MAGIC, THUMBNAILSTORE_MAGIC_SIZE );
+        m_file.flush();
+    }
+
+    return true;
+}
+
+
+const uchar*
+ThumbnailStore::data( qint64 offset, qint64 length ) const
+{
+    if ( !m_file.isOpen() || offset < 0 || length > THUMBNAILSTORE_SEGMENT_SIZE || offset + length > m_file.size() )
+        return 0;
+
+    const qint64 segment = offset / THUMBNAILSTORE_SEGMENT_SIZE;
+    const qint64 start = segment * THUMBNAILSTORE_SEGMENT_SIZE;
+
+    QHash< qint64, Segment >::iterator it = m_segments.find( segment );
+    if ( it != m_segments.end() && start + it.value().size < offset + length )
+    {
+        // appending leaves the mappings alone, this one gets extended once a record past its end is read
+        m_file.unmap( it.value().map );
+        m_segments.erase( it );
+        m_segmentsUsed.removeOne( segment );
+        it = m_segments.end();
+    }
+
+    if ( it == m_segments.end() )
+    {
+        while ( m_segments.count() >= THUMBNAILSTORE_MAX_SEGMENTS )
+            m_file.unmap( m_segments.take( m_segmentsUsed.takeFirst() ).map );
+
+        Segment s;
+        s.size = qMin< qint64 >( 2 * THUMBNAILSTORE_SEGMENT_SIZE, m_file.size() - start );
+        s.map = m_file.map( start, s.size );
+        if ( !s.map )
+        {
+            tLog() << "Could not map thumbnail store:" << m_file.errorString();
+            return 0;
+        }
+
+        it = m_segments.insert( segment, s );
+    }
+    else
+    {
+        m_segmentsUsed.removeOne( segment );
+    }
+
+    m_segmentsUsed << segment;
+    return it.value().map + ( offset - start );
+}
+
+
+void
+ThumbnailStore::unmapSegments() const
+{
+    foreach ( const Segment& s, m_segments )
+        m_file.unmap( s.map );
+
+    m_segments.clear();
+    m_segmentsUsed.clear();
+}
+
+
+void
+ThumbnailStore::scan()
+{
+    m_index.clear();
+    m_liveBytes = THUMBNAILSTORE_MAGIC_SIZE;
+
+    if ( !m_file.isOpen() )
+        return;
+
+    const qint64 fileSize = m_file.size();
+    qint64 pos = THUMBNAILSTORE_MAGIC_SIZE;
+    while ( pos + THUMBNAILSTORE_RECORD_HEADER_SIZE <= fileSize )
+    {
+        const uchar* h = data( pos, THUMBNAILSTORE_RECORD_HEADER_SIZE );
+        if ( !h )
+            break;
+
+        const quint16 keyLength = qFromLittleEndian< quint16 >( h + 12 );
+        const quint32 length = qFromLittleEndian< quint32 >( h + 16 );
+        const qint64 dataPos = pos + THUMBNAILSTORE_RECORD_HEADER_SIZE + paddedKeyLength( keyLength );
+
+        Entry e;
+        e.size = QSize( qFromLittleEndian< quint16 >( h ), qFromLittleEndian< quint16 >( h + 2 ) );
+        e.imageSize = QSize( qFromLittleEndian< quint16 >( h + 4 ), qFromLittleEndian< quint16 >( h + 6 ) );
+        e.checksum = qFromLittleEndian< quint32 >( h + 8 );
+        e.offset = dataPos;
+        e.length = length;
+
+        // a record cut short by a crash, or garbage. drop it and everything after it,
+        // there is no telling where the next record would start
+        if ( dataPos + length > fileSize || !validRecord( keyLength, e.size, e.imageSize, length ) )
+            break;
+
+        const uchar* k = data( pos + THUMBNAILSTORE_RECORD_HEADER_SIZE, keyLength );
+        if ( !k )
+            break;
+
+        const QString key = QString::fromUtf8( (const char*)k, keyLength );
+
+        QList< Entry >& entries = m_index[ key ];
+        for ( int i = entries.count() - 1; i >= 0; i-- )
+        {
+            // a tombstone drops all sizes, otherwise only the one it replaces
+            if ( e.size.isEmpty() || entries.at( i ).size == e.size )
+            {
+                m_liveBytes -= THUMBNAILSTORE_RECORD_HEADER_SIZE + paddedKeyLength( keyLength ) + entries.at( i ).length;
+                entries.removeAt( i );
+            }
+        }
+
+        if ( !e.size.isEmpty() )
+        {
+            entries << e;
+            m_liveBytes += dataPos - pos + length;
+        }
+        else if ( entries.isEmpty() )
+        {
+            m_index.remove( key );
+        }
+
+        pos = dataPos + length;
+    }
+
+    if ( pos < fileSize )
+    {
+        tLog() << "Truncating damaged thumbnail store at" << pos;
+        unmapSegments();
+        m_file.resize( pos );
+    }
+}
+
+
+void
+ThumbnailStore::compact()
+{
+    tDebug() << Q_FUNC_INFO << m_file.size() << m_liveBytes;
+
+    // copied record by record, the live thumbnails don't have to fit into memory at once
+    QFile compacted( m_path + ".compact" );
+    if ( !compacted.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+    {
+        tLog() << "Could not compact thumbnail store:" << compacted.errorString();
+        return;
+    }
+
+    bool ok = compacted.write( THUMBNAILSTORE_MAGIC, THUMBNAILSTORE_MAGIC_SIZE ) == THUMBNAILSTORE_MAGIC_SIZE;
+    QHash< QString, QList< Entry > >::const_iterator it = m_index.constBegin();
+    for ( ; ok && it != m_index.constEnd(); ++it )
+    {
+        const QByteArray utf8 = it.key().toUtf8();
+        foreach ( const Entry& e, it.value() )
+        {
+            const uchar* pixels = data( e.offset, e.length );
+            const QByteArray record = recordHeader( utf8, e.size, e.imageSize, e.checksum, e.length );
+            if ( !pixels || compacted.write( record ) != record.length() ||
+                 compacted.write( (const char*)pixels, e.length ) != (qint64)e.length )
+            {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    compacted.close();
+    if ( !ok )
+    {
+        tLog() << "Could not compact thumbnail store:" << compacted.errorString();
+        compacted.remove();
+        return;
+    }
+
+    unmapSegments();
+    m_file.close();
+    if ( !QFile::remove( m_path ) || !compacted.rename( m_path ) )
+        tLog() << "Could not replace thumbnail store with the compacted one:" << compacted.errorString();
+
+    if ( !open() )
+    {
+        tLog() << "Could not open thumbnail store:" << m_path << m_file.errorString();
+        m_index.clear();
+        return;
+    }
+
+    scan();
+}
+
+
+void
+ThumbnailStore::write( const QString& key, const QSize& size, quint32 checksum, const QImage& image )
+{
+    QByteArray pixels;
+    QSize imageSize;
+    if ( !image.isNull() )
+    {
+        const QImage converted = image.convertToFormat( QImage::Format_ARGB32_Premultiplied );
+        imageSize = converted.size();
+
+        pixels.reserve( converted.width() * converted.height() * 4 );
+        for ( int y = 0; y < converted.height(); y++ )
+            pixels.append( (const char*)converted.constScanLine( y ), converted.width() * 4 );
+    }
+
+    QMutexLocker locker( &m_mutex );
+    if ( image.isNull() && !m_index.contains( key ) )
+        return;
+
+    append( key, image.isNull() ? QSize() : size, imageSize, checksum, pixels );
+    m_file.flush();
+}
+
+
+void
+ThumbnailStore::append( const QString& key, const QSize& size, const QSize& imageSize, quint32 checksum, const QByteArray& pixels )
+{
+    if ( !m_file.isOpen() )
+        return;
+
+    const QByteArray record = recordHeader( key.toUtf8(), size, imageSize, checksum, pixels.length() );
+
+    m_file.seek( m_file.size() );
+    const qint64 pos = m_file.pos();
+    if ( m_file.write( record ) != record.length() || m_file.write( pixels ) != pixels.length() )
+    {
+        tLog() << "Could not write to thumbnail store:" << m_file.errorString();
+        m_file.resize( pos );
+        return;
+    }
+
+    QList< Entry >& entries = m_index[ key ];
+    for ( int i = entries.count() - 1; i >= 0; i-- )
+    {
+        if ( size.isEmpty() || entries.at( i ).size == size )
+        {
+            m_liveBytes -= record.length() + entries.at( i ).length;
+            entries.removeAt( i );
+        }
+    }
+
+    if ( size.isEmpty() )
+    {
+        m_index.remove( key );
+        return;
+    }
+
+    Entry e;
+    e.size = size;
+    e.imageSize = imageSize;
+    e.checksum = checksum;
+    e.offset = pos + record.length();
+    e.length = pixels.length();
+    entries << e;
+
+    m_liveBytes += record.length() + pixels.length();
+}
+
+
+QImage
+ThumbnailStore::image( const QString& key, const QSize& size ) const
+{
+    QMutexLocker locker( &m_mutex );
+
+    QHash< QString, QList< Entry > >::const_iterator it = m_index.constFind( key );
+    if ( it == m_index.constEnd() )
+        return QImage();
+
+    foreach ( const Entry& e, it.value() )
+    {
+        if ( e.size != size )
+            continue;
+
+        const uchar* pixels = data( e.offset, e.length );
+        if ( !pixels )
+            return QImage();
+
+        // the segment gets unmapped once others are used, so hand out a copy
+        const QImage mapped( pixels, e.imageSize.width(), e.imageSize.height(),
+                             e.imageSize.width() * 4, QImage::Format_ARGB32_Premultiplied );
+        return mapped.copy();
+    }
+
+    return QImage();
+}
+
+
+bool
+ThumbnailStore::contains( const QString& key ) const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_index.contains( key );
+}
+
+
+quint32
+ThumbnailStore::checksum( const QString& key ) const
+{
+    QMutexLocker locker( &m_mutex );
+
+    QHash< QString, QList< Entry > >::const_iterator it = m_index.constFind( key );
+    if ( it == m_index.constEnd() || it.value().isEmpty() )
+        return 0;
+
+    return it.value().first().checksum;
+}
+
+
+void
+ThumbnailStore::store( const QString& key, const QSize& size, quint32 checksum, const QImage& image )
+{
+    if ( image.isNull() || !m_sizes.contains( size ) )
+        return;
+
+    // converting and writing it doesn't hold up painting
+    m_writer.start( new ThumbnailStoreWriter( this, key, size, checksum, image ) );
+}
+
+
+void
+ThumbnailStore::addSize( const QSize& size )
+{
+    // a record has to fit into a segment
+    if ( size.isEmpty() || size.width() > 0xffff || size.height() > 0xffff || m_sizes.contains( size ) ||
+         (qint64)size.width() * size.height() * 4 > THUMBNAILSTORE_SEGMENT_SIZE )
+        return;
+
+    m_sizes << size;
+}
+
+
+void
+ThumbnailStore::remove( const QString& key )
+{
+    // queued behind the thumbnails stored before, so it drops them too
+    m_writer.start( new ThumbnailStoreWriter( this, key, QSize(), 0, QImage() ) );
+}
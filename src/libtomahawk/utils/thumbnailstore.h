@@ -0,0 +1,128 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THUMBNAILSTORE_H
+#define THUMBNAILSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+#include "dllmacro.h"
+
+namespace Tomahawk
+{
+
+class ThumbnailStoreWriter;
+
+/*
+    Persistent store for scaled cover art, so a cold start can paint the
+    album grid without decoding a single image.
+
+    All thumbnails live in one append-only pack file. Pixels are kept as
+    ARGB32_Premultiplied scanlines, so reading a thumbnail is a plain copy.
+    The file is memory mapped in segments, only the few that were used last
+    stay mapped, so a large pack doesn't need that much address space.
+    Every record carries the key (e.g. "album/42"), the size it was
+    requested for, and a checksum of the source image, which tells whether
+    a thumbnail is stale. Removals are appended as tombstones, and the file
+    gets compacted on open once most of it is garbage.
+
+    Only the sizes the item delegates register with addSize() get stored,
+    so the pack doesn't grow with every size some view happens to ask for.
+
+    Must only be used from the GUI thread. Writing happens on a thread of
+    its own, so a thumbnail may only be found shortly after storing it.
+*/
+class DLLEXPORT ThumbnailStore
+{
+friend class ThumbnailStoreWriter;
+
+public:
+    static ThumbnailStore* instance();
+
+    ~ThumbnailStore();
+
+    // null if there is no thumbnail for key at exactly this requested size
+    QImage image( const QString& key, const QSize& size ) const;
+
+    bool contains( const QString& key ) const;
+    // checksum of the source image the thumbnails for key were made from
+    quint32 checksum( const QString& key ) const;
+
+    // does nothing unless size got registered with addSize()
+    void store( const QString& key, const QSize& size, quint32 checksum, const QImage& image );
+    void remove( const QString& key );
+
+    // a size some delegate paints covers at
+    void addSize( const QSize& size );
+
+private:
+    explicit ThumbnailStore( const QString& path );
+
+    struct Entry
+    {
+        QSize size;
+        QSize imageSize;
+        quint32 checksum;
+        qint64 offset;
+        quint32 length;
+    };
+
+    struct Segment
+    {
+        uchar* map;
+        qint64 size;
+    };
+
+    bool open();
+    void scan();
+    void compact();
+    // length bytes of the file at offset, from the segment they are in. null if they are not in the file
+    const uchar* data( qint64 offset, qint64 length ) const;
+    void unmapSegments() const;
+    // called on the writer thread, a null image appends a tombstone
+    void write( const QString& key, const QSize& size, quint32 checksum, const QImage& image );
+    void append( const QString& key, const QSize& size, const QSize& imageSize, quint32 checksum, const QByteArray& pixels );
+
+    QString m_path;
+    mutable QFile m_file;
+    mutable QHash< qint64, Segment > m_segments;
+    // least recently used first
+    mutable QList< qint64 > m_segmentsUsed;
+    // guards the file and the index, the writer thread appends to both
+    mutable QMutex m_mutex;
+
+    QHash< QString, QList< Entry > > m_index;
+    QList< QSize > m_sizes;
+    qint64 m_liveBytes;
+
+    // a single thread, so records get appended in the order they were stored
+    QThreadPool m_writer;
+
+    static ThumbnailStore* s_instance;
+};
+
+}
+
+#endif // THUMBNAILSTORE_H
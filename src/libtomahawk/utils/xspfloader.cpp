@@ -22,8 +22,6 @@
 
 #include "headlesscheck.h"
 
-#include <QDomDocument>
-
 #include "utils/tomahawkutils.h"
 #include "utils/logger.h"
 
@@ -38,6 +36,9 @@
 #include <XspfUpdater.h>
 #include <pipeline.h>
 
+// how many parsed tracks get handed to the pipeline at once
+#define XSPFLOADER_RESOLVE_BATCH 100
+
 using namespace Tomahawk;
 
 QString
@@ -63,6 +64,11 @@ XSPFLoader::XSPFLoader( bool autoCreate, bool autoUpdate, QObject *parent )
     , m_autoResolve( true )
     , m_autoDelete( true )
     , m_NS("http://xspf.org/ns/0/")
+    , m_depth( 0 )
+    , m_inTrackList( false )
+    , m_inTrack( false )
+    , m_fieldDepth( 0 )
+    , m_shownError( false )
 {
     qRegisterMetaType< XSPFErrorCode >("XSPFErrorCode");
 }
@@ -95,6 +101,9 @@ XSPFLoader::load( const QUrl& url )
     Q_ASSERT( TomahawkUtils::nam() != 0 );
     QNetworkReply* reply = TomahawkUtils::nam()->get( request );
 
+    connect( reply, SIGNAL( readyRead() ),
+                      SLOT( networkReadyRead() ) );
+
     connect( reply, SIGNAL( finished() ),
                       SLOT( networkLoadFinished() ) );
 
@@ -108,7 +117,12 @@ XSPFLoader::load( QFile& file )
 {
     if ( file.open( QFile::ReadOnly ) )
     {
-        m_body = file.readAll();
+        while ( !file.atEnd() )
+        {
+            m_reader.addData( file.read( 64 * 1024 ) );
+            parse();
+        }
+
         gotBody();
     }
     else
@@ -129,6 +143,18 @@ XSPFLoader::reportError()
 }
 
 
+void
+XSPFLoader::networkReadyRead()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    if ( reply->error() != QNetworkReply::NoError )
+        return;
+
+    m_reader.addData( reply->readAll() );
+    parse();
+}
+
+
 void
 XSPFLoader::networkLoadFinished()
 {
@@ -136,7 +162,8 @@ XSPFLoader::networkLoadFinished()
     if ( reply->error() != QNetworkReply::NoError )
         return;
 
-    m_body = reply->readAll();
+    m_reader.addData( reply->readAll() );
+    parse();
     gotBody();
 }
 
@@ -149,101 +176,130 @@ XSPFLoader::networkError( QNetworkReply::NetworkError /* error */ )
 
 
 void
-XSPFLoader::gotBody()
+XSPFLoader::parse()
 {
-    QDomDocument xmldoc;
-    bool namespaceProcessing = true;
-    xmldoc.setContent( m_body, namespaceProcessing );
-    QDomElement docElement( xmldoc.documentElement() );
-
-    QString origTitle;
-    QDomNodeList tracklist;
-    QDomElement n = docElement.firstChildElement();
-    for ( ; !n.isNull(); n = n.nextSiblingElement() )
-    {
-        if ( n.namespaceURI() == m_NS && n.localName() == "title" )
-        {
-            origTitle = n.text();
-        }
-        else if ( n.namespaceURI() == m_NS && n.localName() == "creator" )
-        {
-            m_creator = n.text();
-        }
-        else if ( n.namespaceURI() == m_NS && n.localName() == "info" )
-        {
-            m_info = n.text();
-        }
-        else if ( n.namespaceURI() == m_NS && n.localName() == "trackList" )
-        {
-            tracklist = n.childNodes();
-        }
-    }
-
-    m_title = origTitle;
-    if ( m_title.isEmpty() )
-        m_title = tr( "New Playlist" );
-    if ( !m_overrideTitle.isEmpty() )
-        m_title = m_overrideTitle;
-
-    bool shownError = false;
-    for ( unsigned int i = 0; i < tracklist.length(); i++ )
+    while ( !m_reader.atEnd() )
     {
-        QDomNode e = tracklist.at( i );
+        // runs out of data in the middle of the document while we are still downloading
+        if ( m_reader.readNext() == QXmlStreamReader::Invalid )
+            break;
 
-        QString artist, album, track, duration, annotation, url;
-        QDomElement n = e.firstChildElement();
-        for ( ; !n.isNull(); n = n.nextSiblingElement() )
+        if ( m_reader.isStartElement() )
         {
-            if ( n.namespaceURI() == m_NS && n.localName() == "duration" )
+            m_depth++;
+            if ( m_reader.namespaceUri() != m_NS )
+                continue;
+
+            const QString name = m_reader.name().toString();
+            if ( m_depth == 2 && name == "trackList" )
             {
-                duration = n.text();
+                m_inTrackList = true;
             }
-            else if ( n.namespaceURI() == m_NS && n.localName() == "annotation" )
+            else if ( m_depth == 3 && m_inTrackList && name == "track" )
             {
-                annotation = n.text();
+                m_inTrack = true;
+                m_track.clear();
             }
-            else if ( n.namespaceURI() == m_NS && n.localName() == "creator" )
+            else if ( m_depth == 2 || ( m_depth == 4 && m_inTrack ) )
             {
-                artist = n.text();
+                m_field = name;
+                m_fieldDepth = m_depth;
+                m_text.clear();
             }
-            else if ( n.namespaceURI() == m_NS && n.localName() == "album" )
+        }
+        else if ( m_reader.isCharacters() )
+        {
+            if ( !m_field.isEmpty() && m_depth == m_fieldDepth )
+                m_text += m_reader.text();
+        }
+        else if ( m_reader.isEndElement() )
+        {
+            if ( !m_field.isEmpty() && m_depth == m_fieldDepth )
             {
-                album = n.text();
+                if ( m_depth == 4 )
+                    m_track[ m_field ] = m_text;
+                else if ( m_field == "title" )
+                    m_origTitle = m_text;
+                else if ( m_field == "creator" )
+                    m_creator = m_text;
+                else if ( m_field == "info" )
+                    m_info = m_text;
+
+                m_field.clear();
             }
-            else if ( n.namespaceURI() == m_NS && n.localName() == "title" )
+            else if ( m_depth == 3 && m_inTrack )
             {
-                track = n.text();
+                m_inTrack = false;
+                addTrack();
             }
-            else if ( n.namespaceURI() == m_NS && n.localName() == "url" )
+            else if ( m_depth == 2 && m_inTrackList )
             {
-                url = n.text();
+                m_inTrackList = false;
             }
-        }
 
-        if ( artist.isEmpty() || track.isEmpty() )
-        {
-            if ( !shownError )
-            {
-                emit error( InvalidTrackError );
-                shownError = true;
-            }
-            continue;
+            m_depth--;
         }
+    }
 
-        query_ptr q = Tomahawk::Query::get( artist, track, album, uuid(), false );
-        q->setDuration( duration.toInt() / 1000 );
-        if ( !url.isEmpty() )
-            q->setResultHint( url );
+    if ( m_unresolved.count() >= XSPFLOADER_RESOLVE_BATCH )
+        resolvePending();
+}
 
-        m_entries << q;
-    }
 
-    if ( m_autoResolve )
+void
+XSPFLoader::addTrack()
+{
+    const QString artist = m_track.value( "creator" );
+    const QString track = m_track.value( "title" );
+
+    if ( artist.isEmpty() || track.isEmpty() )
     {
-        for ( int i = m_entries.size() - 1; i >= 0; i-- )
-            Pipeline::instance()->resolve( m_entries[ i ] );
+        if ( !m_shownError )
+        {
+            emit error( InvalidTrackError );
+            m_shownError = true;
+        }
+        return;
     }
 
+    query_ptr q = Tomahawk::Query::get( artist, track, m_track.value( "album" ), uuid(), false );
+    q->setDuration( m_track.value( "duration" ).toInt() / 1000 );
+    if ( !m_track.value( "url" ).isEmpty() )
+        q->setResultHint( m_track.value( "url" ) );
+
+    m_entries << q;
+    if ( m_autoResolve )
+        m_unresolved << q;
+}
+
+
+void
+XSPFLoader::resolvePending()
+{
+    if ( m_unresolved.isEmpty() )
+        return;
+
+    // only the first batch jumps the queue, so the playlist still resolves top to bottom
+    Pipeline::instance()->resolve( m_unresolved, m_entries.count() == m_unresolved.count() );
+    m_unresolved.clear();
+}
+
+
+void
+XSPFLoader::gotBody()
+{
+    if ( m_reader.hasError() )
+        tLog() << "Error parsing XSPF:" << m_reader.errorString() << "on line" << m_reader.lineNumber();
+
+    resolvePending();
+
+    const QString origTitle = m_origTitle;
+    m_title = origTitle;
+    if ( m_title.isEmpty() )
+        m_title = tr( "New Playlist" );
+    if ( !m_overrideTitle.isEmpty() )
+        m_title = m_overrideTitle;
+
     if ( origTitle.isEmpty() && m_entries.isEmpty() )
     {
         emit error( ParseError );
@@ -18,7 +18,9 @@
  */
 
 /*
-    Fetches and parses an XSPF document from a QFile or QUrl.
+    Fetches and parses an XSPF document from a QFile or QUrl. Parsing
+    happens incrementally while the document is still downloading, and
+    tracks are handed to the pipeline in batches as soon as they are read.
  */
 
 #ifndef XSPFLOADER_H
@@ -29,6 +31,7 @@
 #include <QFile>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QXmlStreamReader>
 
 #include "playlist.h"
 #include "typedefs.h"
@@ -63,11 +66,15 @@ public slots:
     void load( QFile& file );
 
 private slots:
+    void networkReadyRead();
     void networkLoadFinished();
     void networkError( QNetworkReply::NetworkError e );
 
 private:
     void reportError();
+    void parse();
+    void addTrack();
+    void resolvePending();
     void gotBody();
 
     bool m_autoCreate, m_autoUpdate, m_autoResolve, m_autoDelete;
@@ -76,8 +83,21 @@ private:
     QString m_title, m_info, m_creator;
 
     QUrl m_url;
-    QByteArray m_body;
     Tomahawk::playlist_ptr m_playlist;
+
+    QXmlStreamReader m_reader;
+    int m_depth;
+    bool m_inTrackList;
+    bool m_inTrack;
+    // element whose text we are collecting, and its depth
+    QString m_field;
+    int m_fieldDepth;
+    QString m_text;
+    QString m_origTitle;
+    QHash< QString, QString > m_track;
+    bool m_shownError;
+    // parsed but not yet handed to the pipeline
+    QList< Tomahawk::query_ptr > m_unresolved;
 };
 
 #endif // XSPFLOADER_H
@@ -101,12 +101,6 @@ WhatsHotWidget::WhatsHotWidget( QWidget* parent )
 
     m_workerThread = new QThread( this );
     m_workerThread->start();
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-             SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-             SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(), SIGNAL( finished( QString ) ), SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -165,7 +159,7 @@ WhatsHotWidget::fetchData()
     requestData.type = Tomahawk::InfoSystem::InfoChartCapabilities;
     requestData.timeoutMillis = 20000;
     requestData.allSources = true;
-    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
 
     tDebug( LOGVERBOSE ) << "WhatsHot: requested InfoChartCapabilities";
 }
@@ -377,7 +371,7 @@ WhatsHotWidget::leftCrumbIndexChanged( QModelIndex index )
     requestData.allSources = true;
 
     qDebug() << "Making infosystem request for chart of type:" <<chartId;
-    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData );
+    Tomahawk::InfoSystem::InfoSystem::instance()->getInfo( requestData, this );
 
     m_queuedFetches.insert( chartId );
     m_queueItemToShow = chartId;
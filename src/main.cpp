@@ -22,6 +22,7 @@
 #include "thirdparty/kdsingleapplicationguard/kdsingleapplicationguard.h"
 #include "ubuntuunityhack.h"
 #include "tomahawksettings.h"
+#include "utils/startuptrace.h"
 
 #include <QTranslator>
 
@@ -111,6 +112,7 @@ main( int argc, char *argv[] )
     #endif // Q_WS_MAC
 #endif //Q_OS_WIN
 
+    StartupTrace::start();
     TomahawkApp a( argc, argv );
 
     // MUST register StateHash ****before*** initing TomahawkSettingsGui as constructor of settings does upgrade before Gui subclass registers type
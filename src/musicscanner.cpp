@@ -248,7 +248,13 @@ MusicScanner::commitBatch( const QVariantList& tracks, const QVariantList& delet
     if ( tracks.length() )
     {
         tDebug( LOGINFO ) << Q_FUNC_INFO << "adding" << tracks.length() << "tracks";
-        executeCommand( QSharedPointer<DatabaseCommand>( new DatabaseCommand_AddFiles( tracks, SourceList::instance()->getLocal() ) ) );
+
+        // one transaction per chunk, so the database writer can serve the user in between
+        for ( int i = 0; i < tracks.length(); i += MUSICSCANNER_COMMIT_CHUNK )
+        {
+            executeCommand( QSharedPointer<DatabaseCommand>( new DatabaseCommand_AddFiles( tracks.mid( i, MUSICSCANNER_COMMIT_CHUNK ),
+                                                                                            SourceList::instance()->getLocal() ) ) );
+        }
     }
 }
 
@@ -38,6 +38,9 @@
 #include <QtCore/QWeakPointer>
 #include <database/database.h>
 
+// files per DatabaseCommand_AddFiles, each gets its own transaction
+#define MUSICSCANNER_COMMIT_CHUNK 500
+
 // descend dir tree comparing dir mtimes to last known mtime
 // emit signal for any dir with new content, so we can scan it.
 // finally, emit the list of new mtimes we observed.
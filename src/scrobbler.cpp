@@ -42,10 +42,6 @@ Scrobbler::Scrobbler( QObject* parent )
     connect( AudioEngine::instance(), SIGNAL( timerSeconds( unsigned int ) ),
                                         SLOT( engineTick( unsigned int ) ), Qt::QueuedConnection );
 
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(),
-        SIGNAL( info( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ),
-        SLOT( infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData, QVariant ) ) );
-
     connect( AudioEngine::instance(), SIGNAL( started( const Tomahawk::result_ptr& ) ),
              SLOT( trackStarted( const Tomahawk::result_ptr& ) ), Qt::QueuedConnection );
 
@@ -57,8 +53,6 @@ Scrobbler::Scrobbler( QObject* parent )
 
     connect( AudioEngine::instance(), SIGNAL( stopped() ),
              SLOT( trackStopped() ), Qt::QueuedConnection );
-
-    connect( Tomahawk::InfoSystem::InfoSystem::instance(), SIGNAL( finished( QString ) ), SLOT( infoSystemFinished( QString ) ) );
 }
 
 
@@ -142,23 +136,3 @@ Scrobbler::scrobble()
         s_scInfoIdentifier, Tomahawk::InfoSystem::InfoSubmitScrobble,
         QVariant() );
 }
-
-
-void
-Scrobbler::infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output )
-{
-    Q_UNUSED( output );
-    if ( requestData.caller == s_scInfoIdentifier )
-        qDebug() << Q_FUNC_INFO;
-}
-
-
-void
-Scrobbler::infoSystemFinished( QString target )
-{
-    if ( target == s_scInfoIdentifier )
-    {
-        qDebug() << Q_FUNC_INFO;
-        qDebug() << "Scrobbler received done signal from InfoSystem";
-    }
-}
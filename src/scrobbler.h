@@ -44,9 +44,6 @@ public slots:
     void trackStopped();
     void engineTick( unsigned int secondsElapsed );
 
-    void infoSystemInfo( Tomahawk::InfoSystem::InfoRequestData requestData, QVariant output );
-    void infoSystemFinished( QString target );
-
 private:
     void scrobble();
 
@@ -112,7 +112,8 @@ PlaylistItem::flags() const
     Qt::ItemFlags flags = SourceTreeItem::flags();
     flags |= Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled;
 
-    if ( !m_loaded )
+    // remote playlists only get loaded when they are opened
+    if ( !m_loaded && playlist()->author()->isLocal() )
         flags &= !Qt::ItemIsEnabled;
     if ( playlist()->author()->isLocal() )
         flags |= Qt::ItemIsEditable;
@@ -131,6 +132,9 @@ PlaylistItem::flags() const
 void
 PlaylistItem::activate()
 {
+    if ( !m_loaded && !m_playlist->busy() )
+        m_playlist->loadRevision();
+
     ViewPage* p = ViewManager::instance()->show( m_playlist );
     model()->linkSourceItemToPage( this, p );
 }
@@ -293,6 +297,9 @@ DynamicPlaylistItem::~DynamicPlaylistItem()
 void
 DynamicPlaylistItem::activate()
 {
+    if ( !loaded() && !m_dynplaylist->busy() )
+        m_dynplaylist->loadRevision();
+
     ViewPage* p = ViewManager::instance()->show( m_dynplaylist );
     model()->linkSourceItemToPage( this, p );
 }
@@ -45,6 +45,7 @@ public:
 
 protected:
     void setLoaded( bool loaded );
+    bool loaded() const { return m_loaded; }
 
 private slots:
     void onPlaylistLoaded( Tomahawk::PlaylistRevision revision );
@@ -45,6 +45,7 @@ SourceItem::SourceItem( SourcesModel* mdl, SourceTreeItem* parent, const Tomahaw
     , m_source( source )
     , m_playlists( 0 )
     , m_stations( 0 )
+    , m_playlistsLoaded( false )
     , m_latchedOn( false )
     , m_sourceInfoItem( 0 )
     , m_coolPlaylistsItem( 0 )
@@ -88,21 +89,18 @@ SourceItem::SourceItem( SourcesModel* mdl, SourceTreeItem* parent, const Tomahaw
     m_recentPlaysItem->setSortValue( -200 );
     m_lovedTracksItem->setSortValue( -150 );
 
-    // create category items if there are playlists to show, or stations to show
-    QList< playlist_ptr > playlists = source->collection()->playlists();
-    QList< dynplaylist_ptr > autoplaylists = source->collection()->autoPlaylists();
-    QList< dynplaylist_ptr > stations = source->collection()->stations();
-
-    if ( !playlists.isEmpty() || !autoplaylists.isEmpty() || source->isLocal() )
-    {
-        m_playlists = new CategoryItem( model(), this, SourcesModel::PlaylistsCategory, source->isLocal() );
-        onPlaylistsAdded( playlists );
-        onAutoPlaylistsAdded( autoplaylists );
-    }
-    if ( !stations.isEmpty() || source->isLocal() )
+    // remote sources load their playlists once expanded, see expanded().
+    // with lots of peers, loading all of them right away floods the database and the tree
+    if ( source->isLocal() )
     {
-        m_stations = new CategoryItem( model(), this, SourcesModel::StationsCategory, source->isLocal() );
-        onStationsAdded( stations );
+        m_playlistsLoaded = true;
+
+        m_playlists = new CategoryItem( model(), this, SourcesModel::PlaylistsCategory, true );
+        onPlaylistsAdded( source->collection()->playlists() );
+        onAutoPlaylistsAdded( source->collection()->autoPlaylists() );
+
+        m_stations = new CategoryItem( model(), this, SourcesModel::StationsCategory, true );
+        onStationsAdded( source->collection()->stations() );
     }
 
     if ( ViewManager::instance()->pageForCollection( source->collection() ) )
@@ -133,6 +131,21 @@ SourceItem::SourceItem( SourcesModel* mdl, SourceTreeItem* parent, const Tomahaw
 }
 
 
+void
+SourceItem::expanded()
+{
+    if ( m_source.isNull() || m_playlistsLoaded )
+        return;
+
+    // this starts loading them, they arrive through onPlaylistsAdded() & co.
+    // the categories get added along with their first playlists.
+    m_playlistsLoaded = true;
+    onPlaylistsAdded( m_source->collection()->playlists() );
+    onAutoPlaylistsAdded( m_source->collection()->autoPlaylists() );
+    onStationsAdded( m_source->collection()->stations() );
+}
+
+
 Tomahawk::source_ptr
 SourceItem::source() const
 {
@@ -268,7 +281,9 @@ SourceItem::playlistsAddedInternal( SourceTreeItem* parent, const QList< dynplay
     {
         DynamicPlaylistItem* plItem = new DynamicPlaylistItem( model(), parent, p, parent->children().count() - addOffset );
 //        qDebug() << "Dynamic Playlist added:" << p->title() << p->creator() << p->info();
-        p->loadRevision();
+        // remote ones are loaded when opened
+        if ( m_source->isLocal() )
+            p->loadRevision();
         items << plItem;
 
         if ( p->mode() == Static )
@@ -337,7 +352,8 @@ SourceItem::playlistDeletedInternal( SourceTreeItem* parent, const T& p )
 void
 SourceItem::onPlaylistsAdded( const QList< playlist_ptr >& playlists )
 {
-    if ( playlists.isEmpty() )
+    // not expanded yet, we get them all from the collection then
+    if ( playlists.isEmpty() || !m_playlistsLoaded )
         return;
 
     if ( !m_playlists )
@@ -347,6 +363,8 @@ SourceItem::onPlaylistsAdded( const QList< playlist_ptr >& playlists )
         beginRowsAdded( cur, cur );
         m_playlists = new CategoryItem( model(), this, SourcesModel::PlaylistsCategory, source()->isLocal() );
         endRowsAdded();
+
+        emit expandRequest( m_playlists );
     }
 
     QList< SourceTreeItem* > items;
@@ -357,7 +375,9 @@ SourceItem::onPlaylistsAdded( const QList< playlist_ptr >& playlists )
     foreach ( const playlist_ptr& p, playlists )
     {
         PlaylistItem* plItem = new PlaylistItem( model(), m_playlists, p, m_playlists->children().count() - addOffset );
-        p->loadRevision();
+        // remote ones are loaded when opened
+        if ( m_source->isLocal() )
+            p->loadRevision();
         items << plItem;
 
         if ( m_source->isLocal() )
@@ -382,7 +402,7 @@ SourceItem::onPlaylistDeleted( const playlist_ptr& playlist )
 void
 SourceItem::onAutoPlaylistsAdded( const QList< dynplaylist_ptr >& playlists )
 {
-    if ( playlists.isEmpty() )
+    if ( playlists.isEmpty() || !m_playlistsLoaded )
         return;
 
     if ( !m_playlists )
@@ -392,6 +412,8 @@ SourceItem::onAutoPlaylistsAdded( const QList< dynplaylist_ptr >& playlists )
         beginRowsAdded( cur, cur );
         m_playlists = new CategoryItem( model(), this, SourcesModel::PlaylistsCategory, source()->isLocal() );
         endRowsAdded();
+
+        emit expandRequest( m_playlists );
     }
 
     playlistsAddedInternal( m_playlists, playlists );
@@ -411,7 +433,7 @@ SourceItem::onAutoPlaylistDeleted( const dynplaylist_ptr& playlist )
 void
 SourceItem::onStationsAdded( const QList< dynplaylist_ptr >& stations )
 {
-    if ( stations.isEmpty() )
+    if ( stations.isEmpty() || !m_playlistsLoaded )
         return;
 
     if ( !m_stations )
@@ -421,6 +443,8 @@ SourceItem::onStationsAdded( const QList< dynplaylist_ptr >& stations )
         beginRowsAdded( cur, cur );
         m_stations = new CategoryItem( model(), this, SourcesModel::StationsCategory, source()->isLocal() );
         endRowsAdded();
+
+        emit expandRequest( m_stations );
     }
 
     playlistsAddedInternal( m_stations, stations );
@@ -42,6 +42,8 @@ public:
     virtual int peerSortValue() const;
     virtual int IDValue() const;
 
+    virtual void expanded();
+
     virtual bool localLatchedOn() const;
     virtual Tomahawk::PlaylistInterface::LatchMode localLatchMode() const;
 
@@ -96,6 +98,8 @@ private:
     QPixmap m_superCol, m_defaultAvatar;
     CategoryItem* m_playlists;
     CategoryItem* m_stations;
+    // remote sources only load their playlists once they get expanded
+    bool m_playlistsLoaded;
 
     bool m_latchedOn;
     Tomahawk::source_ptr m_latchedOnTo;
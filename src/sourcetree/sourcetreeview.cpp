@@ -234,6 +234,8 @@ SourceTreeView::onItemActivated( const QModelIndex& index )
 void
 SourceTreeView::onItemExpanded( const QModelIndex& idx )
 {
+    itemFromIndex< SourceTreeItem >( idx )->expanded();
+
     // make sure to expand children nodes for collections
     if( idx.data( SourcesModel::SourceTreeItemTypeRole ) == SourcesModel::Collection )
     {
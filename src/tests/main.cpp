@@ -0,0 +1,66 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <QtCore>
+#include <QtTest>
+
+#include "utils/tomahawkutils.h"
+
+#include "testplaylistrevision.h"
+
+
+static bool
+removeDir( const QDir& dir )
+{
+    foreach ( const QFileInfo& info, dir.entryInfoList( QDir::NoDotAndDotDot | QDir::AllEntries | QDir::Hidden ) )
+    {
+        if ( info.isDir() )
+        {
+            if ( !removeDir( QDir( info.absoluteFilePath() ) ) )
+                return false;
+        }
+        else if ( !QFile::remove( info.absoluteFilePath() ) )
+            return false;
+    }
+
+    return dir.rmdir( dir.absolutePath() );
+}
+
+
+int
+main( int argc, char** argv )
+{
+    QCoreApplication app( argc, argv );
+
+    // appDataDir() is named after the organization, so the tests get a data dir of their own
+    app.setOrganizationName( QString( "Tomahawk-Test-%1" ).arg( app.applicationPid() ) );
+    app.setApplicationName( "Tomahawk" );
+    const QDir dataDir = TomahawkUtils::appDataDir();
+
+    int r = 0;
+    #define TEST( Type ) { \
+        Type o; \
+        if ( ( r = QTest::qExec( &o, argc, argv ) ) != 0 ) { removeDir( dataDir ); return r; } }
+
+    TEST( TestPlaylistRevision );
+    #undef TEST
+
+    removeDir( dataDir );
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* === This file is part of Tomahawk Player - <http://tomahawk-player.org> ===
+ *
+ *   Copyright 2010-2011, Christian Muehlhaeuser <muesli@tomahawk-player.org>
+ *
+ *   Tomahawk is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   Tomahawk is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with Tomahawk. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TESTPLAYLISTREVISION_H
+#define TESTPLAYLISTREVISION_H
+
+#include <QtTest>
+
+#include "database/databaseimpl.h"
+#include "database/databasecommand_setplaylistrevision.h"
+#include "utils/tomahawkutils.h"
+#include "source.h"
+
+using namespace Tomahawk;
+
+
+class TestPlaylistRevision : public QObject
+{
+    Q_OBJECT
+
+    DatabaseImpl* m_db;
+    source_ptr m_peer;
+
+    // what a peer's SetPlaylistRevision op carries, either the full list or a delta against oldrev
+    void setRevision( const QString& newrev, const QString& oldrev, const QStringList& entries, bool delta, const QStringList& base = QStringList() )
+    {
+        DatabaseCommand_SetPlaylistRevision cmd;
+        cmd.setSource( m_peer );
+        cmd.setPlaylistguid( "playlist" );
+        cmd.setNewrev( newrev );
+        cmd.setOldrev( oldrev );
+
+        if ( delta )
+        {
+            QVariantMap m;
+            m.insert( "delta", DatabaseImpl::playlistEntriesDelta( base, entries ) );
+            cmd.setEntrydelta( m );
+        }
+        else
+        {
+            QVariantList l;
+            foreach ( const QString& guid, entries )
+                l << guid;
+            cmd.setOrderedguids( l );
+        }
+
+        // like the DatabaseWorker does it, the foreign keys are checked on commit
+        QVERIFY( m_db->database().transaction() );
+        cmd.exec( m_db );
+        QVERIFY( m_db->database().commit() );
+    }
+
+    QString currentRevision()
+    {
+        TomahawkSqlQuery query = m_db->newquery();
+        query.exec( "SELECT currentrevision FROM playlist WHERE guid = 'playlist'" );
+        return query.next() ? query.value( 0 ).toString() : QString();
+    }
+
+private slots:
+    void initTestCase()
+    {
+        m_db = new DatabaseImpl( TomahawkUtils::appDataDir().absoluteFilePath( "tomahawk.db" ) );
+        m_peer = source_ptr( new Source( 1, "peer" ) );
+
+        TomahawkSqlQuery query = m_db->newquery();
+        QVERIFY( query.exec( "INSERT INTO source( id, name, friendlyname ) VALUES( 1, 'peer', 'Peer' )" ) );
+        QVERIFY( query.exec( "INSERT INTO playlist( guid, source, title ) VALUES( 'playlist', 1, 'Playlist' )" ) );
+
+        setRevision( "r1", QString(), QStringList() << "a" << "b" << "c", false );
+        QCOMPARE( currentRevision(), QString( "r1" ) );
+    }
+
+    void cleanupTestCase()
+    {
+        m_peer.clear();
+        delete m_db;
+    }
+
+    void testOutOfOrderDelta()
+    {
+        const QStringList r1 = QStringList() << "a" << "b" << "c";
+        const QStringList r2 = QStringList() << "a" << "b" << "c" << "d";
+        const QStringList r3 = QStringList() << "d" << "a" << "b" << "c" << "e";
+
+        // r3 comes in before r2, the revision it is based on
+        setRevision( "r3", "r2", r3, true, r2 );
+        QCOMPARE( currentRevision(), QString( "r1" ) );
+        QCOMPARE( m_db->playlistRevisionEntries( "r1" ), r1 );
+
+        bool found;
+        m_db->playlistRevisionEntries( "r3", &found );
+        QVERIFY( !found );
+
+        // r2 resolves r3, which becomes the current revision
+        setRevision( "r2", "r1", r2, true, r1 );
+        QCOMPARE( currentRevision(), QString( "r3" ) );
+        QCOMPARE( m_db->playlistRevisionEntries( "r2" ), r2 );
+        QCOMPARE( m_db->playlistRevisionEntries( "r3", &found ), r3 );
+        QVERIFY( found );
+    }
+
+    void testCheckpointSupersedesPending()
+    {
+        const QStringList r4 = QStringList() << "d" << "a" << "b";
+        const QStringList r5 = QStringList() << "d" << "a" << "b" << "f";
+        const QStringList r6 = QStringList() << "f" << "g";
+
+        // r4 never arrives, the sender's next checkpoint carries the full list again
+        setRevision( "r5", "r4", r5, true, r4 );
+        QCOMPARE( currentRevision(), QString( "r3" ) );
+
+        setRevision( "r6", "r5", r6, false );
+        QCOMPARE( currentRevision(), QString( "r6" ) );
+        QCOMPARE( m_db->playlistRevisionEntries( "r6" ), r6 );
+    }
+
+    void testDeltaNotFittingBase()
+    {
+        // a delta copying more entries than r6 has is never applied, and never becomes current
+        const QStringList big = QStringList() << "a" << "b" << "c" << "d" << "e";
+        setRevision( "r7", "r6", QStringList() << "a" << "b" << "c" << "d" << "e" << "h", true, big );
+        QCOMPARE( currentRevision(), QString( "r6" ) );
+        QCOMPARE( m_db->playlistRevisionEntries( "r6" ), QStringList() << "f" << "g" );
+    }
+};
+
+#endif
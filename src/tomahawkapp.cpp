@@ -29,6 +29,7 @@
 #include <QtNetwork/QNetworkReply>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QtConcurrentRun>
 
 #include "artist.h"
 #include "album.h"
@@ -36,12 +37,14 @@
 #include "infosystem/infosystem.h"
 #include "accounts/AccountManager.h"
 #include "database/database.h"
+#include "database/databaseimpl.h"
 #include "database/databasecollection.h"
 #include "database/databasecommand_collectionstats.h"
 #include "database/databaseresolver.h"
 #include "playlist/dynamic/GeneratorFactory.h"
 #include "playlist/dynamic/echonest/EchonestGenerator.h"
 #include "playlist/dynamic/database/DatabaseGenerator.h"
+#include "playlist/trackstore.h"
 #include "network/servent.h"
 #include "web/api_v1.h"
 #include "sourcelist.h"
@@ -59,6 +62,7 @@
 #include "utils/xspfloader.h"
 #include "utils/jspfloader.h"
 #include "utils/logger.h"
+#include "utils/startuptrace.h"
 #include "utils/tomahawkutilsgui.h"
 #include "accounts/lastfm/LastFmAccount.h"
 #include "accounts/spotify/SpotifyAccount.h"
@@ -161,16 +165,28 @@ TomahawkApp::init()
     TomahawkUtils::setHeaderHeight( fm.height() + 8 );
 #endif
 
+    StartupTrace::begin( "init" );
     TomahawkSettings* s = TomahawkSettings::instance();
 
+    // opening the database (and updating its schema) takes longest, so everything
+    // that doesn't need it comes up meanwhile. initDatabase() waits for it, and
+    // nothing else can get to it earlier: the event loop only starts once we return.
+    tDebug() << "Opening Database.";
+    m_databaseOpen = QtConcurrent::run( &TomahawkApp::openDatabase, databasePath() );
+
     tDebug( LOGINFO ) << "Setting NAM.";
+    StartupTrace::begin( "network" );
     // Cause the creation of the nam, but don't need to address it directly, so prevent warning
     Q_UNUSED( TomahawkUtils::nam() );
+    StartupTrace::end( "network" );
 
+    StartupTrace::begin( "audio engine" );
     m_audioEngine = QWeakPointer<AudioEngine>( new AudioEngine );
+    StartupTrace::end( "audio engine" );
     m_scanManager = QWeakPointer<ScanManager>( new ScanManager( this ) );
 
     // init pipeline and resolver factories
+    StartupTrace::begin( "pipeline" );
     new Pipeline();
 
 #ifndef ENABLE_HEADLESS
@@ -180,12 +196,19 @@ TomahawkApp::init()
     new ActionCollection( this );
     connect( ActionCollection::instance()->getAction( "quit" ), SIGNAL( triggered() ), SLOT( quit() ), Qt::UniqueConnection );
 #endif
+    StartupTrace::end( "pipeline" );
 
-    m_servent = QWeakPointer<Servent>( new Servent( this ) );
-    connect( m_servent.data(), SIGNAL( ready() ), SLOT( initSIP() ) );
+    tDebug() << "Init InfoSystem.";
+    StartupTrace::begin( "info system" );
+    m_infoSystem = QWeakPointer<Tomahawk::InfoSystem::InfoSystem>( Tomahawk::InfoSystem::InfoSystem::instance() );
+    StartupTrace::end( "info system" );
 
-    tDebug() << "Init Database.";
-    initDatabase();
+#ifndef ENABLE_HEADLESS
+    // load remote list of resolvers able to be installed
+    StartupTrace::begin( "attica" );
+    AtticaManager::instance();
+    StartupTrace::end( "attica" );
+#endif
 
     QByteArray magic = QByteArray::fromBase64( enApiSecret );
     QByteArray wand = QByteArray::fromBase64( QCoreApplication::applicationName().toLatin1() );
@@ -222,10 +245,14 @@ TomahawkApp::init()
         connect( m_shortcutHandler.data(), SIGNAL( mute() ), m_audioEngine.data(), SLOT( mute() ) );
     }
 
-    tDebug() << "Init InfoSystem.";
-    m_infoSystem = QWeakPointer<Tomahawk::InfoSystem::InfoSystem>( Tomahawk::InfoSystem::InfoSystem::instance() );
+    tDebug() << "Init Database.";
+    initDatabase();
+
+    m_servent = QWeakPointer<Servent>( new Servent( this ) );
+    connect( m_servent.data(), SIGNAL( ready() ), SLOT( initSIP() ) );
 
     tDebug() << "Init AccountManager.";
+    StartupTrace::begin( "accounts" );
     m_accountManager = QWeakPointer< Tomahawk::Accounts::AccountManager >( new Tomahawk::Accounts::AccountManager( this ) );
 
     Tomahawk::Accounts::LastFmAccountFactory* lastfmFactory = new Tomahawk::Accounts::LastFmAccountFactory();
@@ -236,6 +263,7 @@ TomahawkApp::init()
     m_accountManager.data()->registerAccountFactoryForFilesystem( spotifyFactory );
 
     Tomahawk::Accounts::AccountManager::instance()->loadFromConfig();
+    StartupTrace::end( "accounts" );
 
     Echonest::Config::instance()->setNetworkAccessManager( TomahawkUtils::nam() );
 #ifndef ENABLE_HEADLESS
@@ -244,6 +272,7 @@ TomahawkApp::init()
     if ( !m_headless )
     {
         tDebug() << "Init MainWindow.";
+        StartupTrace::Scope trace( "main window" );
         m_mainwindow = new TomahawkWindow();
         m_mainwindow->setWindowTitle( "Tomahawk" );
         m_mainwindow->setObjectName( "TH_Main_Window" );
@@ -259,11 +288,6 @@ TomahawkApp::init()
     tDebug() << "Init Pipeline.";
     initPipeline();
 
-#ifndef ENABLE_HEADLESS
-    // load remote list of resolvers able to be installed
-    AtticaManager::instance();
-#endif
-
     if ( arguments().contains( "--http" ) || TomahawkSettings::instance()->value( "network/http", true ).toBool() )
     {
         initHTTP();
@@ -303,6 +327,8 @@ TomahawkApp::init()
     // Make sure to do this after main window is inited
     Tomahawk::enableFullscreen();
 #endif
+
+    StartupTrace::end( "init" );
 }
 
 
@@ -396,6 +422,7 @@ TomahawkApp::registerMetaTypes()
     qRegisterMetaType< QList<QVariantMap> >("QList<QVariantMap>");
     qRegisterMetaType< QList<QString> >("QList<QString>");
     qRegisterMetaType< QList<uint> >("QList<uint>");
+    qRegisterMetaType< QList<TrackStore::Record> >("QList<TrackStore::Record>");
     qRegisterMetaType< Connection* >("Connection*");
     qRegisterMetaType< QAbstractSocket::SocketError >("QAbstractSocket::SocketError");
     qRegisterMetaType< QTcpSocket* >("QTcpSocket*");
@@ -456,6 +483,21 @@ TomahawkApp::registerMetaTypes()
 
 void
 TomahawkApp::initDatabase()
+{
+    StartupTrace::begin( "database wait" );
+    DatabaseImpl* impl = m_databaseOpen.result();
+    StartupTrace::end( "database wait" );
+
+    m_database = QWeakPointer<Database>( new Database( impl, this ) );
+    connect( m_database.data(), SIGNAL( ready() ), SLOT( onDatabaseReady() ) );
+
+    StartupTrace::begin( "search index" );
+    Pipeline::instance()->databaseReady();
+}
+
+
+QString
+TomahawkApp::databasePath() const
 {
     QString dbpath;
     if ( arguments().contains( "--testdb" ) )
@@ -468,8 +510,34 @@ TomahawkApp::initDatabase()
     }
 
     tDebug( LOGEXTRA ) << "Using database:" << dbpath;
-    m_database = QWeakPointer<Database>( new Database( dbpath, this ) );
-    Pipeline::instance()->databaseReady();
+    return dbpath;
+}
+
+
+DatabaseImpl*
+TomahawkApp::openDatabase( const QString& dbpath )
+{
+    StartupTrace::Scope trace( "database open" );
+    return Database::open( dbpath );
+}
+
+
+void
+TomahawkApp::onDatabaseReady()
+{
+    StartupTrace::end( "search index" );
+    finishStartupTrace();
+}
+
+
+void
+TomahawkApp::finishStartupTrace()
+{
+    // done once we are online and can search our collection
+    if ( !m_loaded || !Database::instance()->isReady() )
+        return;
+
+    StartupTrace::finish( TomahawkUtils::appDataDir().absoluteFilePath( "startup-trace.json" ) );
 }
 
 
@@ -528,6 +596,7 @@ void
 TomahawkApp::initLocalCollection()
 {
     connect( SourceList::instance(), SIGNAL( ready() ), SLOT( initServent() ) );
+    StartupTrace::begin( "sources" );
 
     source_ptr src( new Source( 0, tr( "My Collection" ) ) );
     collection_ptr coll( new LocalCollection( src ) );
@@ -548,6 +617,7 @@ TomahawkApp::initLocalCollection()
 void
 TomahawkApp::initServent()
 {
+    StartupTrace::end( "sources" );
     tDebug() << "Init Servent.";
 
     bool upnp = !arguments().contains( "--noupnp" ) && TomahawkSettings::instance()->value( "network/upnp", true ).toBool() && !TomahawkSettings::instance()->preferStaticHostPort();
@@ -578,6 +648,8 @@ TomahawkApp::initSIP()
 
     m_loaded = true;
     emit tomahawkLoaded();
+
+    finishStartupTrace();
 }
 
 
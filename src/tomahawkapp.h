@@ -31,6 +31,7 @@
 #include <QtCore/QSettings>
 #include <QtCore/QDir>
 #include <QtCore/QPersistentModelIndex>
+#include <QtCore/QFuture>
 
 #include "QxtHttpServerConnector"
 #include "QxtHttpSessionManager"
@@ -42,6 +43,7 @@
 
 class AudioEngine;
 class Database;
+class DatabaseImpl;
 class ScanManager;
 class Servent;
 class SipHandler;
@@ -107,6 +109,7 @@ public slots:
 
 private slots:
     void initServent();
+    void onDatabaseReady();
     void initSIP();
     void initHTTP();
 
@@ -119,10 +122,16 @@ private:
 
     // Start-up order: database, collection, pipeline, servent, http
     void initDatabase();
+    QString databasePath() const;
+    // runs on a worker thread, started first thing in init()
+    static DatabaseImpl* openDatabase( const QString& dbpath );
+    // writes the start-up timeline, once both the database and the servent are ready
+    void finishStartupTrace();
     void initLocalCollection();
     void initPipeline();
 
     QWeakPointer<Database> m_database;
+    QFuture<DatabaseImpl*> m_databaseOpen;
     QWeakPointer<ScanManager> m_scanManager;
     QWeakPointer<AudioEngine> m_audioEngine;
     QWeakPointer<Servent> m_servent;